@@ -0,0 +1,228 @@
+// hw/benches/async_queue_main.cpp
+// Clock-crossing benchmark: drives the dual-clock hb_async_task_queue of
+// tb_async_queue with a producer on wclk and a consumer on rclk, at a
+// configurable clock ratio, next to the single-clock hb_task_queue_core on wclk
+// as the baseline, and compares throughput and push-to-pop latency.
+//
+// Clocks are simulated in picoseconds with independent periods (--wclk-ps,
+// --rclk-ps), both starting with a rising edge at t=0. Every wclk edge the
+// producer has a new task with probability --push-rate and offers it until it
+// is accepted. The async consumer pops on rclk edges with probability
+// --pop-rate; the baseline consumer pops on wclk edges with the probability
+// scaled by wclk/rclk, so both drain the same tasks per nanosecond. Latency runs
+// from the push edge to the pop edge. Every pop is checked against a scoreboard.
+//
+// Results go to outputs/bench_async.json as {"bench": {"key": value, ...}}.
+#include "Vtb_async_queue.h"
+#include "verilated.h"
+#include "bench_util.h"
+
+#include <iostream>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace std;
+
+// Must match the tb_async_queue parameters (the Makefile passes them via -G and -CFLAGS)
+#ifndef ASYNC_DEPTH
+#define ASYNC_DEPTH 16
+#endif
+#ifndef SYNC_STAGES
+#define SYNC_STAGES 2
+#endif
+
+static Vtb_async_queue *top = nullptr;
+
+// One clock: rising edges at k * period, the high phase lasts period / 2.
+struct Clock {
+    uint64_t period;
+    uint64_t next_toggle = 0;
+    bool high = false;
+
+    bool rises_at(uint64_t t) const { return next_toggle == t && !high; }
+    void toggle(CData &pin) {
+        high = !high;
+        pin = high;
+        next_toggle += high ? period / 2 : period - period / 2;
+    }
+};
+
+// Producer, consumer and scoreboard of one DUT.
+struct Side {
+    const char *name;
+    bool offering = false;
+    uint32_t next_val = 1;
+    deque<pair<uint32_t, uint64_t>> sb;     // value, push time (ps)
+    vector<uint64_t> lat_ps;
+    uint64_t pushes = 0, pops = 0, full_edges = 0, producer_edges = 0, mismatches = 0;
+};
+
+static void score_push(Side &s, bool req, bool full, uint64_t t) {
+    s.producer_edges++;
+    if (!req) return;
+    if (full) {
+        s.full_edges++;
+        return;
+    }
+    s.sb.push_back({s.next_val++, t});
+    s.pushes++;
+    s.offering = false;
+}
+
+static void score_pop(Side &s, uint32_t data, uint64_t t) {
+    if (s.sb.empty()) {
+        s.mismatches++;
+        return;
+    }
+    if (data != s.sb.front().first) s.mismatches++;
+    s.lat_ps.push_back(t - s.sb.front().second);
+    s.sb.pop_front();
+    s.pops++;
+}
+
+static void run_async_bench(const char *cfg, uint64_t wclk_ps, uint64_t rclk_ps, int ncycles,
+                            double push_rate, double pop_rate) {
+    Clock wclk{wclk_ps}, rclk{rclk_ps};
+    Side sides[2];
+    sides[0].name = "async";
+    sides[1].name = "sync";
+
+    mt19937 rng(1);
+    uniform_real_distribution<double> u01(0.0, 1.0);
+    // baseline consumer runs on wclk: scale so it drains the same tasks per ns
+    double sync_pop_rate = min(1.0, pop_rate * (double)wclk_ps / (double)rclk_ps);
+
+    // reset both domains for a few edges of the slower clock, with both clocks running
+    top->wreset = 1;
+    top->rreset = 1;
+    top->a_push_req = 0;
+    top->a_pop_req = 0;
+    top->s_push_req = 0;
+    top->s_pop_req = 0;
+    top->wclk = 0;
+    top->rclk = 0;
+    top->eval();
+    uint64_t t_release = max(wclk_ps, rclk_ps) * (SYNC_STAGES + 4);
+    uint64_t t_end = t_release + (uint64_t)ncycles * wclk_ps;
+    uint64_t t = 0;
+
+    while (t < t_end) {
+        bool in_reset = t < t_release;
+        if (!in_reset) {
+            top->wreset = 0;
+            top->rreset = 0;
+        }
+        bool w_rise = wclk.rises_at(t), r_rise = rclk.rises_at(t);
+
+        // drive and score this edge's requests from the settled pre-edge state
+        if (w_rise && !in_reset) {
+            for (Side &s : sides) {
+                if (!s.offering && u01(rng) < push_rate) s.offering = true;
+            }
+            top->a_push_req = sides[0].offering;
+            top->a_data_in = sides[0].next_val;
+            top->s_push_req = sides[1].offering;
+            top->s_data_in = sides[1].next_val;
+            top->s_pop_req = top->s_valid_out && u01(rng) < sync_pop_rate;
+            top->eval();
+            uint32_t s_out = top->s_data_out;
+            score_push(sides[0], top->a_push_req, top->a_full, t);
+            score_push(sides[1], top->s_push_req, top->s_full, t);
+            if (top->s_pop_req) score_pop(sides[1], s_out, t);
+        }
+        if (r_rise && !in_reset) {
+            top->a_pop_req = top->a_valid_out && u01(rng) < pop_rate;
+            top->eval();
+            if (top->a_pop_req) score_pop(sides[0], top->a_data_out, t);
+        }
+
+        if (wclk.next_toggle == t) wclk.toggle(top->wclk);
+        if (rclk.next_toggle == t) rclk.toggle(top->rclk);
+        top->eval();
+        t = min(wclk.next_toggle, rclk.next_toggle);
+    }
+
+    double elapsed_ns = (double)(t_end - t_release) / 1000.0;
+    for (Side &s : sides) {
+        string name = string("async_") + cfg + "_" + s.name;
+        vector<uint64_t> &lat = s.lat_ps;
+        sort(lat.begin(), lat.end());
+        double mean = 0.0;
+        for (uint64_t v : lat) mean += (double)v;
+        if (!lat.empty()) mean /= lat.size();
+        double p50 = lat.empty() ? 0.0 : (double)lat[lat.size() / 2];
+        double p99 = lat.empty() ? 0.0 : (double)lat[(size_t)(lat.size() * 0.99)];
+        double mx = lat.empty() ? 0.0 : (double)lat.back();
+        double mtasks = elapsed_ns > 0 ? s.pops / elapsed_ns * 1000.0 : 0.0;
+        double full_frac = s.producer_edges ? (double)s.full_edges / s.producer_edges : 0.0;
+        uint64_t consumer_ps = (s.name[0] == 'a') ? rclk_ps : wclk_ps;
+
+        printf("[HOST] %s: wclk=%llups rclk=%llups pops=%llu Mtasks/s=%.1f latency_ns mean=%.2f p50=%.2f p99=%.2f max=%.2f "
+               "(%.2f consumer cycles) producer_full=%.3f mismatches=%llu\n",
+               name.c_str(), (unsigned long long)wclk_ps, (unsigned long long)rclk_ps, (unsigned long long)s.pops,
+               mtasks, mean / 1000.0, p50 / 1000.0, p99 / 1000.0, mx / 1000.0, mean / consumer_ps, full_frac,
+               (unsigned long long)s.mismatches);
+        bench_record(name, "depth", ASYNC_DEPTH);
+        bench_record(name, "sync_stages", SYNC_STAGES);
+        bench_record(name, "wclk_ps", (double)wclk_ps);
+        bench_record(name, "rclk_ps", (double)rclk_ps);
+        bench_record(name, "push_rate", push_rate);
+        bench_record(name, "pop_rate", s.name[0] == 'a' ? pop_rate : sync_pop_rate);
+        bench_record(name, "pushes", (double)s.pushes);
+        bench_record(name, "pops", (double)s.pops);
+        bench_record(name, "throughput_mtasks_per_s", mtasks);
+        bench_record(name, "latency_mean_ns", mean / 1000.0);
+        bench_record(name, "latency_p50_ns", p50 / 1000.0);
+        bench_record(name, "latency_p99_ns", p99 / 1000.0);
+        bench_record(name, "latency_max_ns", mx / 1000.0);
+        bench_record(name, "latency_mean_consumer_cycles", mean / consumer_ps);
+        bench_record(name, "producer_full_frac", full_frac);
+        bench_record(name, "mismatches", (double)s.mismatches);
+    }
+    if (sides[0].mismatches || sides[1].mismatches) {
+        fprintf(stderr, "[HOST] async_%s: scoreboard mismatches\n", cfg);
+    }
+}
+
+static uint64_t total_mismatches = 0;
+
+int main(int argc, char **argv) {
+    Verilated::commandArgs(argc, argv);
+    mkdir("outputs", 0755);
+
+    top = new Vtb_async_queue;
+
+    int ncycles = atoi(arg_value(argc, argv, "--cycles", "50000"));
+    uint64_t wclk_ps = strtoull(arg_value(argc, argv, "--wclk-ps", "1000"), nullptr, 10);
+    double push_rate = atof(arg_value(argc, argv, "--push-rate", "1.0"));
+    double pop_rate = atof(arg_value(argc, argv, "--pop-rate", "1.0"));
+    const char *rclk = arg_value(argc, argv, "--rclk-ps", nullptr);
+
+    if (rclk) {
+        run_async_bench("custom", wclk_ps, strtoull(rclk, nullptr, 10), ncycles, push_rate, pop_rate);
+    } else {
+        // follower clock equal, slower and faster than the leader clock
+        run_async_bench("r1_0", wclk_ps, wclk_ps, ncycles, push_rate, pop_rate);
+        run_async_bench("r1_5", wclk_ps, wclk_ps * 3 / 2, ncycles, push_rate, pop_rate);
+        run_async_bench("r2_5", wclk_ps, wclk_ps * 5 / 2, ncycles, push_rate, pop_rate);
+        run_async_bench("r0_6", wclk_ps, wclk_ps * 3 / 5, ncycles, push_rate, pop_rate);
+    }
+    for (const BenchEntry &e : bench_results) {
+        if (e.key == "mismatches") total_mismatches += (uint64_t)e.value;
+    }
+    write_bench_json("outputs/bench_async.json");
+
+    top->final();
+    delete top;
+    return total_mismatches == 0 ? 0 : 2;
+}
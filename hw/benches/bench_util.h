@@ -0,0 +1,77 @@
+// hw/benches/bench_util.h
+// Helpers shared by the Verilator harnesses (verilator_main.cpp and the bench
+// harnesses in benches/): benchmark results written as JSON, command-line
+// lookup, and word access to Verilator buses. Each harness is one translation
+// unit, so the results table lives here as a file-static.
+#ifndef HB_BENCH_UTIL_H
+#define HB_BENCH_UTIL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Benchmark results, grouped by benchmark name when written out
+struct BenchEntry {
+    std::string bench;
+    std::string key;
+    double value;
+};
+static std::vector<BenchEntry> bench_results;
+
+static inline void bench_record(const std::string &bench, const char *key, double value) {
+    bench_results.push_back({bench, key, value});
+}
+
+// Write benchmark results as {"bench": {"key": value, ...}, ...}
+static inline void write_bench_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return;
+    }
+    fprintf(f, "{\n");
+    for (size_t i = 0; i < bench_results.size(); ++i) {
+        const BenchEntry &e = bench_results[i];
+        bool first = (i == 0) || (bench_results[i-1].bench != e.bench);
+        bool last = (i + 1 == bench_results.size()) || (bench_results[i+1].bench != e.bench);
+        if (first) fprintf(f, "  \"%s\": {\n", e.bench.c_str());
+        fprintf(f, "    \"%s\": %.6g%s\n", e.key.c_str(), e.value, last ? "" : ",");
+        if (last) fprintf(f, "  }%s\n", (i + 1 == bench_results.size()) ? "" : ",");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+// value following flag on the command line, or def
+static inline const char *arg_value(int argc, char **argv, const char *flag, const char *def) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], flag) == 0) return argv[i+1];
+    }
+    return def;
+}
+
+// 32-bit word i of a bus. Verilator exposes buses as plain integers up to 64
+// bits and as arrays of 32-bit words beyond that.
+static inline uint32_t bus_word(uint32_t bus, int) { return bus; }
+static inline uint32_t bus_word(uint64_t bus, int i) { return (uint32_t)(bus >> (32 * i)); }
+template <typename W>
+static inline uint32_t bus_word(const W &bus, int i) { return bus[i]; }
+
+// store word i of a bus, leaving the other words alone
+static inline void bus_put(uint64_t &bus, int i, uint32_t v) {
+    bus = (bus & ~(0xFFFFFFFFull << (32 * i))) | ((uint64_t)v << (32 * i));
+}
+template <typename W>
+static inline void bus_put(W &bus, int i, uint32_t v) { bus[i] = v; }
+
+// store the n words of w as a whole bus
+static inline void bus_set(uint32_t &bus, const uint32_t *w, int) { bus = w[0]; }
+static inline void bus_set(uint64_t &bus, const uint32_t *w, int) { bus = ((uint64_t)w[1] << 32) | w[0]; }
+template <typename W>
+static inline void bus_set(W &bus, const uint32_t *w, int n) {
+    for (int i = 0; i < n; i++) bus[i] = w[i];
+}
+
+#endif // HB_BENCH_UTIL_H
@@ -0,0 +1,219 @@
+// hw/benches/multi_queue_main.cpp
+// Multi-queue benchmark: drives the shared linked-list pool and the statically
+// partitioned FIFOs of tb_multi_queue with the same skewed, bursty workload and
+// compares refusals and how much of the total storage each could actually use.
+//
+// Workload: tasks arrive in bursts, each burst aimed at one queue (queue 0 with
+// probability --hot-frac, otherwise a uniformly random queue). A single consumer
+// pops at most one task per cycle with probability --service-rate, serving the
+// non-empty queues round-robin. Refused tasks are dropped and counted. Every pop
+// is checked against a per-queue scoreboard.
+//
+// Results go to outputs/bench_multiq.json as {"bench": {"key": value, ...}}.
+#include "Vtb_multi_queue.h"
+#include "verilated.h"
+#include "bench_util.h"
+
+#include <iostream>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace std;
+
+// Must match the tb_multi_queue parameters (the Makefile passes them via -G and -CFLAGS)
+#ifndef NUM_QUEUES
+#define NUM_QUEUES 8
+#endif
+#ifndef POOL_DEPTH
+#define POOL_DEPTH 64
+#endif
+
+// the Side port pointers below assume 8-bit queue IDs, valid masks and free counts
+static_assert(NUM_QUEUES >= 2 && NUM_QUEUES <= 8, "multi-queue harness supports 2..8 queues");
+static_assert(POOL_DEPTH < 256, "multi-queue harness supports pools below 256 entries");
+
+static Vtb_multi_queue *top = nullptr;
+
+// One side of the comparison: the port set of one DUT plus its scoreboard.
+struct Side {
+    const char *name;
+    CData *push_req, *push_qid, *pop_req, *pop_qid;
+    IData *data_in;
+    CData *push_ok, *pop_ok;
+    IData *data_out;
+    CData *q_valid;   // NUM_QUEUES <= 8
+    CData *free_count;
+
+    deque<uint32_t> sb[NUM_QUEUES];
+    int rr = 0;
+    uint64_t offered = 0, accepted = 0, refused = 0, popped = 0, mismatches = 0;
+    uint64_t occ_sum = 0, free_at_refusal = 0;
+    uint32_t peak_occ = 0;
+};
+
+// Present this cycle's request on one side. Returns the queue picked for a pop, or -1.
+static int drive(Side &s, bool arrival, int arr_q, uint32_t value, bool serve) {
+    *s.push_req = arrival;
+    *s.push_qid = (CData)arr_q;
+    *s.data_in = value;
+    int pop_q = -1;
+    if (serve) {
+        for (int k = 0; k < NUM_QUEUES; k++) {
+            int q = (s.rr + k) % NUM_QUEUES;
+            if (*s.q_valid & (1u << q)) {
+                pop_q = q;
+                break;
+            }
+        }
+    }
+    *s.pop_req = pop_q >= 0;
+    *s.pop_qid = (CData)(pop_q >= 0 ? pop_q : 0);
+    return pop_q;
+}
+
+// Score the cycle after the inputs settled, before the clock edge.
+static void score(Side &s, bool arrival, int arr_q, uint32_t value, int pop_q) {
+    uint32_t occ = POOL_DEPTH - *s.free_count;
+    s.occ_sum += occ;
+    if (occ > s.peak_occ) s.peak_occ = occ;
+    if (arrival) {
+        s.offered++;
+        if (*s.push_ok) {
+            s.accepted++;
+            s.sb[arr_q].push_back(value);
+        } else {
+            s.refused++;
+            s.free_at_refusal += *s.free_count;
+        }
+    }
+    if (pop_q >= 0 && *s.pop_ok) {
+        // the push above may have gone to this queue; it sits behind the head
+        uint32_t expected = s.sb[pop_q].front();
+        s.sb[pop_q].pop_front();
+        if (*s.data_out != expected) s.mismatches++;
+        s.popped++;
+        s.rr = (pop_q + 1) % NUM_QUEUES;
+    }
+}
+
+static void run_multiq_bench(const char *cfg, int ncycles, double arrival_rate, double hot_frac,
+                             double burst_mean, double service_rate) {
+    Side sides[2];
+    sides[0] = Side{};
+    sides[0].name = "shared";
+    sides[0].push_req = &top->sh_push_req;  sides[0].push_qid = &top->sh_push_qid;
+    sides[0].pop_req = &top->sh_pop_req;    sides[0].pop_qid = &top->sh_pop_qid;
+    sides[0].data_in = &top->sh_data_in;    sides[0].push_ok = &top->sh_push_ok;
+    sides[0].pop_ok = &top->sh_pop_ok;      sides[0].data_out = &top->sh_data_out;
+    sides[0].q_valid = &top->sh_q_valid;    sides[0].free_count = &top->sh_free_count;
+    sides[1] = Side{};
+    sides[1].name = "static";
+    sides[1].push_req = &top->st_push_req;  sides[1].push_qid = &top->st_push_qid;
+    sides[1].pop_req = &top->st_pop_req;    sides[1].pop_qid = &top->st_pop_qid;
+    sides[1].data_in = &top->st_data_in;    sides[1].push_ok = &top->st_push_ok;
+    sides[1].pop_ok = &top->st_pop_ok;      sides[1].data_out = &top->st_data_out;
+    sides[1].q_valid = &top->st_q_valid;    sides[1].free_count = &top->st_free_count;
+
+    // reset both DUTs
+    top->reset = 1;
+    for (Side &s : sides) drive(s, false, 0, 0, false);
+    for (int i = 0; i < 4; i++) {
+        top->clk = 0; top->eval();
+        top->clk = 1; top->eval();
+    }
+    top->reset = 0;
+
+    // bursts of geometric length burst_mean; gaps sized so the long-run rate is arrival_rate
+    mt19937 rng(1);
+    uniform_real_distribution<double> u01(0.0, 1.0);
+    uniform_int_distribution<int> any_q(0, NUM_QUEUES - 1);
+    double p_end_burst = 1.0 / burst_mean;
+    double p_start_burst = arrival_rate / (burst_mean * (1.0 - arrival_rate));
+    bool in_burst = false;
+    int burst_q = 0;
+    uint32_t next_val = 1;
+
+    for (int c = 0; c < ncycles; c++) {
+        if (!in_burst && u01(rng) < p_start_burst) {
+            in_burst = true;
+            burst_q = (u01(rng) < hot_frac) ? 0 : any_q(rng);
+        }
+        bool arrival = in_burst;
+        uint32_t value = arrival ? next_val++ : 0;
+        bool serve = u01(rng) < service_rate;
+
+        top->clk = 0;
+        int pop_q[2];
+        for (int i = 0; i < 2; i++) pop_q[i] = drive(sides[i], arrival, burst_q, value, serve);
+        top->eval();
+        for (int i = 0; i < 2; i++) score(sides[i], arrival, burst_q, value, pop_q[i]);
+        top->clk = 1;
+        top->eval();
+
+        if (in_burst && u01(rng) < p_end_burst) in_burst = false;
+    }
+
+    for (Side &s : sides) {
+        string name = string("multiq_") + cfg + "_" + s.name;
+        double refusal_rate = s.offered ? (double)s.refused / s.offered : 0.0;
+        double mean_free = s.refused ? (double)s.free_at_refusal / s.refused : 0.0;
+        printf("[HOST] %s: offered=%llu refused=%llu refusal_rate=%.4f peak_occupancy=%u/%d mean_occupancy=%.2f free_at_refusal=%.2f mismatches=%llu\n",
+               name.c_str(), (unsigned long long)s.offered, (unsigned long long)s.refused, refusal_rate,
+               s.peak_occ, POOL_DEPTH, (double)s.occ_sum / ncycles, mean_free, (unsigned long long)s.mismatches);
+        bench_record(name, "num_queues", NUM_QUEUES);
+        bench_record(name, "pool_depth", POOL_DEPTH);
+        bench_record(name, "hot_frac", hot_frac);
+        bench_record(name, "arrival_rate", arrival_rate);
+        bench_record(name, "service_rate", service_rate);
+        bench_record(name, "offered", (double)s.offered);
+        bench_record(name, "refused", (double)s.refused);
+        bench_record(name, "refusal_rate", refusal_rate);
+        bench_record(name, "peak_occupancy", s.peak_occ);
+        bench_record(name, "mean_occupancy", (double)s.occ_sum / ncycles);
+        bench_record(name, "mean_free_at_refusal", mean_free);
+        bench_record(name, "mismatches", (double)s.mismatches);
+    }
+    if (sides[0].mismatches || sides[1].mismatches) {
+        fprintf(stderr, "[HOST] multiq_%s: scoreboard mismatches\n", cfg);
+    }
+}
+
+static uint64_t total_mismatches = 0;
+
+int main(int argc, char **argv) {
+    Verilated::commandArgs(argc, argv);
+    mkdir("outputs", 0755);
+
+    top = new Vtb_multi_queue;
+    top->clk = 0;
+
+    int ncycles = atoi(arg_value(argc, argv, "--cycles", "50000"));
+    double arrival_rate = atof(arg_value(argc, argv, "--arrival-rate", "0.45"));
+    double burst_mean = atof(arg_value(argc, argv, "--burst", "12"));
+    double service_rate = atof(arg_value(argc, argv, "--service-rate", "0.5"));
+    const char *hot = arg_value(argc, argv, "--hot-frac", nullptr);
+
+    if (hot) {
+        run_multiq_bench("custom", ncycles, arrival_rate, atof(hot), burst_mean, service_rate);
+    } else {
+        run_multiq_bench("uniform", ncycles, arrival_rate, 0.0, burst_mean, service_rate);
+        run_multiq_bench("skewed", ncycles, arrival_rate, 0.5, burst_mean, service_rate);
+        run_multiq_bench("hot", ncycles, arrival_rate, 0.9, burst_mean, service_rate);
+    }
+    for (const BenchEntry &e : bench_results) {
+        if (e.key == "mismatches") total_mismatches += (uint64_t)e.value;
+    }
+    write_bench_json("outputs/bench_multiq.json");
+
+    top->final();
+    delete top;
+    return total_mismatches == 0 ? 0 : 2;
+}
@@ -0,0 +1,93 @@
+// hw/benches/tb_async_queue.v
+// Top for the clock-crossing benchmark: the dual-clock hb_async_task_queue
+// (push on wclk, pop on rclk) next to the single-clock hb_task_queue_core on
+// wclk as the baseline. Each has its own port set so the harness can drive
+// both with the same workload and score them independently.
+`timescale 1ns/1ps
+
+module tb_async_queue #(
+    parameter DEPTH = 16,
+    parameter SYNC_STAGES = 2
+)(
+    input  logic wclk,
+    input  logic rclk,
+    input  logic wreset,
+    input  logic rreset,
+
+    // dual-clock FIFO
+    input  logic a_push_req,
+    input  logic [31:0] a_data_in,
+    output logic a_full,
+    output logic [$clog2(DEPTH+1)-1:0] a_wr_occupancy,
+    input  logic a_pop_req,
+    output logic a_valid_out,
+    output logic [31:0] a_data_out,
+    output logic [$clog2(DEPTH+1)-1:0] a_rd_occupancy,
+
+    // single-clock baseline (both sides on wclk)
+    input  logic s_push_req,
+    input  logic [31:0] s_data_in,
+    output logic s_full,
+    input  logic s_pop_req,
+    output logic s_valid_out,
+    output logic [31:0] s_data_out,
+    output logic [$clog2(DEPTH+1)-1:0] s_occupancy
+);
+
+    hb_async_task_queue #(
+        .DEPTH(DEPTH),
+        .WIDTH(32),
+        .SYNC_STAGES(SYNC_STAGES)
+    ) async_fifo (
+        .wclk(wclk),
+        .wreset(wreset),
+        .push_req(a_push_req),
+        .data_in(a_data_in),
+        .full(a_full),
+        .wr_occupancy(a_wr_occupancy),
+        .rclk(rclk),
+        .rreset(rreset),
+        .pop_req(a_pop_req),
+        .valid_out(a_valid_out),
+        .data_out(a_data_out),
+        .rd_occupancy(a_rd_occupancy)
+    );
+
+    localparam [$clog2(DEPTH+1)-1:0] DEPTH_C = DEPTH;
+
+    logic s_almost_full, s_almost_empty;
+    logic [1:0] s_doorbell;
+    logic [31:0] s_ts, s_residency;
+
+    hb_task_queue_core #(
+        .DEPTH(DEPTH),
+        .WIDTH(32)
+    ) sync_fifo (
+        .clk(wclk),
+        .reset(wreset),
+        .push_req(s_push_req),
+        .data_in(s_data_in),
+        .full(s_full),
+        .valid_out(s_valid_out),
+        .data_out(s_data_out),
+        .pop_req(s_pop_req),
+        .occupancy(s_occupancy),
+        .wm_we(1'b0),
+        .wm_high_in(DEPTH_C),
+        .wm_low_in('0),
+        .almost_full(s_almost_full),
+        .almost_empty(s_almost_empty),
+        .doorbell(s_doorbell),
+        .ts_out(s_ts),
+        .residency(s_residency)
+    );
+
+    // watermark, doorbell and timestamp outputs are not used here
+    wire unused_ok = s_almost_full | s_almost_empty | (|s_doorbell) | (|s_ts) | (|s_residency);
+    // synthesis translate_off
+    initial begin
+        if (unused_ok) begin end
+    end
+    // synthesis translate_on
+
+endmodule
@@ -0,0 +1,80 @@
+// hw/benches/tb_multi_queue.v
+// Side-by-side top for the multi-queue benchmark: the shared linked-list pool
+// (hb_multi_queue) and the statically partitioned baseline (hb_static_multi_queue)
+// with the same total storage. Each has its own port set so the harness can
+// drive both with the same workload and score them independently.
+`timescale 1ns/1ps
+
+module tb_multi_queue #(
+    parameter NUM_QUEUES = 8,
+    parameter POOL_DEPTH = 64,          // total entries; the static baseline gets POOL_DEPTH / NUM_QUEUES per queue
+    parameter MAX_PER_QUEUE = 64        // shared pool: cap on any one queue
+)(
+    input  logic clk,
+    input  logic reset,
+
+    // shared pool
+    input  logic sh_push_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] sh_push_qid,
+    input  logic [31:0] sh_data_in,
+    output logic sh_push_ok,
+    input  logic sh_pop_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] sh_pop_qid,
+    output logic [31:0] sh_data_out,
+    output logic sh_pop_ok,
+    output logic [NUM_QUEUES-1:0] sh_q_valid,
+    output logic [$clog2(POOL_DEPTH+1)-1:0] sh_free_count,
+
+    // statically partitioned FIFOs
+    input  logic st_push_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] st_push_qid,
+    input  logic [31:0] st_data_in,
+    output logic st_push_ok,
+    input  logic st_pop_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] st_pop_qid,
+    output logic [31:0] st_data_out,
+    output logic st_pop_ok,
+    output logic [NUM_QUEUES-1:0] st_q_valid,
+    output logic [$clog2(POOL_DEPTH+1)-1:0] st_free_count
+);
+
+    hb_multi_queue #(
+        .NUM_QUEUES(NUM_QUEUES),
+        .POOL_DEPTH(POOL_DEPTH),
+        .WIDTH(32),
+        .MAX_PER_QUEUE(MAX_PER_QUEUE)
+    ) shared_pool (
+        .clk(clk),
+        .reset(reset),
+        .push_req(sh_push_req),
+        .push_qid(sh_push_qid),
+        .data_in(sh_data_in),
+        .push_ok(sh_push_ok),
+        .pop_req(sh_pop_req),
+        .pop_qid(sh_pop_qid),
+        .data_out(sh_data_out),
+        .pop_ok(sh_pop_ok),
+        .q_valid(sh_q_valid),
+        .free_count(sh_free_count)
+    );
+
+    hb_static_multi_queue #(
+        .NUM_QUEUES(NUM_QUEUES),
+        .DEPTH_PER_QUEUE(POOL_DEPTH / NUM_QUEUES),
+        .WIDTH(32)
+    ) static_fifos (
+        .clk(clk),
+        .reset(reset),
+        .push_req(st_push_req),
+        .push_qid(st_push_qid),
+        .data_in(st_data_in),
+        .push_ok(st_push_ok),
+        .pop_req(st_pop_req),
+        .pop_qid(st_pop_qid),
+        .data_out(st_data_out),
+        .pop_ok(st_pop_ok),
+        .q_valid(st_q_valid),
+        .free_count(st_free_count)
+    );
+
+endmodule
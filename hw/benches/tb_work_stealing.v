@@ -0,0 +1,120 @@
+// hw/benches/tb_work_stealing.v
+// Top for the work-stealing benchmark: hb_work_stealing with round-robin victim
+// selection (ws0_*), the same with random victims (ws1_*), and one central
+// hb_task_queue_core holding the same total storage (c_*) as the baseline.
+// Each has its own port set so the harness can drive all three with the same
+// workload and score them independently.
+`timescale 1ns/1ps
+
+module tb_work_stealing #(
+    parameter NUM_GROUPS = 4,
+    parameter DEPTH = 16                // per-group deque depth; the central queue holds NUM_GROUPS * DEPTH
+)(
+    input  logic clk,
+    input  logic reset,
+
+    // work stealing, round-robin victims
+    input  logic [NUM_GROUPS-1:0] ws0_push_req,
+    input  logic [NUM_GROUPS*32-1:0] ws0_push_data,
+    output logic [NUM_GROUPS-1:0] ws0_push_ok,
+    input  logic [NUM_GROUPS-1:0] ws0_take_req,
+    output logic [NUM_GROUPS-1:0] ws0_take_ok,
+    output logic [NUM_GROUPS-1:0] ws0_take_stolen,
+    output logic [NUM_GROUPS*32-1:0] ws0_take_data,
+    output logic [NUM_GROUPS*$clog2(DEPTH+1)-1:0] ws0_occupancy,
+
+    // work stealing, random victims
+    input  logic [NUM_GROUPS-1:0] ws1_push_req,
+    input  logic [NUM_GROUPS*32-1:0] ws1_push_data,
+    output logic [NUM_GROUPS-1:0] ws1_push_ok,
+    input  logic [NUM_GROUPS-1:0] ws1_take_req,
+    output logic [NUM_GROUPS-1:0] ws1_take_ok,
+    output logic [NUM_GROUPS-1:0] ws1_take_stolen,
+    output logic [NUM_GROUPS*32-1:0] ws1_take_data,
+    output logic [NUM_GROUPS*$clog2(DEPTH+1)-1:0] ws1_occupancy,
+
+    // centralized queue
+    input  logic c_push_req,
+    input  logic [31:0] c_data_in,
+    output logic c_full,
+    input  logic c_pop_req,
+    output logic c_valid_out,
+    output logic [31:0] c_data_out,
+    output logic [$clog2(NUM_GROUPS*DEPTH+1)-1:0] c_occupancy
+);
+
+    hb_work_stealing #(
+        .NUM_GROUPS(NUM_GROUPS),
+        .DEPTH(DEPTH),
+        .WIDTH(32),
+        .STEAL_POLICY(0)
+    ) ws_rr (
+        .clk(clk),
+        .reset(reset),
+        .push_req(ws0_push_req),
+        .push_data(ws0_push_data),
+        .push_ok(ws0_push_ok),
+        .take_req(ws0_take_req),
+        .take_ok(ws0_take_ok),
+        .take_stolen(ws0_take_stolen),
+        .take_data(ws0_take_data),
+        .occupancy(ws0_occupancy)
+    );
+
+    hb_work_stealing #(
+        .NUM_GROUPS(NUM_GROUPS),
+        .DEPTH(DEPTH),
+        .WIDTH(32),
+        .STEAL_POLICY(1)
+    ) ws_rand (
+        .clk(clk),
+        .reset(reset),
+        .push_req(ws1_push_req),
+        .push_data(ws1_push_data),
+        .push_ok(ws1_push_ok),
+        .take_req(ws1_take_req),
+        .take_ok(ws1_take_ok),
+        .take_stolen(ws1_take_stolen),
+        .take_data(ws1_take_data),
+        .occupancy(ws1_occupancy)
+    );
+
+    localparam C_DEPTH = NUM_GROUPS * DEPTH;
+    localparam [$clog2(C_DEPTH+1)-1:0] C_DEPTH_C = C_DEPTH;
+
+    logic c_almost_full, c_almost_empty;
+    logic [1:0] c_doorbell;
+    logic [31:0] c_ts, c_residency;
+
+    hb_task_queue_core #(
+        .DEPTH(C_DEPTH),
+        .WIDTH(32)
+    ) central (
+        .clk(clk),
+        .reset(reset),
+        .push_req(c_push_req),
+        .data_in(c_data_in),
+        .full(c_full),
+        .valid_out(c_valid_out),
+        .data_out(c_data_out),
+        .pop_req(c_pop_req),
+        .occupancy(c_occupancy),
+        .wm_we(1'b0),
+        .wm_high_in(C_DEPTH_C),
+        .wm_low_in('0),
+        .almost_full(c_almost_full),
+        .almost_empty(c_almost_empty),
+        .doorbell(c_doorbell),
+        .ts_out(c_ts),
+        .residency(c_residency)
+    );
+
+    // watermark, doorbell and timestamp outputs are not used here
+    wire unused_ok = c_almost_full | c_almost_empty | (|c_doorbell) | (|c_ts) | (|c_residency);
+    // synthesis translate_off
+    initial begin
+        if (unused_ok) begin end
+    end
+    // synthesis translate_on
+
+endmodule
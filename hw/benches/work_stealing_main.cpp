@@ -0,0 +1,292 @@
+// hw/benches/work_stealing_main.cpp
+// Work-stealing benchmark: NUM_GROUPS follower groups (one follower each) fed
+// through tb_work_stealing, comparing per-group deques with round-robin and
+// random victim selection against one central FIFO.
+//
+// Workload: every cycle each group's producer creates a task with probability
+// --arrival-rate / NUM_GROUPS. Task durations are skewed: group 0 creates long
+// tasks (exponential, mean --long cycles), the other groups short ones (mean
+// --short). On the work-stealing sides a task goes into its own group's deque;
+// on the central side all tasks share one FIFO that takes one push and gives
+// one pop per cycle, handed round-robin to an idle follower. Tasks that cannot
+// be pushed wait in their producer's backlog. Every side sees exactly the same
+// tasks; each task must be started exactly once.
+// Without workload flags it runs a coarse configuration (0.2 tasks/cycle,
+// means 40 / 8) and a fine one (2 tasks/cycle, means 4 / 1).
+//
+// Reports follower idle cycles, load balance (busy-cycle spread across
+// followers), steals and task wait time (creation to start).
+// Results go to outputs/bench_ws.json as {"bench": {"key": value, ...}}.
+#include "Vtb_work_stealing.h"
+#include "verilated.h"
+#include "../follower_model.h"
+#include "bench_util.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace std;
+
+// Must match the tb_work_stealing parameters (the Makefile passes them via -G and -CFLAGS)
+#ifndef NUM_GROUPS
+#define NUM_GROUPS 4
+#endif
+
+// the mask ports below are 8-bit
+static_assert(NUM_GROUPS >= 2 && NUM_GROUPS <= 8, "work-stealing harness supports 2..8 groups");
+
+static Vtb_work_stealing *top = nullptr;
+
+using GroupBus = decltype(Vtb_work_stealing::ws0_push_data);
+
+// A task as created by a producer: its ID doubles as the queued data word.
+struct Task {
+    uint32_t duration;
+    uint64_t created;
+    uint8_t group;
+};
+static vector<Task> tasks;   // index = task ID (0 unused)
+
+// Followers, backlogs and counters of one side.
+struct Side {
+    string name;
+    FollowerModel followers[NUM_GROUPS];
+    deque<uint32_t> backlog[NUM_GROUPS];   // work stealing: per group; central: [0] only
+    vector<uint8_t> started;
+    uint64_t idle[NUM_GROUPS] = {};
+    uint64_t steals = 0, duplicates = 0, wait_sum = 0;
+    vector<uint32_t> waits;
+    int rr = 0;                            // central: next follower to hand a task to
+};
+
+static void start_task(Side &s, int f, uint32_t id, uint64_t cycle) {
+    if (id == 0 || id >= tasks.size() || s.started[id]) {
+        s.duplicates++;
+        return;
+    }
+    s.started[id] = 1;
+    uint32_t wait = (uint32_t)(cycle - tasks[id].created);
+    s.waits.push_back(wait);
+    s.wait_sum += wait;
+    s.followers[f].accept(id, tasks[id].duration);
+}
+
+struct WsPorts {
+    CData *push_req;
+    GroupBus *push_data;
+    CData *push_ok, *take_req, *take_ok, *take_stolen;
+    GroupBus *take_data;
+};
+
+static void drive_ws(Side &s, const WsPorts &p) {
+    CData push = 0, take = 0;
+    for (int g = 0; g < NUM_GROUPS; g++) {
+        if (!s.backlog[g].empty()) {
+            push |= (CData)(1u << g);
+            bus_put(*p.push_data, g, s.backlog[g].front());
+        }
+        if (s.followers[g].ready()) take |= (CData)(1u << g);
+    }
+    *p.push_req = push;
+    *p.take_req = take;
+}
+
+static void score_ws(Side &s, const WsPorts &p, uint64_t cycle) {
+    for (int g = 0; g < NUM_GROUPS; g++) {
+        if (*p.push_ok & (1u << g)) s.backlog[g].pop_front();
+        if (*p.take_ok & (1u << g)) {
+            if (*p.take_stolen & (1u << g)) s.steals++;
+            start_task(s, g, bus_word(*p.take_data, g), cycle);
+        }
+    }
+}
+
+// central FIFO: one push from the shared backlog, one pop to the next idle follower
+static int drive_central(Side &s) {
+    top->c_push_req = !s.backlog[0].empty();
+    top->c_data_in = s.backlog[0].empty() ? 0 : s.backlog[0].front();
+    int f_pick = -1;
+    if (top->c_valid_out) {
+        for (int k = 0; k < NUM_GROUPS; k++) {
+            int f = (s.rr + k) % NUM_GROUPS;
+            if (s.followers[f].ready()) {
+                f_pick = f;
+                break;
+            }
+        }
+    }
+    top->c_pop_req = f_pick >= 0;
+    return f_pick;
+}
+
+static void score_central(Side &s, int f_pick, uint64_t cycle) {
+    if (top->c_push_req && !top->c_full) s.backlog[0].pop_front();
+    if (f_pick >= 0) {
+        start_task(s, f_pick, top->c_data_out, cycle);
+        s.rr = (f_pick + 1) % NUM_GROUPS;
+    }
+}
+
+static void report(Side &s, uint64_t ncycles, uint64_t created) {
+    uint64_t completed = 0, idle_sum = 0;
+    double busy_mean = 0.0, busy_max = 0.0, busy_min = 1e300;
+    for (int f = 0; f < NUM_GROUPS; f++) {
+        completed += s.followers[f].completed;
+        idle_sum += s.idle[f];
+        double b = (double)s.followers[f].busy_cycles;
+        busy_mean += b / NUM_GROUPS;
+        busy_max = max(busy_max, b);
+        busy_min = min(busy_min, b);
+    }
+    double var = 0.0;
+    for (int f = 0; f < NUM_GROUPS; f++) {
+        double d = (double)s.followers[f].busy_cycles - busy_mean;
+        var += d * d / NUM_GROUPS;
+    }
+    double busy_cov = busy_mean > 0 ? sqrt(var) / busy_mean : 0.0;
+    double imbalance = busy_mean > 0 ? busy_max / busy_mean : 0.0;
+    uint64_t started = 0;
+    for (uint8_t v : s.started) started += v;
+    uint64_t backlog = 0;
+    for (int g = 0; g < NUM_GROUPS; g++) backlog += s.backlog[g].size();
+
+    sort(s.waits.begin(), s.waits.end());
+    double wait_mean = s.waits.empty() ? 0.0 : (double)s.wait_sum / s.waits.size();
+    double wait_p99 = s.waits.empty() ? 0.0 : s.waits[(size_t)(s.waits.size() * 0.99)];
+    double idle_frac = (double)idle_sum / ((double)ncycles * NUM_GROUPS);
+
+    printf("[HOST] %s: created=%llu started=%llu completed=%llu idle_frac=%.3f busy_max/mean=%.3f busy_cov=%.3f "
+           "steals=%llu wait mean=%.1f p99=%.0f backlog=%llu duplicates=%llu\n",
+           s.name.c_str(), (unsigned long long)created, (unsigned long long)started, (unsigned long long)completed,
+           idle_frac, imbalance, busy_cov, (unsigned long long)s.steals, wait_mean, wait_p99,
+           (unsigned long long)backlog, (unsigned long long)s.duplicates);
+    bench_record(s.name, "num_groups", NUM_GROUPS);
+    bench_record(s.name, "cycles", (double)ncycles);
+    bench_record(s.name, "tasks_created", (double)created);
+    bench_record(s.name, "tasks_started", (double)started);
+    bench_record(s.name, "tasks_completed", (double)completed);
+    bench_record(s.name, "throughput_tasks_per_cycle", (double)completed / ncycles);
+    bench_record(s.name, "idle_cycles", (double)idle_sum);
+    bench_record(s.name, "idle_frac", idle_frac);
+    bench_record(s.name, "busy_max_over_mean", imbalance);
+    bench_record(s.name, "busy_min_over_mean", busy_mean > 0 ? busy_min / busy_mean : 0.0);
+    bench_record(s.name, "busy_cov", busy_cov);
+    bench_record(s.name, "steals", (double)s.steals);
+    bench_record(s.name, "wait_mean_cycles", wait_mean);
+    bench_record(s.name, "wait_p99_cycles", wait_p99);
+    bench_record(s.name, "backlog_at_end", (double)backlog);
+    bench_record(s.name, "duplicates", (double)s.duplicates);
+}
+
+static uint64_t total_duplicates = 0;
+
+static void run_ws_bench(const char *cfg, uint64_t ncycles, double arrival_rate, uint32_t long_mean,
+                         uint32_t short_mean) {
+    ServiceConfig long_cfg, short_cfg;
+    long_cfg.dist = short_cfg.dist = SERVICE_EXPONENTIAL;
+    long_cfg.mean = long_mean;
+    short_cfg.mean = short_mean;
+    ServiceSampler long_tasks(long_cfg, 11), short_tasks(short_cfg, 12);
+
+    Side sides[3];
+    sides[0].name = string("ws_") + cfg + "_rr";
+    sides[1].name = string("ws_") + cfg + "_random";
+    sides[2].name = string("ws_") + cfg + "_central";
+    WsPorts ports[2] = {
+        {&top->ws0_push_req, &top->ws0_push_data, &top->ws0_push_ok, &top->ws0_take_req,
+         &top->ws0_take_ok, &top->ws0_take_stolen, &top->ws0_take_data},
+        {&top->ws1_push_req, &top->ws1_push_data, &top->ws1_push_ok, &top->ws1_take_req,
+         &top->ws1_take_ok, &top->ws1_take_stolen, &top->ws1_take_data},
+    };
+
+    // reset all three DUTs
+    top->reset = 1;
+    top->ws0_push_req = top->ws0_take_req = 0;
+    top->ws1_push_req = top->ws1_take_req = 0;
+    top->c_push_req = top->c_pop_req = 0;
+    for (int i = 0; i < 4; i++) {
+        top->clk = 0; top->eval();
+        top->clk = 1; top->eval();
+    }
+    top->reset = 0;
+
+    mt19937 rng(1);
+    uniform_real_distribution<double> u01(0.0, 1.0);
+    double p_task = arrival_rate / NUM_GROUPS;
+    tasks.clear();
+    tasks.push_back({0, 0, 0});
+
+    for (uint64_t cycle = 0; cycle < ncycles; cycle++) {
+        // new tasks, identical for every side
+        for (int g = 0; g < NUM_GROUPS; g++) {
+            if (u01(rng) >= p_task) continue;
+            uint32_t id = (uint32_t)tasks.size();
+            tasks.push_back({g == 0 ? long_tasks.sample() : short_tasks.sample(), cycle, (uint8_t)g});
+            for (int i = 0; i < 2; i++) sides[i].backlog[g].push_back(id);
+            sides[2].backlog[0].push_back(id);
+        }
+        for (Side &s : sides) s.started.resize(tasks.size(), 0);
+
+        top->clk = 0;
+        for (int i = 0; i < 2; i++) drive_ws(sides[i], ports[i]);
+        int c_pick = drive_central(sides[2]);
+        top->eval();
+        for (int i = 0; i < 2; i++) score_ws(sides[i], ports[i], cycle);
+        score_central(sides[2], c_pick, cycle);
+        top->clk = 1;
+        top->eval();
+
+        for (Side &s : sides) {
+            for (int f = 0; f < NUM_GROUPS; f++) {
+                if (s.followers[f].ready()) s.idle[f]++;
+                s.followers[f].step();
+            }
+        }
+    }
+
+    for (Side &s : sides) {
+        report(s, ncycles, tasks.size() - 1);
+        bench_record(s.name, "arrival_rate", arrival_rate);
+        bench_record(s.name, "long_mean", long_mean);
+        bench_record(s.name, "short_mean", short_mean);
+        total_duplicates += s.duplicates;
+    }
+}
+
+int main(int argc, char **argv) {
+    Verilated::commandArgs(argc, argv);
+    mkdir("outputs", 0755);
+
+    top = new Vtb_work_stealing;
+    top->clk = 0;
+
+    uint64_t ncycles = strtoull(arg_value(argc, argv, "--cycles", "100000"), nullptr, 10);
+    const char *rate = arg_value(argc, argv, "--arrival-rate", nullptr);
+    const char *lng = arg_value(argc, argv, "--long", nullptr);
+    const char *shrt = arg_value(argc, argv, "--short", nullptr);
+
+    if (rate || lng || shrt) {
+        run_ws_bench("custom", ncycles, rate ? atof(rate) : 0.2, lng ? atoi(lng) : 40, shrt ? atoi(shrt) : 8);
+    } else {
+        // coarse tasks: dispatch rate is no issue, balance is
+        run_ws_bench("coarse", ncycles, 0.2, 40, 8);
+        // fine tasks: more than one task per cycle arrives across the groups
+        run_ws_bench("fine", ncycles, 2.0, 4, 1);
+    }
+    write_bench_json("outputs/bench_ws.json");
+
+    top->final();
+    delete top;
+    return total_duplicates == 0 ? 0 : 2;
+}
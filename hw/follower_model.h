@@ -0,0 +1,145 @@
+// follower_model.h
+// Cycle-level follower engine models for the Verilator harnesses.
+// A follower is ready while idle, accepts one task from its distributor port,
+// holds it for a service time drawn from a configurable distribution, then
+// becomes ready again. On a credit-based link the follower instead buffers
+// incoming tasks in its inbox and returns a credit each time it starts one.
+// Finished tasks can be queued in the outbox for posting on the completion
+// queue; the follower does not wait for a post to be accepted.
+// Counters mirror model/behavioral.py (follower busy time, completed tasks)
+// but are measured in RTL cycles.
+#ifndef FOLLOWER_MODEL_H
+#define FOLLOWER_MODEL_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <deque>
+#include <random>
+
+enum ServiceDist {
+    SERVICE_FIXED = 0,       // always mean
+    SERVICE_UNIFORM,         // uniform in [min, max]
+    SERVICE_EXPONENTIAL,     // exponential with the given mean (at least 1 cycle)
+    SERVICE_BIMODAL          // min with probability 1-p_long, otherwise max
+};
+
+struct ServiceConfig {
+    ServiceDist dist = SERVICE_FIXED;
+    uint32_t mean = 16;      // cycles
+    uint32_t min = 16;
+    uint32_t max = 16;
+    double p_long = 0.1;     // bimodal only
+};
+
+static inline const char *service_dist_name(ServiceDist d) {
+    switch (d) {
+    case SERVICE_UNIFORM:     return "uniform";
+    case SERVICE_EXPONENTIAL: return "exponential";
+    case SERVICE_BIMODAL:     return "bimodal";
+    default:                  return "fixed";
+    }
+}
+
+// Parse --service-dist fixed|uniform|exp|bimodal, --service-mean, --service-min,
+// --service-max and --service-plong. Giving only min/max selects uniform.
+static inline ServiceConfig parse_service_config(int argc, char **argv, uint32_t default_mean) {
+    ServiceConfig cfg;
+    cfg.mean = cfg.min = cfg.max = default_mean;
+    bool dist_given = false, range_given = false;
+    for (int i = 1; i < argc - 1; ++i) {
+        const char *v = argv[i+1];
+        if (strcmp(argv[i], "--service-dist") == 0) {
+            dist_given = true;
+            if (strcmp(v, "uniform") == 0) cfg.dist = SERVICE_UNIFORM;
+            else if (strcmp(v, "exp") == 0 || strcmp(v, "exponential") == 0) cfg.dist = SERVICE_EXPONENTIAL;
+            else if (strcmp(v, "bimodal") == 0) cfg.dist = SERVICE_BIMODAL;
+            else cfg.dist = SERVICE_FIXED;
+        } else if (strcmp(argv[i], "--service-mean") == 0) {
+            cfg.mean = (uint32_t)atoi(v);
+        } else if (strcmp(argv[i], "--service-min") == 0) {
+            cfg.min = (uint32_t)atoi(v);
+            range_given = true;
+        } else if (strcmp(argv[i], "--service-max") == 0) {
+            cfg.max = (uint32_t)atoi(v);
+            range_given = true;
+        } else if (strcmp(argv[i], "--service-plong") == 0) {
+            cfg.p_long = atof(v);
+        }
+    }
+    if (!dist_given && range_given) cfg.dist = SERVICE_UNIFORM;
+    if (cfg.max < cfg.min) cfg.max = cfg.min;
+    if (cfg.mean == 0) cfg.mean = 1;
+    if (cfg.min == 0) cfg.min = 1;
+    return cfg;
+}
+
+class ServiceSampler {
+public:
+    ServiceSampler(const ServiceConfig &cfg, uint32_t seed) : cfg_(cfg), rng_(seed) {}
+
+    uint32_t sample() {
+        switch (cfg_.dist) {
+        case SERVICE_UNIFORM: {
+            std::uniform_int_distribution<uint32_t> d(cfg_.min, cfg_.max);
+            return d(rng_);
+        }
+        case SERVICE_EXPONENTIAL: {
+            std::exponential_distribution<double> d(1.0 / cfg_.mean);
+            uint32_t v = (uint32_t)std::lround(d(rng_));
+            return v ? v : 1;
+        }
+        case SERVICE_BIMODAL: {
+            std::bernoulli_distribution d(cfg_.p_long);
+            return d(rng_) ? cfg_.max : cfg_.min;
+        }
+        default:
+            return cfg_.mean;
+        }
+    }
+
+    double mean() const {
+        switch (cfg_.dist) {
+        case SERVICE_UNIFORM:     return 0.5 * (cfg_.min + cfg_.max);
+        case SERVICE_EXPONENTIAL: return cfg_.mean;
+        case SERVICE_BIMODAL:     return (1.0 - cfg_.p_long) * cfg_.min + cfg_.p_long * cfg_.max;
+        default:                  return cfg_.mean;
+        }
+    }
+
+private:
+    ServiceConfig cfg_;
+    std::mt19937 rng_;
+};
+
+struct FollowerModel {
+    uint32_t busy_left = 0;     // cycles remaining on the current task
+    uint32_t task = 0;          // task word being executed
+    uint64_t busy_cycles = 0;
+    uint64_t served = 0;
+    uint64_t completed = 0;
+    std::deque<uint32_t> inbox; // credit mode: tasks received but not yet started
+    std::deque<uint32_t> outbox; // finished tasks not yet posted as completions
+
+    bool ready() const { return busy_left == 0; }
+
+    void accept(uint32_t t, uint32_t service_cycles) {
+        task = t;
+        busy_left = service_cycles ? service_cycles : 1;
+        served++;
+    }
+
+    // Advance one cycle. Returns true when the current task finishes this cycle.
+    bool step() {
+        if (busy_left == 0) return false;
+        busy_cycles++;
+        if (--busy_left == 0) {
+            completed++;
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // FOLLOWER_MODEL_H
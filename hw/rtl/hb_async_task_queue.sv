@@ -0,0 +1,102 @@
+// hb_async_task_queue.sv
+// Dual-clock variant of hb_task_queue_core: the push side runs on wclk (leader
+// domain), the pop side on rclk (follower domain). Each side keeps a binary
+// pointer for addressing and a Gray-coded copy that crosses to the other domain
+// through a SYNC_STAGES-deep flop synchronizer, so only one bit of a crossing
+// pointer changes per increment. full is computed from the write pointer and
+// the synchronized read pointer, valid_out from the read pointer and the
+// synchronized write pointer; both are conservative, so a slot freed by a pop
+// becomes visible to the producer SYNC_STAGES wclk edges later, and a pushed
+// entry becomes visible to the consumer SYNC_STAGES rclk edges later.
+//
+// Each domain has its own synchronous reset; assert both (with both clocks
+// running) for at least SYNC_STAGES + 1 cycles of the slower clock.
+// DEPTH must be a power of two and SYNC_STAGES at least 1.
+
+module hb_async_task_queue #(
+    parameter DEPTH = 16,
+    parameter WIDTH = 32,
+    parameter SYNC_STAGES = 2
+)(
+    // write (push) domain
+    input  logic wclk,
+    input  logic wreset,                // synchronous to wclk
+    input  logic push_req,
+    input  logic [WIDTH-1:0] data_in,
+    output logic full,
+    output logic [$clog2(DEPTH+1)-1:0] wr_occupancy,   // as seen from the write side
+
+    // read (pop) domain
+    input  logic rclk,
+    input  logic rreset,                // synchronous to rclk
+    input  logic pop_req,
+    output logic valid_out,
+    output logic [WIDTH-1:0] data_out,
+    output logic [$clog2(DEPTH+1)-1:0] rd_occupancy    // as seen from the read side
+);
+
+    localparam PTR_W = $clog2(DEPTH);
+    localparam [PTR_W:0] DEPTH_C = DEPTH;
+
+    function automatic [PTR_W:0] bin2gray(input [PTR_W:0] b);
+        return b ^ (b >> 1);
+    endfunction
+
+    function automatic [PTR_W:0] gray2bin(input [PTR_W:0] g);
+        for (int i = 0; i <= PTR_W; i++) gray2bin[i] = ^(g >> i);
+    endfunction
+
+    logic [WIDTH-1:0] mem [0:DEPTH-1];
+
+    // one extra pointer bit tells a full queue from an empty one
+    logic [PTR_W:0] wbin, wgray;
+    logic [PTR_W:0] rbin, rgray;
+    logic [PTR_W:0] rgray_sync [0:SYNC_STAGES-1];   // read pointer, in the wclk domain
+    logic [PTR_W:0] wgray_sync [0:SYNC_STAGES-1];   // write pointer, in the rclk domain
+
+    wire [PTR_W:0] rbin_w = gray2bin(rgray_sync[SYNC_STAGES-1]);
+    wire [PTR_W:0] wbin_r = gray2bin(wgray_sync[SYNC_STAGES-1]);
+
+    assign wr_occupancy = wbin - rbin_w;
+    assign full         = (wr_occupancy == DEPTH_C);
+    assign rd_occupancy = wbin_r - rbin;
+    assign valid_out    = (rd_occupancy != 0);
+    assign data_out     = mem[rbin[PTR_W-1:0]];
+
+    wire do_push = push_req && !full;
+    wire do_pop  = pop_req && valid_out;
+
+    // write domain: memory, write pointer, read-pointer synchronizer
+    always_ff @(posedge wclk) begin
+        if (wreset) begin
+            wbin  <= '0;
+            wgray <= '0;
+            for (int i = 0; i < SYNC_STAGES; i++) rgray_sync[i] <= '0;
+        end else begin
+            if (do_push) begin
+                mem[wbin[PTR_W-1:0]] <= data_in;
+                wbin  <= wbin + 1;
+                wgray <= bin2gray(wbin + 1);
+            end
+            rgray_sync[0] <= rgray;
+            for (int i = 1; i < SYNC_STAGES; i++) rgray_sync[i] <= rgray_sync[i-1];
+        end
+    end
+
+    // read domain: read pointer, write-pointer synchronizer
+    always_ff @(posedge rclk) begin
+        if (rreset) begin
+            rbin  <= '0;
+            rgray <= '0;
+            for (int i = 0; i < SYNC_STAGES; i++) wgray_sync[i] <= '0;
+        end else begin
+            if (do_pop) begin
+                rbin  <= rbin + 1;
+                rgray <= bin2gray(rbin + 1);
+            end
+            wgray_sync[0] <= wgray;
+            for (int i = 1; i < SYNC_STAGES; i++) wgray_sync[i] <= wgray_sync[i-1];
+        end
+    end
+
+endmodule
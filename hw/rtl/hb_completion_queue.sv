@@ -0,0 +1,113 @@
+// hb_completion_queue.sv
+// Return path from the followers to the leader. Each follower posts a finished
+// task's ID (or a result word) on its cpl_valid / cpl_data port; one post per
+// cycle is accepted, picked round-robin among the posting followers, and
+// queued in an hb_task_queue_core together with the poster's index. A follower
+// holds its post until cpl_ready[i], so nothing is dropped when the queue is
+// full. The leader reads cq_data / cq_follower at the head and pops with cq_pop.
+//
+// post_valid / post_data show the post picked this cycle. Raising post_consume
+// for it (e.g. because another block such as hb_join_table takes it) accepts
+// the post without queueing it, even while the queue is full.
+
+module hb_completion_queue #(
+    parameter NUM_FOLLOWERS = 4,
+    parameter DEPTH = 16,
+    parameter WIDTH = 32
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic [NUM_FOLLOWERS-1:0] cpl_valid,
+    input  logic [NUM_FOLLOWERS*WIDTH-1:0] cpl_data,
+    output logic [NUM_FOLLOWERS-1:0] cpl_ready,
+    input  logic cq_pop,
+    output logic cq_valid,
+    output logic [WIDTH-1:0] cq_data,
+    output logic [((NUM_FOLLOWERS > 1) ? $clog2(NUM_FOLLOWERS) : 1)-1:0] cq_follower,
+    output logic [$clog2(DEPTH+1)-1:0] cq_occupancy,
+    output logic post_valid,
+    output logic [WIDTH-1:0] post_data,
+    input  logic post_consume
+);
+
+    localparam SEL_W = (NUM_FOLLOWERS > 1) ? $clog2(NUM_FOLLOWERS) : 1;
+    localparam CNT_W = $clog2(DEPTH+1);
+    localparam [CNT_W-1:0] DEPTH_C = DEPTH;
+
+    logic full;
+    logic [SEL_W-1:0] rr_ptr, sel;
+    logic found;
+    logic [SEL_W+WIDTH-1:0] q_out;
+
+    // round-robin pick among posting followers, starting one past the last accepted
+    always_comb begin
+        int c;
+        sel = '0;
+        found = 1'b0;
+        for (int k = 0; k < NUM_FOLLOWERS; k++) begin
+            c = int'(rr_ptr) + k;
+            if (c >= NUM_FOLLOWERS) c = c - NUM_FOLLOWERS;
+            if (!found && cpl_valid[c]) begin
+                found = 1'b1;
+                sel = SEL_W'(c);
+            end
+        end
+    end
+
+    assign post_valid = found;
+    assign post_data  = cpl_data[int'(sel)*WIDTH +: WIDTH];
+    wire do_post = found && (!full || post_consume);
+
+    // kept apart from the pick above: post_consume may be derived from post_data
+    always_comb begin
+        cpl_ready = '0;
+        if (do_post) cpl_ready[sel] = 1'b1;
+    end
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            rr_ptr <= '0;
+        end else if (do_post) begin
+            rr_ptr <= (int'(sel) == NUM_FOLLOWERS - 1) ? '0 : sel + SEL_W'(1);
+        end
+    end
+
+    logic almost_full, almost_empty;
+    logic [1:0] doorbell;
+    logic [31:0] ts, residency;
+
+    hb_task_queue_core #(
+        .DEPTH(DEPTH),
+        .WIDTH(SEL_W + WIDTH)
+    ) fifo (
+        .clk(clk),
+        .reset(reset),
+        .push_req(do_post && !post_consume),
+        .data_in({sel, post_data}),
+        .full(full),
+        .valid_out(cq_valid),
+        .data_out(q_out),
+        .pop_req(cq_pop),
+        .occupancy(cq_occupancy),
+        .wm_we(1'b0),
+        .wm_high_in(DEPTH_C),
+        .wm_low_in('0),
+        .almost_full(almost_full),
+        .almost_empty(almost_empty),
+        .doorbell(doorbell),
+        .ts_out(ts),
+        .residency(residency)
+    );
+
+    assign cq_follower = q_out[SEL_W+WIDTH-1:WIDTH];
+    assign cq_data = q_out[WIDTH-1:0];
+
+    // watermark, doorbell and timestamp outputs are not used here
+    wire unused_ok = almost_full | almost_empty | (|doorbell) | (|ts) | (|residency);
+    // synthesis translate_off
+    initial begin
+        if (unused_ok) begin end
+    end
+    // synthesis translate_on
+
+endmodule
@@ -0,0 +1,116 @@
+// hb_multi_queue.sv
+// NUM_QUEUES virtual FIFOs sharing one pool of POOL_DEPTH entries.
+// Entries are linked lists: next_mem chains each queue from head to tail, and the
+// free entries form one more list (the free list) headed by free_head. A push
+// takes the free-list head, a pop returns its entry to the free list, so an idle
+// queue holds no storage and a busy one can grow up to MAX_PER_QUEUE entries.
+//
+// Queue IDs come with every push (push_qid) and pop (pop_qid). data_out is the
+// head entry of queue pop_qid, valid while q_valid[pop_qid] is set; a pop takes
+// it on the clock edge. push_ok / pop_ok report whether the request is accepted
+// this cycle. A push and a pop may happen in the same cycle, even on the same
+// queue, and the push may reuse the entry being popped when the pool is empty.
+// NUM_QUEUES must be at least 2.
+
+module hb_multi_queue #(
+    parameter NUM_QUEUES = 8,
+    parameter POOL_DEPTH = 64,
+    parameter WIDTH = 32,
+    parameter MAX_PER_QUEUE = POOL_DEPTH     // cap so one queue cannot starve the rest
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic push_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] push_qid,
+    input  logic [WIDTH-1:0] data_in,
+    output logic push_ok,
+    input  logic pop_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] pop_qid,
+    output logic [WIDTH-1:0] data_out,
+    output logic pop_ok,
+    output logic [NUM_QUEUES-1:0] q_valid,
+    output logic [$clog2(POOL_DEPTH+1)-1:0] free_count
+);
+
+    localparam PTR_W = $clog2(POOL_DEPTH);
+    localparam CNT_W = $clog2(POOL_DEPTH+1);
+    localparam [CNT_W-1:0] POOL_C = POOL_DEPTH;
+    localparam [CNT_W-1:0] MAXQ_C = MAX_PER_QUEUE;
+
+    logic [WIDTH-1:0] data_mem [0:POOL_DEPTH-1];
+    logic [PTR_W-1:0] next_mem [0:POOL_DEPTH-1];
+    logic [PTR_W-1:0] head [0:NUM_QUEUES-1];
+    logic [PTR_W-1:0] tail [0:NUM_QUEUES-1];
+    logic [CNT_W-1:0] count [0:NUM_QUEUES-1];
+    logic [PTR_W-1:0] free_head;
+    logic [CNT_W-1:0] free_cnt;
+
+    wire [PTR_W-1:0] pop_entry = head[pop_qid];
+    wire same_q = (push_qid == pop_qid);
+
+    assign data_out   = data_mem[pop_entry];
+    assign free_count = free_cnt;
+    assign pop_ok     = pop_req && (count[pop_qid] != 0);
+    assign push_ok    = push_req && (free_cnt != 0 || pop_ok) && (count[push_qid] < MAXQ_C);
+
+    always_comb begin
+        for (int q = 0; q < NUM_QUEUES; q++) q_valid[q] = (count[q] != 0);
+    end
+
+    // entry for the push: the free-list head, or the entry being popped when the pool is dry
+    wire [PTR_W-1:0] alloc = (free_cnt != 0) ? free_head : pop_entry;
+    // the push lands in a queue that is empty once this cycle's pop is done
+    wire push_into_empty = (count[push_qid] == 0) || (pop_ok && same_q && count[push_qid] == 1);
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            for (int i = 0; i < POOL_DEPTH; i++) begin
+                next_mem[i] <= PTR_W'(i + 1);   // free list: 0 -> 1 -> ... -> POOL_DEPTH-1
+            end
+            for (int q = 0; q < NUM_QUEUES; q++) begin
+                head[q]  <= '0;
+                tail[q]  <= '0;
+                count[q] <= '0;
+            end
+            free_head <= '0;
+            free_cnt  <= POOL_C;
+        end else begin
+            // pop: advance the queue head
+            if (pop_ok) begin
+                head[pop_qid] <= next_mem[pop_entry];
+            end
+
+            // push: write the entry and link it behind the tail (overrides the
+            // pop's head update when both hit the same single-entry queue)
+            if (push_ok) begin
+                data_mem[alloc] <= data_in;
+                if (push_into_empty) begin
+                    head[push_qid] <= alloc;
+                end else begin
+                    next_mem[tail[push_qid]] <= alloc;
+                end
+                tail[push_qid] <= alloc;
+            end
+
+            // free list: the popped entry goes to the front, the pushed one leaves it
+            if (pop_ok && push_ok) begin
+                if (free_cnt != 0) begin
+                    next_mem[pop_entry] <= next_mem[free_head];
+                    free_head <= pop_entry;
+                end
+                // pool dry: the push reused pop_entry, the free list is unchanged
+            end else if (pop_ok) begin
+                next_mem[pop_entry] <= free_head;
+                free_head <= pop_entry;
+                free_cnt  <= free_cnt + 1;
+            end else if (push_ok) begin
+                free_head <= next_mem[free_head];
+                free_cnt  <= free_cnt - 1;
+            end
+
+            if (push_ok && !(pop_ok && same_q)) count[push_qid] <= count[push_qid] + 1;
+            if (pop_ok && !(push_ok && same_q)) count[pop_qid] <= count[pop_qid] - 1;
+        end
+    end
+
+endmodule
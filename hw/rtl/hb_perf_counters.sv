@@ -0,0 +1,59 @@
+// hb_perf_counters.sv
+// Free-running performance counters that watch the queue core's host interface.
+// All counters reset with the core and can also be zeroed at run time by a
+// one-cycle clear pulse. A refused push is a push_req while full; a refused pop
+// is a pop_req while empty (the core ignores both, the counters record them).
+// occ_sum accumulates the occupancy every cycle, so mean depth = occ_sum / cycles.
+// Counters saturate instead of wrapping.
+
+module hb_perf_counters #(
+    parameter DEPTH = 16
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic clear,                 // zero all counters (one-cycle pulse)
+    input  logic push_req,
+    input  logic pop_req,
+    input  logic full,
+    input  logic valid_out,
+    input  logic [$clog2(DEPTH+1)-1:0] occupancy,
+
+    output logic [63:0] cycles,
+    output logic [31:0] pushes,
+    output logic [31:0] pops,
+    output logic [31:0] push_refused,
+    output logic [31:0] pop_refused,
+    output logic [31:0] full_cycles,
+    output logic [31:0] empty_cycles,
+    output logic [63:0] occ_sum,
+    output logic [$clog2(DEPTH+1)-1:0] max_occ
+);
+
+    localparam [31:0] SAT32 = 32'hFFFF_FFFF;
+
+    always_ff @(posedge clk) begin
+        if (reset || clear) begin
+            cycles       <= '0;
+            pushes       <= '0;
+            pops         <= '0;
+            push_refused <= '0;
+            pop_refused  <= '0;
+            full_cycles  <= '0;
+            empty_cycles <= '0;
+            occ_sum      <= '0;
+            max_occ      <= '0;
+        end else begin
+            cycles  <= cycles + 1;
+            occ_sum <= occ_sum + 64'(occupancy);
+            if (occupancy > max_occ) max_occ <= occupancy;
+
+            if (push_req && !full && pushes != SAT32) pushes <= pushes + 1;
+            if (push_req && full && push_refused != SAT32) push_refused <= push_refused + 1;
+            if (pop_req && valid_out && pops != SAT32) pops <= pops + 1;
+            if (pop_req && !valid_out && pop_refused != SAT32) pop_refused <= pop_refused + 1;
+            if (full && full_cycles != SAT32) full_cycles <= full_cycles + 1;
+            if (!valid_out && empty_cycles != SAT32) empty_cycles <= empty_cycles + 1;
+        end
+    end
+
+endmodule
@@ -0,0 +1,87 @@
+// hb_static_multi_queue.sv
+// Baseline for hb_multi_queue: NUM_QUEUES independent hb_task_queue_core FIFOs of
+// DEPTH_PER_QUEUE entries each, behind the same queue-ID interface. Storage is
+// statically partitioned, so a push is refused as soon as its own FIFO is full,
+// even while other FIFOs sit empty.
+
+module hb_static_multi_queue #(
+    parameter NUM_QUEUES = 8,
+    parameter DEPTH_PER_QUEUE = 8,
+    parameter WIDTH = 32
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic push_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] push_qid,
+    input  logic [WIDTH-1:0] data_in,
+    output logic push_ok,
+    input  logic pop_req,
+    input  logic [$clog2(NUM_QUEUES)-1:0] pop_qid,
+    output logic [WIDTH-1:0] data_out,
+    output logic pop_ok,
+    output logic [NUM_QUEUES-1:0] q_valid,
+    output logic [$clog2(NUM_QUEUES*DEPTH_PER_QUEUE+1)-1:0] free_count
+);
+
+    localparam OCC_W = $clog2(DEPTH_PER_QUEUE+1);
+    localparam FREE_W = $clog2(NUM_QUEUES*DEPTH_PER_QUEUE+1);
+    localparam [OCC_W-1:0] DEPTH_C = DEPTH_PER_QUEUE;
+
+    logic [NUM_QUEUES-1:0] q_full, q_almost_full, q_almost_empty;
+    logic [WIDTH-1:0] q_data [0:NUM_QUEUES-1];
+    logic [OCC_W-1:0] q_occ [0:NUM_QUEUES-1];
+    logic [1:0] q_doorbell [0:NUM_QUEUES-1];
+    logic [31:0] q_ts [0:NUM_QUEUES-1];
+    logic [31:0] q_residency [0:NUM_QUEUES-1];
+
+    genvar g;
+    generate
+        for (g = 0; g < NUM_QUEUES; g++) begin : g_fifo
+            localparam [$clog2(NUM_QUEUES)-1:0] QID = g;
+            hb_task_queue_core #(.DEPTH(DEPTH_PER_QUEUE), .WIDTH(WIDTH)) fifo (
+                .clk(clk),
+                .reset(reset),
+                .push_req(push_req && push_qid == QID),
+                .data_in(data_in),
+                .full(q_full[g]),
+                .valid_out(q_valid[g]),
+                .data_out(q_data[g]),
+                .pop_req(pop_req && pop_qid == QID),
+                .occupancy(q_occ[g]),
+                .wm_we(1'b0),
+                .wm_high_in(DEPTH_C),
+                .wm_low_in('0),
+                .almost_full(q_almost_full[g]),
+                .almost_empty(q_almost_empty[g]),
+                .doorbell(q_doorbell[g]),
+                .ts_out(q_ts[g]),
+                .residency(q_residency[g])
+            );
+        end
+    endgenerate
+
+    assign push_ok  = push_req && !q_full[push_qid];
+    assign pop_ok   = pop_req && q_valid[pop_qid];
+    assign data_out = q_data[pop_qid];
+
+    always_comb begin
+        free_count = '0;
+        for (int q = 0; q < NUM_QUEUES; q++) free_count = free_count + FREE_W'(DEPTH_C - q_occ[q]);
+    end
+
+    // watermark, doorbell and timestamp outputs are not used by this wrapper;
+    // reference them in a non-synthesizable block so Verilator does not flag them.
+    logic unused_any;
+    always_comb begin
+        unused_any = (|q_almost_full) | (|q_almost_empty);
+        for (int q = 0; q < NUM_QUEUES; q++) begin
+            unused_any = unused_any | (|q_doorbell[q]) | (|q_ts[q]) | (|q_residency[q]);
+        end
+    end
+    // synthesis translate_off
+    initial begin
+        if (unused_any) begin end
+    end
+    // synthesis translate_on
+
+endmodule
@@ -1,38 +1,174 @@
 // hb_task_distributor.sv
-module hb_task_distributor (
+// Two-entry skid buffer between the queue core and NUM_FOLLOWERS follower ports.
+// Sustains one task per cycle; in_ready is registered so follower backpressure
+// never forms a combinational path back into the queue core.
+//
+// Each follower port has its own output register (out_valid[i] / out_data slice i).
+// A task leaves the skid buffer into a follower whose register is free (empty, or
+// being drained this cycle). The follower is chosen by POLICY:
+//   0: round-robin (rotates past the last follower served)
+//   1: first-ready (lowest-index free follower)
+//   2: least-recently-served (free follower idle for the most grants)
+//
+// With CREDITS > 0 the follower link is credit-based: each follower starts with
+// CREDITS credits (the depth of its input buffer), a send consumes one, and the
+// follower returns one by pulsing credit_return[i] when it frees a buffer entry.
+// A follower without credits is never selected. With CREDITS == 0 credit_return
+// is ignored and consumer_ready alone gates the port.
+
+module hb_task_distributor #(
+    parameter WIDTH = 32,
+    parameter NUM_FOLLOWERS = 1,
+    parameter POLICY = 0,
+    parameter CREDITS = 0
+)(
     input  logic clk,
     input  logic reset,                 // synchronous reset
     input  logic in_valid,
-    input  logic [31:0] in_data,
-    output logic out_valid,
-    output logic [31:0] out_data,
-    input  logic consumer_ready
+    input  logic [WIDTH-1:0] in_data,
+    output logic in_ready,              // pop_req back to the queue core is in_valid && in_ready
+    output logic [NUM_FOLLOWERS-1:0] out_valid,
+    output logic [NUM_FOLLOWERS*WIDTH-1:0] out_data,
+    input  logic [NUM_FOLLOWERS-1:0] consumer_ready,
+    input  logic [NUM_FOLLOWERS-1:0] credit_return
 );
 
-    logic buffered_valid;
-    logic [31:0] buffered_data;
-    logic [31:0] in_data_reg;
+    localparam SEL_W = (NUM_FOLLOWERS > 1) ? $clog2(NUM_FOLLOWERS) : 1;
+    localparam AGE_W = 8;
+    localparam CRED_W = (CREDITS > 0) ? $clog2(CREDITS+1) : 1;
+
+    logic main_valid, skid_valid;
+    logic [WIDTH-1:0] main_data, skid_data;
+
+    logic [NUM_FOLLOWERS-1:0] slot_valid;
+    logic [WIDTH-1:0] slot_data [0:NUM_FOLLOWERS-1];
+
+    logic [NUM_FOLLOWERS-1:0] slot_free;
+    logic [NUM_FOLLOWERS-1:0] grant;
+    logic [SEL_W-1:0] rr_ptr;
+    logic [AGE_W-1:0] age [0:NUM_FOLLOWERS-1];   // grants since follower i was last served
+    logic [CRED_W-1:0] credit [0:NUM_FOLLOWERS-1];
 
-    assign out_valid = buffered_valid;
-    assign out_data  = buffered_data;
+    assign in_ready  = !skid_valid;
+    assign out_valid = slot_valid;
+
+    always_comb begin
+        for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+            out_data[i*WIDTH +: WIDTH] = slot_data[i];
+            slot_free[i] = (!slot_valid[i] || consumer_ready[i]) && (CREDITS == 0 || credit[i] != 0);
+        end
+    end
+
+    // follower selection for the task in the main register
+    always_comb begin
+        logic found;
+        logic [AGE_W-1:0] best_age;
+        grant = '0;
+        found = 1'b0;
+        best_age = '0;
+        if (main_valid) begin
+            case (POLICY)
+                1: begin
+                    for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+                        if (!found && slot_free[i]) begin
+                            grant[i] = 1'b1;
+                            found = 1'b1;
+                        end
+                    end
+                end
+                2: begin
+                    for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+                        if (slot_free[i] && (!found || age[i] > best_age)) begin
+                            grant = '0;
+                            grant[i] = 1'b1;
+                            best_age = age[i];
+                            found = 1'b1;
+                        end
+                    end
+                end
+                default: begin
+                    // search rr_ptr..N-1 first, then wrap to 0..rr_ptr-1
+                    for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+                        if (!found && slot_free[i] && i >= int'(rr_ptr)) begin
+                            grant[i] = 1'b1;
+                            found = 1'b1;
+                        end
+                    end
+                    for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+                        if (!found && slot_free[i]) begin
+                            grant[i] = 1'b1;
+                            found = 1'b1;
+                        end
+                    end
+                end
+            endcase
+        end
+    end
+
+    wire in_fire  = in_valid && in_ready;
+    wire out_fire = |grant;
 
-    // capture in_data to use it (avoid UNUSED warning)
     always_ff @(posedge clk) begin
         if (reset) begin
-            buffered_valid <= 0;
-            buffered_data <= 32'h0;
-            in_data_reg <= 32'h0;
+            main_valid <= 0;
+            skid_valid <= 0;
+            main_data  <= '0;
+            skid_data  <= '0;
+            slot_valid <= '0;
+            rr_ptr     <= '0;
+            for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+                slot_data[i] <= '0;
+                age[i]       <= '0;
+                credit[i]    <= CRED_W'(CREDITS);
+            end
         end else begin
-            in_data_reg <= in_data;
-            if (buffered_valid && consumer_ready) begin
-                buffered_valid <= 0;
+            if (out_fire || !main_valid) begin
+                // output register frees up: refill from skid first to keep order
+                if (skid_valid) begin
+                    main_data  <= skid_data;
+                    main_valid <= 1;
+                    skid_valid <= 0;
+                end else if (in_fire) begin
+                    main_data  <= in_data;
+                    main_valid <= 1;
+                end else begin
+                    main_valid <= 0;
+                end
+            end else if (in_fire) begin
+                // every follower stalled while a task was in flight: park it in the skid slot
+                skid_data  <= in_data;
+                skid_valid <= 1;
             end
 
-            if (in_valid && !buffered_valid) begin
-                buffered_data <= in_data_reg;
-                buffered_valid <= 1;
+            for (int i = 0; i < NUM_FOLLOWERS; i++) begin
+                if (grant[i]) begin
+                    slot_data[i]  <= main_data;
+                    slot_valid[i] <= 1'b1;
+                    age[i]        <= '0;
+                    rr_ptr        <= (i == NUM_FOLLOWERS - 1) ? '0 : SEL_W'(i + 1);
+                end else begin
+                    if (consumer_ready[i]) slot_valid[i] <= 1'b0;
+                    if (out_fire && age[i] != {AGE_W{1'b1}}) age[i] <= age[i] + 1;
+                end
+
+                if (CREDITS != 0) begin
+                    if (grant[i] && !credit_return[i]) begin
+                        credit[i] <= credit[i] - 1;
+                    end else if (!grant[i] && credit_return[i] && credit[i] != CRED_W'(CREDITS)) begin
+                        credit[i] <= credit[i] + 1;
+                    end
+                end
             end
         end
     end
 
+    // credit_return is only consumed in credit mode; reference it in a
+    // non-synthesizable block so Verilator does not flag it as unused otherwise.
+    wire credit_return_any = |credit_return;
+    // synthesis translate_off
+    initial begin
+        if (credit_return_any) begin end
+    end
+    // synthesis translate_on
+
 endmodule
@@ -1,9 +1,23 @@
 // hb_task_queue_core.sv
 // FIFO with synchronous reset (no "or posedge reset")
+//
+// Programmable watermarks: almost_full is (occupancy >= wm_high) and almost_empty
+// is (occupancy <= wm_low). Both registers load together on wm_we and reset to
+// DEPTH / 0, i.e. plain full / empty. doorbell pulses for one cycle when a
+// parked agent can make progress: bit 0 when almost_full falls (room for
+// producers), bit 1 when almost_empty falls (data for consumers).
+//
+// Timestamps (TIMESTAMPS=1): a free-running cycle counter is stamped into a
+// sideband memory at push. ts_out is the stamp of the head entry and residency
+// is how many cycles it has been queued, so sampling residency in the same cycle
+// as pop_req gives the popped task's queueing delay. With TIMESTAMPS=0 both
+// outputs are tied to zero and no sideband storage is built.
 
 module hb_task_queue_core #(
     parameter DEPTH = 16,
-    parameter WIDTH = 32
+    parameter WIDTH = 32,
+    parameter TIMESTAMPS = 0,
+    parameter TS_WIDTH = 32
 )(
     input  logic clk,
     input  logic reset,                 // synchronous reset
@@ -12,17 +26,38 @@ module hb_task_queue_core #(
     output logic full,
     output logic valid_out,
     output logic [WIDTH-1:0] data_out,
-    input  logic pop_req
+    input  logic pop_req,
+    output logic [$clog2(DEPTH+1)-1:0] occupancy,   // entries currently held
+
+    input  logic wm_we,
+    input  logic [$clog2(DEPTH+1)-1:0] wm_high_in,
+    input  logic [$clog2(DEPTH+1)-1:0] wm_low_in,
+    output logic almost_full,
+    output logic almost_empty,
+    output logic [1:0] doorbell,
+
+    output logic [TS_WIDTH-1:0] ts_out,
+    output logic [TS_WIDTH-1:0] residency
 );
 
     localparam PTR_W = $clog2(DEPTH);
+    localparam CNT_W = $clog2(DEPTH+1);
+    localparam [CNT_W-1:0] DEPTH_C = DEPTH;
     logic [WIDTH-1:0] mem [0:DEPTH-1];
     logic [PTR_W-1:0] head, tail;
     logic [$clog2(DEPTH+1)-1:0] count;
+    logic [CNT_W-1:0] wm_high, wm_low;
+    logic almost_full_q, almost_empty_q;
 
     assign full = (count == DEPTH);
     assign valid_out = (count != 0);
     assign data_out = mem[head];
+    assign occupancy = count;
+    assign almost_full = (count >= wm_high);
+    assign almost_empty = (count <= wm_low);
+
+    wire do_push = push_req && !full;
+    wire do_pop  = pop_req && (count != 0);
 
     // synchronous reset style: only posedge clk in sensitivity list
     always_ff @(posedge clk) begin
@@ -30,20 +65,61 @@ module hb_task_queue_core #(
             head <= '0;
             tail <= '0;
             count <= '0;
+            wm_high <= DEPTH_C;
+            wm_low <= '0;
+            almost_full_q <= 1'b0;
+            almost_empty_q <= 1'b1;
+            doorbell <= 2'b00;
         end else begin
             // push
-            if (push_req && !full) begin
+            if (do_push) begin
                 mem[tail] <= data_in;
                 tail <= tail + 1;
-                count <= count + 1;
             end
 
             // pop
-            if (pop_req && (count != 0)) begin
+            if (do_pop) begin
                 head <= head + 1;
+            end
+
+            // a push and a pop in the same cycle leave the count unchanged
+            if (do_push && !do_pop) begin
+                count <= count + 1;
+            end else if (do_pop && !do_push) begin
                 count <= count - 1;
             end
+
+            // watermarks
+            if (wm_we) begin
+                wm_high <= wm_high_in;
+                wm_low <= wm_low_in;
+            end
+            almost_full_q <= almost_full;
+            almost_empty_q <= almost_empty;
+            doorbell <= {almost_empty_q && !almost_empty, almost_full_q && !almost_full};
         end
     end
 
+    generate
+        if (TIMESTAMPS != 0) begin : g_ts
+            logic [TS_WIDTH-1:0] now;
+            logic [TS_WIDTH-1:0] ts_mem [0:DEPTH-1];
+
+            always_ff @(posedge clk) begin
+                if (reset) begin
+                    now <= '0;
+                end else begin
+                    now <= now + 1;
+                    if (do_push) ts_mem[tail] <= now;
+                end
+            end
+
+            assign ts_out = ts_mem[head];
+            assign residency = now - ts_mem[head];
+        end else begin : g_no_ts
+            assign ts_out = '0;
+            assign residency = '0;
+        end
+    endgenerate
+
 endmodule
@@ -0,0 +1,132 @@
+// hb_work_stealing.sv
+// NUM_GROUPS follower groups, each owning an hb_ws_deque. A group's producer
+// pushes into its own deque (push_req[g]); the group's follower asks for work
+// with take_req[g] and gets the newest task of its own deque. When its deque
+// is empty the group becomes a thief and steals the oldest task of a victim.
+//
+// Victim selection scans the other deques for one that can give up a task this
+// cycle, starting from a per-thief point chosen by STEAL_POLICY:
+//   0: round-robin (one past the last victim this thief robbed)
+//   1: random (bits of a free-running 16-bit LFSR)
+// A victim serves one thief per cycle; the lowest-numbered thief wins a
+// contested victim and the others retry next cycle.
+//
+// take_ok[g] reports that take_data slice g is a task handed over this cycle,
+// take_stolen[g] that it came from another group's deque.
+// NUM_GROUPS must be at least 2.
+
+module hb_work_stealing #(
+    parameter NUM_GROUPS = 4,
+    parameter DEPTH = 16,
+    parameter WIDTH = 32,
+    parameter STEAL_POLICY = 0
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic [NUM_GROUPS-1:0] push_req,
+    input  logic [NUM_GROUPS*WIDTH-1:0] push_data,
+    output logic [NUM_GROUPS-1:0] push_ok,
+    input  logic [NUM_GROUPS-1:0] take_req,
+    output logic [NUM_GROUPS-1:0] take_ok,
+    output logic [NUM_GROUPS-1:0] take_stolen,
+    output logic [NUM_GROUPS*WIDTH-1:0] take_data,
+    output logic [NUM_GROUPS*$clog2(DEPTH+1)-1:0] occupancy
+);
+
+    localparam SEL_W = (NUM_GROUPS > 1) ? $clog2(NUM_GROUPS) : 1;
+    localparam CNT_W = $clog2(DEPTH+1);
+
+    logic [NUM_GROUPS-1:0] d_valid, d_full, d_owner_ok, d_steal_ok;
+    logic [NUM_GROUPS-1:0] own_req, steal_req, stealable, steal_go;
+    logic [WIDTH-1:0] owner_data [0:NUM_GROUPS-1];
+    logic [WIDTH-1:0] steal_data [0:NUM_GROUPS-1];
+    logic [CNT_W-1:0] d_occ [0:NUM_GROUPS-1];
+    logic [SEL_W-1:0] victim [0:NUM_GROUPS-1];
+    logic [SEL_W-1:0] vptr [0:NUM_GROUPS-1];
+    logic [15:0] lfsr;
+
+    genvar g;
+    generate
+        for (g = 0; g < NUM_GROUPS; g++) begin : g_group
+            hb_ws_deque #(.DEPTH(DEPTH), .WIDTH(WIDTH)) deque (
+                .clk(clk),
+                .reset(reset),
+                .push_req(push_req[g]),
+                .data_in(push_data[g*WIDTH +: WIDTH]),
+                .push_ok(push_ok[g]),
+                .full(d_full[g]),
+                .owner_pop_req(own_req[g]),
+                .owner_ok(d_owner_ok[g]),
+                .owner_data(owner_data[g]),
+                .steal_req(steal_req[g]),
+                .steal_ok(d_steal_ok[g]),
+                .steal_data(steal_data[g]),
+                .valid_out(d_valid[g]),
+                .occupancy(d_occ[g])
+            );
+            assign occupancy[g*CNT_W +: CNT_W] = d_occ[g];
+        end
+    endgenerate
+
+    // the owner pops whenever it has work (stored, or arriving this cycle);
+    // a deque can also give up a task to a thief unless the owner takes its last one
+    always_comb begin
+        for (int i = 0; i < NUM_GROUPS; i++) begin
+            own_req[i] = take_req[i] && (d_valid[i] || push_req[i]);
+            stealable[i] = d_valid[i] && (!own_req[i] || push_req[i] || d_occ[i] > 1);
+        end
+    end
+
+    // thieves pick victims in index order so each victim serves at most one
+    always_comb begin
+        logic found;
+        int c;
+        steal_req = '0;
+        steal_go = '0;
+        for (int t = 0; t < NUM_GROUPS; t++) begin
+            victim[t] = '0;
+            found = 1'b0;
+            if (take_req[t] && !own_req[t]) begin
+                for (int k = 0; k < NUM_GROUPS; k++) begin
+                    c = ((STEAL_POLICY == 1) ? int'(32'(lfsr >> t) % NUM_GROUPS) : int'(vptr[t])) + k;
+                    if (c >= NUM_GROUPS) c = c - NUM_GROUPS;
+                    if (!found && c != t && stealable[c] && !steal_req[c]) begin
+                        found = 1'b1;
+                        victim[t] = SEL_W'(c);
+                        steal_req[c] = 1'b1;
+                        steal_go[t] = 1'b1;
+                    end
+                end
+            end
+        end
+    end
+
+    always_comb begin
+        for (int i = 0; i < NUM_GROUPS; i++) begin
+            take_ok[i] = own_req[i] ? d_owner_ok[i] : (steal_go[i] && d_steal_ok[victim[i]]);
+            take_stolen[i] = !own_req[i] && steal_go[i];
+            take_data[i*WIDTH +: WIDTH] = own_req[i] ? owner_data[i] : steal_data[victim[i]];
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            lfsr <= 16'hACE1;
+            for (int i = 0; i < NUM_GROUPS; i++) vptr[i] <= '0;
+        end else begin
+            lfsr <= {lfsr[14:0], lfsr[15] ^ lfsr[13] ^ lfsr[12] ^ lfsr[10]};
+            for (int i = 0; i < NUM_GROUPS; i++) begin
+                if (steal_go[i]) vptr[i] <= (int'(victim[i]) == NUM_GROUPS - 1) ? '0 : victim[i] + SEL_W'(1);
+            end
+        end
+    end
+
+    // full is implied by push_ok; reference it so Verilator does not flag it
+    wire full_any = |d_full;
+    // synthesis translate_off
+    initial begin
+        if (full_any) begin end
+    end
+    // synthesis translate_on
+
+endmodule
@@ -0,0 +1,76 @@
+// hb_ws_deque.sv
+// Work-stealing deque: the circular storage of hb_task_queue_core with a second
+// exit. The owner pushes and pops at the tail (newest first), a thief steals
+// from the head (oldest first). owner_data / steal_data show the entry each
+// exit would take; push_ok / owner_ok / steal_ok say whether the request is
+// accepted this cycle, and entries move on the clock edge.
+//
+// A push and an owner pop in the same cycle hand the pushed entry straight to
+// the owner (it is the newest), even when the deque is full. A steal and an
+// owner pop from storage may both proceed when at least two entries are held,
+// otherwise the owner wins.
+// DEPTH must be a power of two.
+
+module hb_ws_deque #(
+    parameter DEPTH = 16,
+    parameter WIDTH = 32
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic push_req,
+    input  logic [WIDTH-1:0] data_in,
+    output logic push_ok,
+    output logic full,
+    input  logic owner_pop_req,
+    output logic owner_ok,
+    output logic [WIDTH-1:0] owner_data,
+    input  logic steal_req,
+    output logic steal_ok,
+    output logic [WIDTH-1:0] steal_data,
+    output logic valid_out,
+    output logic [$clog2(DEPTH+1)-1:0] occupancy
+);
+
+    localparam PTR_W = $clog2(DEPTH);
+    localparam CNT_W = $clog2(DEPTH+1);
+    logic [WIDTH-1:0] mem [0:DEPTH-1];
+    logic [PTR_W-1:0] head, tail;
+    logic [CNT_W-1:0] count;
+
+    wire [PTR_W-1:0] last = tail - 1;
+
+    assign full       = (count == DEPTH);
+    assign valid_out  = (count != 0);
+    assign occupancy  = count;
+    assign owner_data = push_req ? data_in : mem[last];
+    assign steal_data = mem[head];
+
+    wire bypass   = push_req && owner_pop_req;
+    wire do_push  = push_req && !owner_pop_req && !full;
+    wire own_mem  = owner_pop_req && !push_req && valid_out;   // owner pop from storage
+    assign push_ok  = do_push || bypass;
+    assign owner_ok = own_mem || bypass;
+    assign steal_ok = steal_req && valid_out && (!own_mem || count > 1);
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            head  <= '0;
+            tail  <= '0;
+            count <= '0;
+        end else begin
+            if (do_push) begin
+                mem[tail] <= data_in;
+                tail <= tail + 1;
+            end else if (own_mem) begin
+                tail <= last;
+            end
+
+            if (steal_ok) begin
+                head <= head + 1;
+            end
+
+            count <= count + CNT_W'(do_push) - CNT_W'(own_mem) - CNT_W'(steal_ok);
+        end
+    end
+
+endmodule
@@ -1,22 +1,70 @@
 // verilator_main.cpp
-// Verilator host harness: writes outputs into ./outputs directory (sim.vcd, results.json, run.log, metrics.csv).
+// Verilator host harness: writes outputs into ./outputs directory (sim.vcd, results.json, run.log, metrics.csv,
+// residency_hist.csv).
+// Benchmarks are opt-in: pass "--bench <name>" (or "--bench all"); their results go to outputs/bench.json.
 #include "Vtb_task_queue.h"
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 
 #include <iostream>
 #include <deque>
+#include <string>
+#include <vector>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <algorithm>
+#include <random>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
 
+#include "follower_model.h"
+#include "benches/bench_util.h"
+
 using namespace std;
 
+// Must match the tb_task_queue parameters (the Makefile passes them via -G and -CFLAGS)
+#ifndef NUM_FOLLOWERS
+#define NUM_FOLLOWERS 4
+#endif
+#ifndef DISPATCH_POLICY
+#define DISPATCH_POLICY 0
+#endif
+#ifndef FOLLOWER_CREDITS
+#define FOLLOWER_CREDITS 0
+#endif
+#ifndef QUEUE_DEPTH
+#define QUEUE_DEPTH 16
+#endif
+#ifndef QUEUE_TIMESTAMPS
+#define QUEUE_TIMESTAMPS 1
+#endif
+#ifndef TASK_WIDTH
+#define TASK_WIDTH 32
+#endif
+#define TASK_WORDS (TASK_WIDTH / 32)
+#ifndef TIMER_SLOTS
+#define TIMER_SLOTS 64
+#endif
+#ifndef TIMER_BUCKET
+#define TIMER_BUCKET 4
+#endif
+#ifndef COMPLETION_DEPTH
+#define COMPLETION_DEPTH 16
+#endif
+#ifndef JOIN_SLOTS
+#define JOIN_SLOTS 16
+#endif
+
+// Completion word of a task that is a child of join slot `slot`: bit 31 marks
+// it, the slot sits in bits 30:24 and the task ID in bits 23:0.
+static inline uint32_t join_child(uint32_t id, unsigned slot) {
+    return 0x80000000u | (slot << 24) | (id & 0xFFFFFFu);
+}
+
 // Global pointers
 static Vtb_task_queue *top = nullptr;
 static VerilatedVcdC *tfp = nullptr;
@@ -35,6 +83,70 @@ struct Metrics {
     uint64_t sim_cycles = 0;
 } metrics;
 
+// Queue residency histogram (cycles between push and pop, from the timestamp
+// sideband). Bucket 0 holds residency 0, bucket k holds [2^(k-1), 2^k).
+struct ResidencyHist {
+    static constexpr int NBUCKETS = 33;
+    uint64_t buckets[NBUCKETS] = {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint32_t max = 0;
+
+    static int bucket_of(uint32_t v) {
+        int b = 0;
+        while (v) {
+            b++;
+            v >>= 1;
+        }
+        return b;
+    }
+    static uint64_t bucket_hi(int b) { return b == 0 ? 0 : ((1ull << b) - 1); }
+
+    void add(uint32_t v) {
+        buckets[bucket_of(v)]++;
+        count++;
+        sum += v;
+        if (v > max) max = v;
+    }
+    // upper bound of the bucket holding quantile q
+    uint64_t percentile(double q) const {
+        uint64_t target = (uint64_t)(q * count), seen = 0;
+        for (int b = 0; b < NBUCKETS; b++) {
+            seen += buckets[b];
+            if (seen > target) return min<uint64_t>(bucket_hi(b), max);
+        }
+        return max;
+    }
+    double mean() const { return count ? (double)sum / count : 0.0; }
+} residency_hist;
+
+static void write_residency_csv(const char *path, const ResidencyHist &h) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("fopen residency_hist.csv");
+        return;
+    }
+    fprintf(f, "bucket_lo,bucket_hi,count\n");
+    for (int b = 0; b < ResidencyHist::NBUCKETS; b++) {
+        if (!h.buckets[b]) continue;
+        uint64_t lo = b == 0 ? 0 : (1ull << (b - 1));
+        fprintf(f, "%llu,%llu,%llu\n", (unsigned long long)lo,
+                (unsigned long long)ResidencyHist::bucket_hi(b), (unsigned long long)h.buckets[b]);
+    }
+    fclose(f);
+}
+
+// true if "--bench <name>" or "--bench all" was given on the command line
+static bool bench_enabled(int argc, char **argv, const char *name) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], "--bench") == 0 &&
+            (strcmp(argv[i+1], name) == 0 || strcmp(argv[i+1], "all") == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Utility: ensure outputs directory exists (mode 0755)
 static void ensure_outputs_dir() {
     const char *dir = "outputs";
@@ -75,7 +187,11 @@ static void write_results_json(const char *path, const Metrics &m) {
     fprintf(f, "  \"successful_pops\": %llu,\n", (unsigned long long)m.successful_pops);
     fprintf(f, "  \"refused_pops\": %llu,\n", (unsigned long long)m.refused_pops);
     fprintf(f, "  \"mismatches\": %llu,\n", (unsigned long long)m.mismatches);
-    fprintf(f, "  \"sim_cycles\": %llu\n", (unsigned long long)m.sim_cycles);
+    fprintf(f, "  \"sim_cycles\": %llu,\n", (unsigned long long)m.sim_cycles);
+    fprintf(f, "  \"residency_mean\": %.3f,\n", residency_hist.mean());
+    fprintf(f, "  \"residency_p50\": %llu,\n", (unsigned long long)residency_hist.percentile(0.50));
+    fprintf(f, "  \"residency_p99\": %llu,\n", (unsigned long long)residency_hist.percentile(0.99));
+    fprintf(f, "  \"residency_max\": %u\n", residency_hist.max);
     fprintf(f, "}\n");
     fclose(f);
 }
@@ -100,6 +216,24 @@ static void write_metrics_csv(const char *path, const Metrics &m) {
     fclose(f);
 }
 
+
+// Drive a full TASK_WIDTH descriptor, or a 32-bit task zero-extended to one.
+static void set_task_words(const uint32_t *w) { bus_set(top->host_data_in, w, TASK_WORDS); }
+static void set_task(uint32_t v) {
+    uint32_t w[TASK_WORDS] = {v};
+    set_task_words(w);
+}
+
+// Test pattern for word i of descriptor seq: word 0 is the sequence number, the
+// rest are distinct per word so a swapped or dropped word is caught.
+static inline uint32_t desc_pattern(uint32_t seq, int i) {
+    return i == 0 ? seq : seq * 0x9E3779B1u + (uint32_t)i;
+}
+
+// Word i of the head entry, and of follower f's descriptor on the dispatch bus
+static uint32_t head_word(int i) { return bus_word(top->data_out, i); }
+static uint32_t dispatch_word(int f, int i = 0) { return bus_word(top->dispatch_data, f * TASK_WORDS + i); }
+
 // Clock tick: falling + rising, dump VCD at each half-step
 static void tick() {
     // falling edge
@@ -125,25 +259,34 @@ static void reset_cycles(int n) {
 static int host_try_push(uint32_t v) {
     metrics.attempted_pushes++;
     if (top->full) {
+        // still present the request for a cycle so the perf counters see the refusal
+        top->host_push_req = 1;
+        tick();
+        top->host_push_req = 0;
         metrics.refused_pushes++;
         return -1;
     }
     top->host_push_req = 1;
-    top->host_data_in = v;
+    set_task(v);
     tick();
     top->host_push_req = 0;
-    top->host_data_in = 0;
+    set_task(0);
     metrics.successful_pushes++;
     return 0;
 }
 
-static int host_try_pop(uint32_t *out) {
+// residency (optional) receives the popped entry's queueing delay in cycles
+static int host_try_pop(uint32_t *out, uint32_t *residency = nullptr) {
     metrics.attempted_pops++;
     if (!top->valid_out) {
+        top->host_pop_req = 1;
+        tick();
+        top->host_pop_req = 0;
         metrics.refused_pops++;
         return -1;
     }
-    uint32_t sampled = (uint32_t)(top->data_out & 0xFFFFFFFF);
+    uint32_t sampled = head_word(0);
+    if (residency) *residency = top->residency;
     top->host_pop_req = 1;
     tick();
     top->host_pop_req = 0;
@@ -152,6 +295,136 @@ static int host_try_pop(uint32_t *out) {
     return 0;
 }
 
+// Delayed push: hand v to the timer wheel for release at cycle release_at
+// (timer_now time base). Acceptance is decided combinationally in the cycle.
+static int host_try_push_at(uint32_t v, uint32_t release_at) {
+    set_task(v);
+    top->host_release = release_at;
+    top->host_push_at = 1;
+    top->host_push_req = 1;
+    top->eval();
+    bool ok = top->timer_push_ok;
+    tick();
+    top->host_push_req = 0;
+    top->host_push_at = 0;
+    set_task(0);
+    return ok ? 0 : -1;
+}
+
+// Timer wheel workload: every cycle the host offers a delayed push with
+// probability push_pct (release drawn from [now - 2, now + TIMER_SLOTS - 1], so
+// some are already due) and pops the head whenever one is there. Tasks carry
+// sequence numbers so every pop can be matched to its release cycle.
+struct TimerRun {
+    uint64_t offered = 0, accepted = 0, refused = 0, released = 0;
+    uint64_t early = 0, lost = 0, late_sum = 0, late_max = 0;
+    vector<uint32_t> lateness;   // pop cycle - max(release, push cycle) per task
+};
+
+static TimerRun run_timer_workload(FILE *logf, int ncycles, int push_pct, unsigned seed) {
+    TimerRun r;
+    vector<uint32_t> due_at(1, 0);   // indexed by task sequence number
+    mt19937 rng(seed);
+    uniform_int_distribution<int> ahead(-2, TIMER_SLOTS - 1);
+    uint32_t next_seq = 1;
+
+    top->host_mode = 1;
+    top->dispatch_mode = 0;
+    reset_cycles(4);
+
+    auto pop_if_valid = [&]() {
+        if (!top->valid_out) return;
+        uint32_t seq = head_word(0);
+        uint32_t now = top->timer_now;
+        if (seq == 0 || seq >= next_seq) {
+            fprintf(logf, "MISMATCH: timer popped unknown task 0x%08x\n", seq);
+            r.early++;
+        } else if ((int32_t)(now - due_at[seq]) <= 0) {
+            // a task enters the queue on the edge that ends its release cycle
+            fprintf(logf, "MISMATCH: task %u released early: due %u popped at %u\n", seq, due_at[seq], now);
+            r.early++;
+        } else {
+            uint32_t late = now - due_at[seq] - 1;
+            r.lateness.push_back(late);
+            r.late_sum += late;
+            if (late > r.late_max) r.late_max = late;
+        }
+        r.released++;
+        top->host_pop_req = 1;
+    };
+
+    for (int c = 0; c < ncycles; c++) {
+        pop_if_valid();
+        if ((int)(rng() % 100) < push_pct) {
+            uint32_t now = top->timer_now;
+            int32_t off = ahead(rng);
+            uint32_t rel = now + (uint32_t)off;
+            set_task(next_seq);
+            top->host_release = rel;
+            top->host_push_at = 1;
+            top->host_push_req = 1;
+            top->eval();
+            r.offered++;
+            if (top->timer_push_ok) {
+                due_at.push_back(off < 0 ? now : rel);
+                next_seq++;
+                r.accepted++;
+            } else {
+                r.refused++;
+            }
+        }
+        tick();
+        top->host_push_req = 0;
+        top->host_push_at = 0;
+        top->host_pop_req = 0;
+        set_task(0);
+    }
+
+    // drain: everything accepted must come out within the wheel horizon
+    for (int c = 0; c < 4 * TIMER_SLOTS + QUEUE_DEPTH && (top->timer_pending || top->valid_out); c++) {
+        pop_if_valid();
+        tick();
+        top->host_pop_req = 0;
+    }
+    r.lost = r.accepted - r.released;
+    if (r.lost) fprintf(logf, "MISMATCH: %llu delayed tasks never released\n", (unsigned long long)r.lost);
+    sort(r.lateness.begin(), r.lateness.end());
+    return r;
+}
+
+// Timer wheel test: no task may leave before its release cycle and none may be lost.
+static uint64_t run_timer_test(FILE *logf) {
+    fprintf(logf, "[HOST] Running timer wheel test slots=%d bucket=%d...\n", TIMER_SLOTS, TIMER_BUCKET);
+    fflush(logf);
+    uint64_t errors = 0;
+
+    // a single task: refused past the horizon, released exactly on time otherwise
+    top->host_mode = 1;
+    reset_cycles(4);
+    uint32_t now = top->timer_now;
+    if (host_try_push_at(0x7, now + TIMER_SLOTS + 8) == 0) {
+        fprintf(logf, "MISMATCH: timer accepted a release beyond the horizon\n");
+        errors++;
+    }
+    now = top->timer_now;
+    uint32_t rel = now + 10;
+    host_try_push_at(0x5A, rel);
+    while (!top->valid_out && top->timer_now != rel + 8) tick();
+    if (!top->valid_out || head_word(0) != 0x5A || top->timer_now != rel + 1) {
+        fprintf(logf, "MISMATCH: timer task due %u visible at %u\n", rel, (unsigned)top->timer_now);
+        errors++;
+    }
+    uint32_t out;
+    host_try_pop(&out);
+
+    TimerRun r = run_timer_workload(logf, 4000, 60, 11);
+    errors += r.early + r.lost;
+    fprintf(logf, "[HOST] timer wheel test done. accepted=%llu refused=%llu late_max=%llu errors: %llu\n",
+            (unsigned long long)r.accepted, (unsigned long long)r.refused,
+            (unsigned long long)r.late_max, (unsigned long long)errors);
+    return errors;
+}
+
 // Deterministic test
 static uint64_t run_deterministic_test(FILE *logf) {
     fprintf(logf, "[HOST] Running deterministic test...\n");
@@ -212,28 +485,143 @@ static uint64_t run_deterministic_test(FILE *logf) {
     return metrics.mismatches;
 }
 
+// Watermark test: program wm_high/wm_low, then check the almost_full /
+// almost_empty flags and that each falling edge rings the matching doorbell.
+static uint64_t run_watermark_test(FILE *logf) {
+    fprintf(logf, "[HOST] Running watermark test...\n");
+    fflush(logf);
+    uint64_t errors = 0;
+    uint32_t rang = 0;
+    const uint32_t hi = QUEUE_DEPTH - 4, lo = 4;
+    auto expect = [&](bool cond, const char *what) {
+        if (!cond) {
+            fprintf(logf, "MISMATCH: watermark %s\n", what);
+            errors++;
+        }
+    };
+    // the doorbell is registered: collect it over the op's edge and one idle cycle
+    auto settle = [&]() {
+        rang |= top->doorbell;
+        tick();
+        rang |= top->doorbell;
+    };
+
+    top->host_mode = 1;
+    reset_cycles(4);
+    top->wm_high = hi;
+    top->wm_low = lo;
+    top->wm_we = 1;
+    tick();
+    top->wm_we = 0;
+
+    uint32_t out;
+    expect(top->almost_empty && !top->almost_full, "flags after reset");
+    for (uint32_t i = 0; i < hi; i++) {
+        host_try_push(i);
+        settle();
+        if (i == lo) expect(rang & 0x2, "data doorbell when rising above wm_low");
+    }
+    expect(top->almost_full && !top->almost_empty, "almost_full at wm_high");
+    rang = 0;
+    host_try_pop(&out);
+    settle();
+    expect(!top->almost_full, "almost_full clears below wm_high");
+    expect(rang & 0x1, "room doorbell when falling below wm_high");
+    while (top->valid_out) host_try_pop(&out);
+    settle();
+    expect(top->almost_empty, "almost_empty when drained");
+
+    // restore plain full/empty watermarks for the following tests
+    top->wm_high = QUEUE_DEPTH;
+    top->wm_low = 0;
+    top->wm_we = 1;
+    tick();
+    top->wm_we = 0;
+
+    fprintf(logf, "[HOST] watermark test done. errors: %llu\n", (unsigned long long)errors);
+    return errors;
+}
+
+// Descriptor test: fill the queue with full-width descriptors, then pop them
+// and check every 32-bit word.
+static uint64_t run_descriptor_test(FILE *logf) {
+    fprintf(logf, "[HOST] Running descriptor test width=%d...\n", TASK_WIDTH);
+    fflush(logf);
+    uint64_t errors = 0;
+    top->host_mode = 1;
+    reset_cycles(4);
+
+    uint32_t pushed = 0;
+    while (!top->full) {
+        uint32_t w[TASK_WORDS];
+        for (int i = 0; i < TASK_WORDS; i++) w[i] = desc_pattern(pushed + 1, i);
+        set_task_words(w);
+        top->host_push_req = 1;
+        tick();
+        top->host_push_req = 0;
+        pushed++;
+    }
+    set_task(0);
+
+    for (uint32_t n = 1; n <= pushed; n++) {
+        for (int i = 0; i < TASK_WORDS; i++) {
+            if (head_word(i) != desc_pattern(n, i)) {
+                fprintf(logf, "MISMATCH: descriptor %u word %d expected 0x%08x got 0x%08x\n",
+                        n, i, desc_pattern(n, i), head_word(i));
+                errors++;
+            }
+        }
+        top->host_pop_req = 1;
+        tick();
+        top->host_pop_req = 0;
+    }
+    if (top->valid_out) {
+        fprintf(logf, "MISMATCH: queue not empty after descriptor test\n");
+        errors++;
+    }
+
+    fprintf(logf, "[HOST] descriptor test done. descriptors: %u errors: %llu\n", pushed, (unsigned long long)errors);
+    return errors;
+}
+
 // Randomized test
 static uint64_t run_randomized_test(FILE *logf, unsigned seed, int ops=10000) {
     fprintf(logf, "[HOST] Running randomized test seed=%u ops=%d\n", seed, ops);
     fflush(logf);
     deque<uint32_t> sw;
+    deque<uint64_t> sw_pushed_at;   // cycle of each queued entry's push edge
     metrics = Metrics();
+    residency_hist = ResidencyHist();
     top->host_mode = 1;
     top->tb_done = 0;
     reset_cycles(4);
 
+    // the residency sampled with a pop must equal the cycles between push and pop
+    auto check_residency = [&](uint64_t pop_cycle, uint32_t res) {
+        uint64_t expected = pop_cycle - sw_pushed_at.front();
+        sw_pushed_at.pop_front();
+        residency_hist.add(res);
+        if (QUEUE_TIMESTAMPS && res != expected) {
+            fprintf(logf, "MISMATCH: residency expected %llu got %u\n", (unsigned long long)expected, res);
+            metrics.mismatches++;
+        }
+    };
+
     srand(seed);
     for (int i=0;i<ops;i++) {
         int op = rand() % 3;
         if (op == 0) {
             uint32_t v = (uint32_t)rand();
+            uint64_t at = cycles;
             int rc = host_try_push(v);
             if (rc == 0) {
                 sw.push_back(v);
+                sw_pushed_at.push_back(at);
             }
         } else if (op == 1) {
-            uint32_t out;
-            int rc = host_try_pop(&out);
+            uint32_t out, res;
+            uint64_t at = cycles;
+            int rc = host_try_pop(&out, &res);
             if (rc == 0) {
                 if (sw.empty()) {
                     fprintf(logf, "MISMATCH: popped but SW empty -> 0x%08x\n", out);
@@ -245,6 +633,7 @@ static uint64_t run_randomized_test(FILE *logf, unsigned seed, int ops=10000) {
                         fprintf(logf, "MISMATCH: expected 0x%08x got 0x%08x\n", expected, out);
                         metrics.mismatches++;
                     }
+                    check_residency(at, res);
                 }
             } else {
                 if (!sw.empty()) {
@@ -259,8 +648,9 @@ static uint64_t run_randomized_test(FILE *logf, unsigned seed, int ops=10000) {
 
     // drain
     while (!sw.empty()) {
-        uint32_t out;
-        int rc = host_try_pop(&out);
+        uint32_t out, res;
+        uint64_t at = cycles;
+        int rc = host_try_pop(&out, &res);
         if (rc == 0) {
             uint32_t expected = sw.front();
             sw.pop_front();
@@ -268,6 +658,7 @@ static uint64_t run_randomized_test(FILE *logf, unsigned seed, int ops=10000) {
                 fprintf(logf, "MISMATCH: expected 0x%08x got 0x%08x\n", expected, out);
                 metrics.mismatches++;
             }
+            check_residency(at, res);
         } else {
             fprintf(logf, "MISMATCH: expected to pop remaining but hardware refused\n");
             metrics.mismatches++;
@@ -275,11 +666,718 @@ static uint64_t run_randomized_test(FILE *logf, unsigned seed, int ops=10000) {
         }
     }
 
+    // the hardware counters must agree with the host's own accounting
+    auto check_perf = [&](const char *what, uint64_t hw, uint64_t host) {
+        if (hw != host) {
+            fprintf(logf, "MISMATCH: perf %s hw=%llu host=%llu\n", what,
+                    (unsigned long long)hw, (unsigned long long)host);
+            metrics.mismatches++;
+        }
+    };
+    check_perf("pushes", top->perf_pushes, metrics.successful_pushes);
+    check_perf("pops", top->perf_pops, metrics.successful_pops);
+    check_perf("push_refused", top->perf_push_refused, metrics.refused_pushes);
+    check_perf("pop_refused", top->perf_pop_refused, metrics.refused_pops);
+    fprintf(logf, "[HOST] perf: cycles=%llu full_cycles=%u empty_cycles=%u mean_depth=%.2f max_depth=%u\n",
+            (unsigned long long)top->perf_cycles, (unsigned)top->perf_full_cycles,
+            (unsigned)top->perf_empty_cycles,
+            top->perf_cycles ? (double)top->perf_occ_sum / top->perf_cycles : 0.0,
+            (unsigned)top->perf_max_occ);
+    fprintf(logf, "[HOST] residency: mean=%.2f p50<=%llu p99<=%llu max=%u cycles\n",
+            residency_hist.mean(), (unsigned long long)residency_hist.percentile(0.50),
+            (unsigned long long)residency_hist.percentile(0.99), residency_hist.max);
+
     top->tb_done = 1;
     fprintf(logf, "[HOST] randomized test done. cycles simulated: %llu\n", (unsigned long long)cycles);
     return metrics.mismatches;
 }
 
+// Dispatch benchmark: the host pushes whenever the queue has room and every
+// follower port is ready with probability ready_pct. With ready_pct=100 the
+// skid-buffered distributor should sustain one task per cycle after warm-up.
+// Tasks are sequence numbers, so each follower must see increasing values and
+// every task must be delivered exactly once.
+static void run_dispatch_bench(FILE *logf, const char *name, int ncycles, int ready_pct) {
+    fprintf(logf, "[HOST] Running dispatch benchmark %s cycles=%d ready=%d%%\n", name, ncycles, ready_pct);
+    fflush(logf);
+    vector<uint32_t> last_seen(NUM_FOLLOWERS, 0);
+    uint32_t next_val = 1;
+    uint64_t dispatched = 0, pushed = 0, stall_cycles = 0, mism = 0;
+    const int warmup = 16;
+    // one entry per pushed value: delivered to a follower yet?
+    vector<uint8_t> delivered(warmup + ncycles + 1, 0);
+    vector<uint32_t> held(NUM_FOLLOWERS, 0);   // credit mode: tasks not yet credited back
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    top->follower_ready = 0;
+    reset_cycles(4);
+    srand(1);
+
+    for (int c = 0; c < warmup + ncycles; c++) {
+        bool measure = (c >= warmup);
+        uint32_t ready = 0;
+        for (int f = 0; f < NUM_FOLLOWERS; f++) {
+            if ((rand() % 100) < ready_pct) ready |= 1u << f;
+        }
+        top->follower_ready = ready;
+
+        // sample the follower ports before the edge that completes the transfers
+        uint32_t valid = top->dispatch_valid;
+        for (int f = 0; f < NUM_FOLLOWERS; f++) {
+            if (!(valid & (1u << f))) continue;
+            if (!(ready & (1u << f))) {
+                if (measure) stall_cycles++;
+                continue;
+            }
+            uint32_t got = dispatch_word(f);
+            if (got <= last_seen[f] || got >= next_val) {
+                fprintf(logf, "MISMATCH: follower %d got 0x%08x after 0x%08x\n", f, got, last_seen[f]);
+                mism++;
+            }
+            last_seen[f] = got;
+            if (got < next_val) {
+                if (delivered[got]) {
+                    fprintf(logf, "MISMATCH: 0x%08x delivered twice (again to follower %d)\n", got, f);
+                    mism++;
+                }
+                delivered[got] = 1;
+            }
+            if (FOLLOWER_CREDITS > 0) held[f]++;
+            if (measure) dispatched++;
+        }
+
+        if (!top->full) {
+            top->host_push_req = 1;
+            set_task(next_val++);
+            if (measure) pushed++;
+        }
+        tick();
+        top->host_push_req = 0;
+        set_task(0);
+    }
+
+    // drain the queue and the skid buffers with every follower ready, then
+    // check that each pushed value reached exactly one follower. In credit
+    // mode every follower hands back one credit per cycle for what it holds.
+    top->follower_ready = (1u << NUM_FOLLOWERS) - 1;
+    for (int c = 0; c < 4 * QUEUE_DEPTH + 64; c++) {
+        uint32_t valid = top->dispatch_valid, credit_return = 0;
+        for (int f = 0; f < NUM_FOLLOWERS; f++) {
+            if (held[f] > 0) {
+                held[f]--;
+                credit_return |= 1u << f;
+            }
+            if (!(valid & (1u << f))) continue;
+            if (FOLLOWER_CREDITS > 0) held[f]++;
+            uint32_t got = dispatch_word(f);
+            if (got == 0 || got >= next_val || delivered[got]) {
+                fprintf(logf, "MISMATCH: follower %d got 0x%08x while draining\n", f, got);
+                mism++;
+                continue;
+            }
+            delivered[got] = 1;
+        }
+        top->credit_return = credit_return;
+        tick();
+        top->credit_return = 0;
+    }
+    uint64_t lost = 0;
+    for (uint32_t v = 1; v < next_val; v++) {
+        if (!delivered[v]) lost++;
+    }
+    if (lost) fprintf(logf, "MISMATCH: %llu pushed tasks never reached a follower\n", (unsigned long long)lost);
+    mism += lost;
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+
+    double tpc = ncycles ? (double)dispatched / ncycles : 0.0;
+    fprintf(logf, "[HOST] %s: dispatched=%llu pushed=%llu tasks/cycle=%.3f backpressure_cycles=%llu mismatches=%llu\n",
+            name, (unsigned long long)dispatched, (unsigned long long)pushed, tpc,
+            (unsigned long long)stall_cycles, (unsigned long long)mism);
+    cout << "[HOST] " << name << ": tasks/cycle=" << tpc << " mismatches=" << mism << endl;
+    bench_record(name, "cycles", ncycles);
+    bench_record(name, "num_followers", NUM_FOLLOWERS);
+    bench_record(name, "ready_pct", ready_pct);
+    bench_record(name, "dispatched", (double)dispatched);
+    bench_record(name, "tasks_per_cycle", tpc);
+    bench_record(name, "backpressure_cycles", (double)stall_cycles);
+    bench_record(name, "mismatches", (double)mism);
+    metrics.mismatches += mism;
+}
+
+// Descriptor throughput benchmark: like the dispatch benchmark with every
+// follower ready, but each task is a full TASK_WIDTH descriptor and every word
+// delivered to a follower is checked. Run once per width (make bench-width) to
+// compare descriptors and bytes per cycle across 32/64/128/256-bit builds.
+static void run_desc_bench(FILE *logf, const char *name, int ncycles) {
+    fprintf(logf, "[HOST] Running descriptor benchmark %s width=%d cycles=%d\n", name, TASK_WIDTH, ncycles);
+    fflush(logf);
+    uint32_t next_seq = 1;
+    uint64_t delivered = 0, mism = 0;
+    const int warmup = 16;
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    top->follower_ready = (1u << NUM_FOLLOWERS) - 1;
+    reset_cycles(4);
+
+    for (int c = 0; c < warmup + ncycles; c++) {
+        uint32_t valid = top->dispatch_valid;
+        for (int f = 0; f < NUM_FOLLOWERS; f++) {
+            if (!(valid & (1u << f))) continue;
+            uint32_t seq = dispatch_word(f, 0);
+            for (int i = 1; i < TASK_WORDS; i++) {
+                if (dispatch_word(f, i) != desc_pattern(seq, i)) {
+                    fprintf(logf, "MISMATCH: follower %d descriptor %u word %d got 0x%08x\n",
+                            f, seq, i, dispatch_word(f, i));
+                    mism++;
+                }
+            }
+            if (c >= warmup) delivered++;
+        }
+
+        if (!top->full) {
+            uint32_t w[TASK_WORDS];
+            for (int i = 0; i < TASK_WORDS; i++) w[i] = desc_pattern(next_seq, i);
+            set_task_words(w);
+            top->host_push_req = 1;
+            next_seq++;
+        }
+        tick();
+        top->host_push_req = 0;
+        set_task(0);
+    }
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+
+    double dpc = ncycles ? (double)delivered / ncycles : 0.0;
+    fprintf(logf, "[HOST] %s: width=%d descriptors/cycle=%.3f bytes/cycle=%.1f mismatches=%llu\n",
+            name, TASK_WIDTH, dpc, dpc * TASK_WIDTH / 8, (unsigned long long)mism);
+    cout << "[HOST] " << name << ": width=" << TASK_WIDTH << " descriptors/cycle=" << dpc
+         << " bytes/cycle=" << dpc * TASK_WIDTH / 8 << " mismatches=" << mism << endl;
+    bench_record(name, "task_width", TASK_WIDTH);
+    bench_record(name, "cycles", ncycles);
+    bench_record(name, "descriptors", (double)delivered);
+    bench_record(name, "descriptors_per_cycle", dpc);
+    bench_record(name, "bytes_per_cycle", dpc * TASK_WIDTH / 8);
+    bench_record(name, "mismatches", (double)mism);
+    metrics.mismatches += mism;
+}
+
+// Drive the follower side for one cycle and advance the engines.
+// Ready mode: an idle engine raises follower_ready and takes the task on its port.
+// Credit mode (FOLLOWER_CREDITS > 0): ports are always ready, tasks land in the
+// engine's inbox, and the engine pulses credit_return when it starts the next one.
+// With post set, finished tasks also queue in the follower's outbox for
+// post_completions(). Returns the number of tasks that finished this cycle.
+template <typename StartFn, typename FinishFn>
+static int follower_cycle(vector<FollowerModel> &followers, ServiceSampler &sampler,
+                          StartFn on_start, FinishFn on_finish, bool post = false) {
+    uint32_t ready = 0, credit_return = 0;
+    int finished = 0;
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        if (FOLLOWER_CREDITS > 0 || followers[f].ready()) ready |= 1u << f;
+    }
+    top->follower_ready = ready;
+
+    uint32_t accepted = ready & top->dispatch_valid;
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        FollowerModel &fm = followers[f];
+        if (fm.step()) {
+            on_finish(fm.task);
+            if (post) fm.outbox.push_back(fm.task);
+            finished++;
+        }
+        if (!(accepted & (1u << f))) {
+            // nothing new on this port
+        } else if (FOLLOWER_CREDITS > 0) {
+            fm.inbox.push_back(dispatch_word(f));
+        } else {
+            fm.accept(dispatch_word(f), sampler.sample());
+            on_start(fm.task);
+        }
+        if (FOLLOWER_CREDITS > 0 && fm.ready() && !fm.inbox.empty()) {
+            fm.accept(fm.inbox.front(), sampler.sample());
+            fm.inbox.pop_front();
+            credit_return |= 1u << f;
+            on_start(fm.task);
+        }
+    }
+    top->credit_return = credit_return;
+    return finished;
+}
+
+// Offer each follower's oldest unposted completion to the completion queue;
+// on_post(task, follower) runs for the one accepted this cycle.
+template <typename PostFn>
+static void post_completions(vector<FollowerModel> &followers, PostFn on_post) {
+    uint32_t valid = 0, data[NUM_FOLLOWERS];
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        data[f] = followers[f].outbox.empty() ? 0 : followers[f].outbox.front();
+        if (!followers[f].outbox.empty()) valid |= 1u << f;
+    }
+    top->cpl_valid = valid;
+    bus_set(top->cpl_data, data, NUM_FOLLOWERS);
+    top->eval();   // cpl_ready is combinational on cpl_valid
+    uint32_t ready = top->cpl_ready;
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        if (!(ready & (1u << f))) continue;
+        on_post(followers[f].outbox.front(), f);
+        followers[f].outbox.pop_front();
+    }
+}
+
+// Completion test: followers execute dispatched tasks and post their IDs back
+// through the completion queue, which the host drains every cycle. Every task
+// must complete exactly once, tagged with the follower that ran it, even while
+// the completion queue is allowed to fill up.
+static uint64_t run_completion_test(FILE *logf) {
+    fprintf(logf, "[HOST] Running completion queue test depth=%d...\n", COMPLETION_DEPTH);
+    fflush(logf);
+    const uint32_t ntasks = 400;
+    uint64_t errors = 0;
+    vector<FollowerModel> followers(NUM_FOLLOWERS);
+    ServiceConfig svc;
+    svc.dist = SERVICE_UNIFORM;
+    svc.min = 1;
+    svc.max = 6;
+    ServiceSampler sampler(svc, 9);
+    vector<int> posted_by(ntasks + 1, -1);
+    vector<bool> completed(ntasks + 1, false);
+    uint32_t next_val = 1, ncompleted = 0;
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    reset_cycles(4);
+
+    for (uint64_t c = 0; ncompleted < ntasks && c < 100ull * ntasks; c++) {
+        // drain in bursts so the queue fills and posts are held back
+        bool drain = (c / 64) % 2 == 1;
+        if (drain && top->cq_valid) {
+            uint32_t tid = top->cq_data;
+            int f = (int)top->cq_follower;
+            if (tid == 0 || tid > ntasks || completed[tid] || posted_by[tid] != f) {
+                fprintf(logf, "MISMATCH: completion of task %u from follower %d\n", tid, f);
+                errors++;
+            } else {
+                completed[tid] = true;
+                ncompleted++;
+            }
+            top->cq_pop = 1;
+        }
+        follower_cycle(followers, sampler, [](uint32_t) {}, [](uint32_t) {}, true);
+        post_completions(followers, [&](uint32_t tid, int f) {
+            if (tid >= 1 && tid <= ntasks) posted_by[tid] = f;
+        });
+        if (!top->full && next_val <= ntasks) {
+            top->host_push_req = 1;
+            set_task(next_val++);
+        }
+        tick();
+        top->host_push_req = 0;
+        top->cq_pop = 0;
+        set_task(0);
+    }
+    if (ncompleted != ntasks) {
+        fprintf(logf, "MISMATCH: %u of %u tasks completed\n", ncompleted, ntasks);
+        errors++;
+    }
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+    top->cpl_valid = 0;
+    fprintf(logf, "[HOST] completion queue test done. completed: %u errors: %llu\n", ncompleted, (unsigned long long)errors);
+    return errors;
+}
+
+// Register `continuation` in join slot `slot`, released after `count` child completions.
+static bool host_try_join(unsigned slot, uint32_t count, uint32_t continuation) {
+    set_task(continuation);
+    top->host_join_slot = slot;
+    top->host_join_count = count;
+    top->host_join_reg = 1;
+    top->eval();
+    bool ok = top->join_reg_ok;
+    tick();
+    top->host_join_reg = 0;
+    set_task(0);
+    return ok;
+}
+
+// Join test: a continuation waits for its children, whose completions go to
+// the join table instead of the completion queue; the continuation is then
+// dispatched and completes like any other task. A second registration of an
+// occupied slot must be refused.
+static uint64_t run_join_test(FILE *logf) {
+    fprintf(logf, "[HOST] Running join counter test slots=%d...\n", JOIN_SLOTS);
+    fflush(logf);
+    const unsigned slot = JOIN_SLOTS - 1, nchildren = 5;
+    const uint32_t cont = 0x77;
+    uint64_t errors = 0;
+    vector<FollowerModel> followers(NUM_FOLLOWERS);
+    ServiceConfig svc;
+    svc.mean = 3;
+    ServiceSampler sampler(svc, 1);
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    reset_cycles(4);
+    if (!host_try_join(slot, nchildren, cont)) {
+        fprintf(logf, "MISMATCH: join registration refused\n");
+        errors++;
+    }
+    if (host_try_join(slot, 1, 0x99)) {
+        fprintf(logf, "MISMATCH: join registration of an occupied slot accepted\n");
+        errors++;
+    }
+
+    uint32_t next_child = 1;
+    bool cont_done = false;
+    for (int c = 0; c < 400 && !cont_done; c++) {
+        if (top->cq_valid) {
+            uint32_t got = top->cq_data;
+            if (got != cont || next_child <= nchildren) {
+                fprintf(logf, "MISMATCH: completion 0x%08x before the join released\n", got);
+                errors++;
+            }
+            cont_done = (got == cont);
+            top->cq_pop = 1;
+        }
+        follower_cycle(followers, sampler, [](uint32_t) {}, [](uint32_t) {}, true);
+        post_completions(followers, [](uint32_t, int) {});
+        if (next_child <= nchildren && !top->full) {
+            top->host_push_req = 1;
+            set_task(join_child(next_child++, slot));
+        }
+        tick();
+        top->host_push_req = 0;
+        top->cq_pop = 0;
+        set_task(0);
+    }
+    if (!cont_done || top->join_active != 0) {
+        fprintf(logf, "MISMATCH: continuation %s, %u join slots still active\n",
+                cont_done ? "completed" : "never completed", (unsigned)top->join_active);
+        errors++;
+    }
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+    top->cpl_valid = 0;
+    fprintf(logf, "[HOST] join counter test done. errors: %llu\n", (unsigned long long)errors);
+    return errors;
+}
+
+// DAG benchmark: ntrees parallel reductions, one after another, each a binary
+// tree with `leaves` leaf tasks whose internal nodes run once both children
+// are done. Node n of tree t (heap order, root 1) has task ID t * 4096 + n.
+// In software mode the leader pops every completion, counts children per node
+// and pushes each ready parent itself. In join mode it registers every internal
+// node as a continuation (slot n - 1) before pushing the leaves, and only sees
+// the root complete. Leader work counts its port operations (pushes,
+// registrations, completion pops) and the cycles in which it issued any.
+static void run_dag_bench(FILE *logf, const char *name, bool hw_join, unsigned leaves, unsigned ntrees, uint32_t svc_cycles) {
+    fprintf(logf, "[HOST] Running DAG benchmark %s leaves=%u trees=%u service=%u\n", name, leaves, ntrees, svc_cycles);
+    fflush(logf);
+    if (hw_join && leaves - 1 > JOIN_SLOTS) {
+        fprintf(logf, "[HOST] %s skipped: %u internal nodes exceed JOIN_SLOTS=%d\n", name, leaves - 1, JOIN_SLOTS);
+        return;
+    }
+    vector<FollowerModel> followers(NUM_FOLLOWERS);
+    ServiceConfig svc;
+    svc.mean = svc_cycles;
+    ServiceSampler sampler(svc, 1);
+    uint64_t leader_ops = 0, leader_busy = 0, cycles_total = 0, mism = 0;
+    const uint64_t max_cycles = 1000ull * leaves * (svc_cycles + 4);
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    reset_cycles(4);
+
+    for (unsigned t = 0; t < ntrees; t++) {
+        auto word = [&](unsigned n) {
+            uint32_t id = t * 4096 + n;
+            return (hw_join && n != 1) ? join_child(id, n / 2 - 1) : id;
+        };
+        // leader work list of (register?, node); join mode registers the parents first
+        deque<pair<bool, unsigned>> todo;
+        if (hw_join) {
+            for (unsigned n = leaves - 1; n >= 1; n--) todo.push_back({true, n});
+        }
+        for (unsigned n = leaves; n < 2 * leaves; n++) todo.push_back({false, n});
+        vector<uint8_t> kids(leaves, 0);
+        bool root_done = false;
+
+        uint64_t c = 0;
+        for (; !root_done && c < max_cycles; c++) {
+            bool busy = false;
+            if (top->cq_valid) {
+                uint32_t id = top->cq_data;
+                unsigned n = id - t * 4096;
+                top->cq_pop = 1;
+                busy = true;
+                leader_ops++;
+                if (id < t * 4096 || n == 0 || n >= 2 * leaves) {
+                    fprintf(logf, "MISMATCH: %s: unexpected completion 0x%08x\n", name, id);
+                    mism++;
+                } else if (n == 1) {
+                    root_done = true;
+                } else if (hw_join) {
+                    fprintf(logf, "MISMATCH: %s: child %u reached the completion queue\n", name, n);
+                    mism++;
+                } else if (++kids[n / 2] == 2) {
+                    todo.push_back({false, n / 2});
+                }
+            }
+            follower_cycle(followers, sampler, [](uint32_t) {}, [](uint32_t) {}, true);
+            post_completions(followers, [](uint32_t, int) {});
+
+            if (!todo.empty()) {
+                auto op = todo.front();
+                if (op.first) {
+                    set_task(word(op.second));
+                    top->host_join_slot = op.second - 1;
+                    top->host_join_count = 2;
+                    top->host_join_reg = 1;
+                    top->eval();
+                    if (top->join_reg_ok) todo.pop_front();
+                    busy = true;
+                    leader_ops++;
+                } else if (!top->full) {
+                    set_task(word(op.second));
+                    top->host_push_req = 1;
+                    todo.pop_front();
+                    busy = true;
+                    leader_ops++;
+                }
+            }
+            if (busy) leader_busy++;
+            tick();
+            top->host_push_req = 0;
+            top->host_join_reg = 0;
+            top->cq_pop = 0;
+            set_task(0);
+        }
+        cycles_total += c;
+        if (!root_done) {
+            fprintf(logf, "MISMATCH: %s: tree %u did not finish\n", name, t);
+            mism++;
+            break;
+        }
+    }
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+    top->cpl_valid = 0;
+
+    double per_tree = ntrees ? (double)cycles_total / ntrees : 0.0;
+    fprintf(logf, "[HOST] %s: cycles/tree=%.1f leader_ops/tree=%.1f leader_busy_cycles/tree=%.1f mismatches=%llu\n",
+            name, per_tree, (double)leader_ops / ntrees, (double)leader_busy / ntrees, (unsigned long long)mism);
+    cout << "[HOST] " << name << ": cycles/tree=" << per_tree << " leader ops/tree=" << (double)leader_ops / ntrees << endl;
+    bench_record(name, "leaves", leaves);
+    bench_record(name, "trees", ntrees);
+    bench_record(name, "service_cycles", svc_cycles);
+    bench_record(name, "num_followers", NUM_FOLLOWERS);
+    bench_record(name, "cycles_per_tree", per_tree);
+    bench_record(name, "leader_ops_per_tree", (double)leader_ops / ntrees);
+    bench_record(name, "leader_busy_cycles_per_tree", (double)leader_busy / ntrees);
+    bench_record(name, "leader_busy_fraction", cycles_total ? (double)leader_busy / cycles_total : 0.0);
+    bench_record(name, "mismatches", (double)mism);
+    metrics.mismatches += mism;
+}
+
+// Fan-out benchmark: follower engines hold each task for a service time drawn
+// from svc and are ready only when idle. The leader keeps the queue topped up,
+// so throughput is bounded by dispatch + service. Reports end-to-end dispatch
+// throughput and per-follower utilization.
+static void run_fanout_bench(FILE *logf, const char *name, int ncycles, const ServiceConfig &svc) {
+    fprintf(logf, "[HOST] Running fan-out benchmark %s followers=%d policy=%d service=%s[%u,%u] mean=%u cycles=%d\n",
+            name, NUM_FOLLOWERS, DISPATCH_POLICY, service_dist_name(svc.dist), svc.min, svc.max, svc.mean, ncycles);
+    fflush(logf);
+    vector<FollowerModel> followers(NUM_FOLLOWERS);
+    ServiceSampler sampler(svc, 2);
+    uint32_t next_val = 1;
+    uint64_t completed = 0;
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    top->follower_ready = 0;
+    reset_cycles(4);
+
+    for (int c = 0; c < ncycles; c++) {
+        completed += follower_cycle(followers, sampler, [](uint32_t) {}, [](uint32_t) {});
+
+        if (!top->full) {
+            top->host_push_req = 1;
+            set_task(next_val++);
+        }
+        tick();
+        top->host_push_req = 0;
+        set_task(0);
+    }
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+
+    double tpc = ncycles ? (double)completed / ncycles : 0.0;
+    double util_sum = 0.0;
+    fprintf(logf, "[HOST] %s: completed=%llu tasks/cycle=%.4f\n", name, (unsigned long long)completed, tpc);
+    bench_record(name, "cycles", ncycles);
+    bench_record(name, "num_followers", NUM_FOLLOWERS);
+    bench_record(name, "policy", DISPATCH_POLICY);
+    bench_record(name, "follower_credits", FOLLOWER_CREDITS);
+    bench_record(name, "service_mean", sampler.mean());
+    bench_record(name, "completed", (double)completed);
+    bench_record(name, "tasks_per_cycle", tpc);
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        double util = ncycles ? (double)followers[f].busy_cycles / ncycles : 0.0;
+        util_sum += util;
+        fprintf(logf, "  follower %d: served=%llu util=%.3f\n", f, (unsigned long long)followers[f].served, util);
+        string key = "follower" + to_string(f) + "_util";
+        bench_record(name, key.c_str(), util);
+    }
+    bench_record(name, "mean_follower_util", util_sum / NUM_FOLLOWERS);
+    cout << "[HOST] " << name << ": tasks/cycle=" << tpc << " mean follower util=" << util_sum / NUM_FOLLOWERS << endl;
+}
+
+// End-to-end leader/follower benchmark, the RTL counterpart of model/behavioral.py:
+// tasks arrive at the leader as a Bernoulli process (arrival_rate tasks/cycle),
+// the leader pushes one task per cycle and blocks while the queue is full, and
+// follower engines execute what the distributor hands them. All times in cycles.
+static void run_e2e_bench(FILE *logf, const char *name, int num_tasks, double arrival_rate, const ServiceConfig &svc) {
+    fprintf(logf, "[HOST] Running end-to-end benchmark %s tasks=%d followers=%d arrival=%.3f/cycle service=%s mean=%u\n",
+            name, num_tasks, NUM_FOLLOWERS, arrival_rate, service_dist_name(svc.dist), svc.mean);
+    fflush(logf);
+    vector<FollowerModel> followers(NUM_FOLLOWERS);
+    ServiceSampler sampler(svc, 3);
+    mt19937 rng(4);
+    bernoulli_distribution arrive(arrival_rate > 1.0 ? 1.0 : arrival_rate);
+
+    // task ids are 1..num_tasks; per-task timestamps indexed by id
+    vector<uint64_t> t_arrival(num_tasks + 1, 0), t_start(num_tasks + 1, 0), t_finish(num_tasks + 1, 0);
+    deque<uint32_t> arrival_buffer;
+    uint32_t next_arrival = 1;
+    uint64_t completed = 0, leader_busy = 0, leader_block = 0;
+    const uint64_t max_cycles = 100ull * num_tasks * (svc.max > svc.mean ? svc.max : svc.mean) + 10000;
+
+    top->host_mode = 1;
+    top->dispatch_mode = 1;
+    top->follower_ready = 0;
+    reset_cycles(4);
+
+    uint64_t c = 0;
+    for (; completed < (uint64_t)num_tasks && c < max_cycles; c++) {
+        if (next_arrival <= (uint32_t)num_tasks && arrive(rng)) {
+            t_arrival[next_arrival] = c;
+            arrival_buffer.push_back(next_arrival++);
+        }
+
+        completed += follower_cycle(followers, sampler,
+            [&](uint32_t tid) { if (tid >= 1 && tid <= (uint32_t)num_tasks) t_start[tid] = c; },
+            [&](uint32_t tid) { if (tid >= 1 && tid <= (uint32_t)num_tasks) t_finish[tid] = c; });
+
+        if (!arrival_buffer.empty()) {
+            leader_busy++;
+            if (top->full) {
+                leader_block++;
+            } else {
+                top->host_push_req = 1;
+                set_task(arrival_buffer.front());
+                arrival_buffer.pop_front();
+            }
+        }
+        tick();
+        top->host_push_req = 0;
+        set_task(0);
+    }
+
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+
+    vector<double> latency, wait;
+    for (int t = 1; t <= num_tasks; t++) {
+        if (t_finish[t] >= t_arrival[t] && t_finish[t]) latency.push_back((double)(t_finish[t] - t_arrival[t]));
+        if (t_start[t] >= t_arrival[t] && t_start[t]) wait.push_back((double)(t_start[t] - t_arrival[t]));
+    }
+    sort(latency.begin(), latency.end());
+    sort(wait.begin(), wait.end());
+    auto pct = [](const vector<double> &v, double p) {
+        return v.empty() ? 0.0 : v[(size_t)(p * (v.size() - 1))];
+    };
+    double mean_lat = 0.0;
+    for (double x : latency) mean_lat += x;
+    if (!latency.empty()) mean_lat /= latency.size();
+
+    double total = c ? (double)c : 1.0;
+    double util_sum = 0.0;
+    for (int f = 0; f < NUM_FOLLOWERS; f++) util_sum += followers[f].busy_cycles / total;
+
+    fprintf(logf, "[HOST] %s: cycles=%llu completed=%llu tasks/cycle=%.4f leader_block=%llu follower_util=%.3f median_latency=%.1f\n",
+            name, (unsigned long long)c, (unsigned long long)completed, completed / total,
+            (unsigned long long)leader_block, util_sum / NUM_FOLLOWERS, pct(latency, 0.5));
+    cout << "[HOST] " << name << ": tasks/cycle=" << completed / total << " follower util=" << util_sum / NUM_FOLLOWERS
+         << " leader block cycles=" << leader_block << endl;
+
+    bench_record(name, "num_tasks", num_tasks);
+    bench_record(name, "num_followers", NUM_FOLLOWERS);
+    bench_record(name, "policy", DISPATCH_POLICY);
+    bench_record(name, "arrival_rate", arrival_rate);
+    bench_record(name, "service_mean", sampler.mean());
+    bench_record(name, "cycles", total);
+    bench_record(name, "completed_tasks", (double)completed);
+    bench_record(name, "tasks_per_cycle", completed / total);
+    bench_record(name, "leader_util", leader_busy / total);
+    bench_record(name, "leader_block_cycles", (double)leader_block);
+    bench_record(name, "leader_block_fraction", leader_block / total);
+    bench_record(name, "follower_busy_fraction", util_sum / NUM_FOLLOWERS);
+    bench_record(name, "latency_avg_cycles", mean_lat);
+    bench_record(name, "latency_median_cycles", pct(latency, 0.5));
+    bench_record(name, "latency_p99_cycles", pct(latency, 0.99));
+    bench_record(name, "wait_median_cycles", pct(wait, 0.5));
+}
+
+// Timer wheel benchmark: accepted delayed pushes and releases per cycle, and
+// how late tasks reach the head of the queue past their release cycle.
+static void run_timer_bench(FILE *logf, const char *name, int ncycles, int push_pct) {
+    fprintf(logf, "[HOST] Running timer benchmark %s slots=%d bucket=%d push=%d%% cycles=%d\n",
+            name, TIMER_SLOTS, TIMER_BUCKET, push_pct, ncycles);
+    fflush(logf);
+    TimerRun r = run_timer_workload(logf, ncycles, push_pct, 5);
+    auto pct = [&](double p) {
+        return r.lateness.empty() ? 0.0 : (double)r.lateness[(size_t)(p * (r.lateness.size() - 1))];
+    };
+    double late_mean = r.released ? (double)r.late_sum / r.released : 0.0;
+    fprintf(logf, "[HOST] %s: accepted/cycle=%.3f released/cycle=%.3f refused=%llu lateness mean=%.2f p99=%.0f max=%llu\n",
+            name, (double)r.accepted / ncycles, (double)r.released / ncycles, (unsigned long long)r.refused,
+            late_mean, pct(0.99), (unsigned long long)r.late_max);
+    cout << "[HOST] " << name << ": accepted/cycle=" << (double)r.accepted / ncycles
+         << " lateness p99=" << pct(0.99) << " max=" << r.late_max << endl;
+    bench_record(name, "timer_slots", TIMER_SLOTS);
+    bench_record(name, "timer_bucket", TIMER_BUCKET);
+    bench_record(name, "cycles", ncycles);
+    bench_record(name, "push_pct", push_pct);
+    bench_record(name, "offered", (double)r.offered);
+    bench_record(name, "accepted", (double)r.accepted);
+    bench_record(name, "refused", (double)r.refused);
+    bench_record(name, "accepted_per_cycle", (double)r.accepted / ncycles);
+    bench_record(name, "released_per_cycle", (double)r.released / ncycles);
+    bench_record(name, "lateness_mean_cycles", late_mean);
+    bench_record(name, "lateness_median_cycles", pct(0.5));
+    bench_record(name, "lateness_p99_cycles", pct(0.99));
+    bench_record(name, "lateness_max_cycles", (double)r.late_max);
+    bench_record(name, "early", (double)r.early);
+    bench_record(name, "lost", (double)r.lost);
+    metrics.mismatches += r.early + r.lost;
+}
+
 int main(int argc, char **argv) {
     Verilated::commandArgs(argc, argv);
 
@@ -308,7 +1406,21 @@ int main(int argc, char **argv) {
     top->host_mode = 1;
     top->host_push_req = 0;
     top->host_pop_req = 0;
-    top->host_data_in = 0;
+    top->host_push_at = 0;
+    top->host_release = 0;
+    set_task(0);
+    top->dispatch_mode = 0;
+    top->cpl_valid = 0;
+    top->cq_pop = 0;
+    top->host_join_reg = 0;
+    top->host_join_slot = 0;
+    top->host_join_count = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+    top->wm_we = 0;
+    top->wm_high = QUEUE_DEPTH;
+    top->wm_low = 0;
+    top->perf_clear = 0;
     top->tb_done = 0;
     top->eval();
     if (tfp) tfp->dump(sim_time++);
@@ -316,6 +1428,11 @@ int main(int argc, char **argv) {
     // Run deterministic test
     cycles = 0;
     uint64_t mism1 = run_deterministic_test(logf);
+    mism1 += run_watermark_test(logf);
+    mism1 += run_descriptor_test(logf);
+    mism1 += run_timer_test(logf);
+    mism1 += run_completion_test(logf);
+    mism1 += run_join_test(logf);
 
     // Run randomized test
     cycles = 0;
@@ -346,6 +1463,42 @@ int main(int argc, char **argv) {
     metrics.sim_cycles = cycles;
     write_results_json("outputs/results.json", metrics);
     write_metrics_csv("outputs/metrics.csv", metrics);
+    write_residency_csv("outputs/residency_hist.csv", residency_hist);
+
+    // Optional benchmarks (run after the functional tests so their counters are untouched)
+    uint64_t mism_bench = 0;
+    if (bench_enabled(argc, argv, "dispatch")) {
+        metrics = Metrics();
+        run_dispatch_bench(logf, "dispatch", 10000, 100);
+        run_dispatch_bench(logf, "dispatch_backpressure", 10000, 50);
+        mism_bench += metrics.mismatches;
+    }
+    if (bench_enabled(argc, argv, "desc")) {
+        metrics = Metrics();
+        run_desc_bench(logf, "desc", 10000);
+        mism_bench += metrics.mismatches;
+    }
+    ServiceConfig svc = parse_service_config(argc, argv, 4 * NUM_FOLLOWERS);
+    if (bench_enabled(argc, argv, "fanout")) {
+        run_fanout_bench(logf, "fanout", 20000, svc);
+    }
+    if (bench_enabled(argc, argv, "e2e")) {
+        double arrival_rate = atof(arg_value(argc, argv, "--arrival-rate", "0.2"));
+        run_e2e_bench(logf, "e2e", 1000, arrival_rate, svc);
+    }
+    if (bench_enabled(argc, argv, "dag")) {
+        metrics = Metrics();
+        run_dag_bench(logf, "dag_sw", false, 16, 64, 8);
+        run_dag_bench(logf, "dag_join", true, 16, 64, 8);
+        mism_bench += metrics.mismatches;
+    }
+    if (bench_enabled(argc, argv, "timer")) {
+        metrics = Metrics();
+        run_timer_bench(logf, "timer", 20000, 50);
+        run_timer_bench(logf, "timer_saturated", 20000, 100);
+        mism_bench += metrics.mismatches;
+    }
+    if (!bench_results.empty()) write_bench_json("outputs/bench.json");
 
     // Close and cleanup
     if (tfp) {
@@ -360,5 +1513,5 @@ int main(int argc, char **argv) {
     }
 
     fclose(logf);
-    return (mism1 + mism2) == 0 ? 0 : 2;
+    return (mism1 + mism2 + mism_bench) == 0 ? 0 : 2;
 }
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""
+model/compare_runtime.py
+
+Compare measured host throughput of the leader/follower runtime
+(sw/tests/bench_runtime.c) with what the behavioral model predicts for the
+same follower count, task duration and leader dispatch cost.
+
+Every `runtime_*` row of the bench log is replayed through
+behavioral.run_sim() with all tasks available up front (saturating arrivals),
+NUM_FOLLOWERS = followers, TASK_DURATION_MEAN = task_ns and the measured
+per-task dispatch time. Predicted throughput is tasks / simulated makespan.
+
+Usage:
+    cd sw && make runtime_bench && ./bench_runtime
+    python model/compare_runtime.py [--log sw/logs/bench_runtime.json] [--out model/runtime_vs_model.json]
+"""
+from __future__ import annotations
+import argparse
+import json
+import os
+import sys
+
+BASE_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, BASE_DIR)
+
+from model import behavioral  # noqa: E402
+
+
+def predict(row: dict, sim_tasks: int) -> float:
+    """Predicted tasks/s for one bench row."""
+    n = int(min(row["tasks"], sim_tasks))
+    cfg = {
+        "NUM_TASKS": n,
+        "NUM_FOLLOWERS": int(row["followers"]),
+        "NUM_LEADERS": 1,
+        "TASK_DURATION_MEAN": float(row["task_ns"]),
+        "TASK_DURATION_SD": 0.0,
+        "DISPATCH_TIME_SW": float(row["dispatch_ns"]),
+        "DISPATCH_TIME_HW": float(row["dispatch_ns"]),
+        "ARRIVAL_MODEL": "deterministic",
+        "ARRIVAL_RATE": 1e6,          # effectively all tasks queued at t=0
+        "BATCH_ENQUEUE": 1,
+        "SIM_TRACE_SAMPLE_INTERVAL": max(1.0, float(row["task_ns"])),
+    }
+    res = behavioral.run_sim(mode="sw", config=cfg)
+    makespan = res["summary"]["env_now"]
+    return n / makespan * 1e9 if makespan > 0 else 0.0
+
+
+def main() -> None:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--log", default=os.path.join(BASE_DIR, "sw", "logs", "bench_runtime.json"))
+    ap.add_argument("--out", default=os.path.join(BASE_DIR, "model", "runtime_vs_model.json"))
+    ap.add_argument("--sim-tasks", type=int, default=2000, help="cap on tasks simulated per row")
+    args = ap.parse_args()
+
+    with open(args.log) as f:
+        log = json.load(f)
+    cpus = int(log.get("host", {}).get("cpus", 0))
+
+    rows = []
+    print(f"{'bench':<20} {'followers':>9} {'measured/s':>12} {'model/s':>12} {'ratio':>7}")
+    for name, row in log.items():
+        if not name.startswith("runtime_"):
+            continue
+        model_tps = predict(row, args.sim_tasks)
+        measured = float(row["tasks_per_sec"])
+        ratio = measured / model_tps if model_tps > 0 else 0.0
+        # the leader needs a core too; past that, followers time-share
+        oversubscribed = cpus > 0 and row["followers"] + 1 > cpus
+        print(f"{name:<20} {int(row['followers']):>9} {measured:>12.0f} {model_tps:>12.0f} {ratio:>7.2f}"
+              + ("  (oversubscribed)" if oversubscribed else ""))
+        rows.append({
+            "bench": name,
+            "followers": int(row["followers"]),
+            "task_ns": row["task_ns"],
+            "dispatch_ns": row["dispatch_ns"],
+            "measured_tasks_per_sec": measured,
+            "model_tasks_per_sec": model_tps,
+            "ratio": ratio,
+            "oversubscribed": oversubscribed,
+        })
+
+    with open(args.out, "w") as f:
+        json.dump({"host_cpus": cpus, "rows": rows}, f, indent=4)
+    print(f"Saved comparison to {args.out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+model/multi_queue_model.py
+
+Cycle model of the free-list and linked-list update in hw/rtl/hb_multi_queue.sv,
+checked against one reference deque per queue under random push/pop traffic.
+
+Each cycle mirrors the RTL: push_ok / pop_ok and the allocated entry are
+computed from the current state, then every register is updated from the old
+values at once (non-blocking semantics). The checks are the ones the RTL must
+hold: pops return the reference head, a push is refused only when the pool is
+dry (and no pop frees an entry) or the queue is at MAX_PER_QUEUE, and free
+entries plus queued entries always add up to POOL_DEPTH.
+
+Usage:
+    python model/multi_queue_model.py [--queues 4] [--pool 8] [--max-per-queue 8] [--trials 200] [--cycles 3000]
+"""
+from __future__ import annotations
+import argparse
+import collections
+import random
+
+
+def run_trial(nq: int, pool: int, maxq: int, cycles: int, rng: random.Random) -> None:
+    nxt = [(i + 1) % pool for i in range(pool)]   # reset: free list 0 -> 1 -> ... -> pool-1
+    data = [0] * pool
+    head = [0] * nq
+    tail = [0] * nq
+    cnt = [0] * nq
+    free_head, free_cnt = 0, pool
+    ref = [collections.deque() for _ in range(nq)]
+    value = 1
+
+    for cycle in range(cycles):
+        push_req = rng.random() < 0.6
+        push_qid = rng.randrange(nq)
+        pop_req = rng.random() < 0.5
+        pop_qid = rng.randrange(nq)
+
+        # combinational side
+        pop_entry = head[pop_qid]
+        same_q = push_qid == pop_qid
+        pop_ok = pop_req and cnt[pop_qid] != 0
+        push_ok = push_req and (free_cnt != 0 or pop_ok) and cnt[push_qid] < maxq
+        data_out = data[pop_entry]
+        alloc = free_head if free_cnt != 0 else pop_entry
+        push_into_empty = cnt[push_qid] == 0 or (pop_ok and same_q and cnt[push_qid] == 1)
+
+        # clock edge: every update reads the old state
+        n_head, n_tail, n_cnt, n_nxt, n_data = head[:], tail[:], cnt[:], nxt[:], data[:]
+        n_free_head, n_free_cnt = free_head, free_cnt
+        if pop_ok:
+            n_head[pop_qid] = nxt[pop_entry]
+        if push_ok:
+            n_data[alloc] = value
+            if push_into_empty:
+                n_head[push_qid] = alloc
+            else:
+                n_nxt[tail[push_qid]] = alloc
+            n_tail[push_qid] = alloc
+        if pop_ok and push_ok:
+            if free_cnt != 0:
+                n_nxt[pop_entry] = nxt[free_head]
+                n_free_head = pop_entry
+        elif pop_ok:
+            n_nxt[pop_entry] = free_head
+            n_free_head = pop_entry
+            n_free_cnt = free_cnt + 1
+        elif push_ok:
+            n_free_head = nxt[free_head]
+            n_free_cnt = free_cnt - 1
+        if push_ok and not (pop_ok and same_q):
+            n_cnt[push_qid] += 1
+        if pop_ok and not (push_ok and same_q):
+            n_cnt[pop_qid] -= 1
+
+        # reference queues
+        where = f"cycle {cycle}"
+        if push_req and not push_ok:
+            pool_dry = sum(map(len, ref)) == pool and not pop_ok
+            assert pool_dry or len(ref[push_qid]) >= maxq, f"{where}: push to queue {push_qid} refused"
+        if pop_ok:
+            expect = ref[pop_qid].popleft()
+            assert data_out == expect, f"{where}: queue {pop_qid} popped {data_out}, expected {expect}"
+        else:
+            assert not (pop_req and ref[pop_qid]), f"{where}: pop from non-empty queue {pop_qid} refused"
+        if push_ok:
+            ref[push_qid].append(value)
+        value += 1
+
+        head, tail, cnt, nxt, data = n_head, n_tail, n_cnt, n_nxt, n_data
+        free_head, free_cnt = n_free_head, n_free_cnt
+        assert free_cnt + sum(cnt) == pool, f"{where}: {free_cnt} free + {sum(cnt)} queued != {pool}"
+        assert cnt == [len(r) for r in ref], f"{where}: counts {cnt} disagree with the reference"
+
+
+def main() -> None:
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("--queues", type=int, default=4)
+    ap.add_argument("--pool", type=int, default=8)
+    ap.add_argument("--max-per-queue", type=int, default=None, help="default: the pool size")
+    ap.add_argument("--trials", type=int, default=200)
+    ap.add_argument("--cycles", type=int, default=3000)
+    ap.add_argument("--seed", type=int, default=3)
+    args = ap.parse_args()
+    maxq = args.max_per_queue if args.max_per_queue is not None else args.pool
+
+    rng = random.Random(args.seed)
+    for trial in range(args.trials):
+        try:
+            run_trial(args.queues, args.pool, maxq, args.cycles, rng)
+        except AssertionError as e:
+            raise SystemExit(f"trial {trial}: {e}")
+    print(f"multi-queue model: {args.trials} trials x {args.cycles} cycles ok "
+          f"(queues={args.queues} pool={args.pool} max_per_queue={maxq})")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,139 @@
+// sw/src/sw_queue.c
+#define _POSIX_C_SOURCE 200809L
+
+#include "sw_queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+int swq_init(struct swq *q, enum swq_kind kind, unsigned capacity) {
+    if (!q || capacity == 0 || capacity > (1u << 30) || kind > SWQ_MPMC) return -1;
+    unsigned cap = 1;
+    while (cap < capacity) cap <<= 1;
+    memset(q, 0, sizeof(*q));
+    q->kind = kind;
+    q->mask = cap - 1;
+    if (posix_memalign((void **)&q->cells, 64, cap * sizeof(*q->cells)) != 0) {
+        q->cells = NULL;
+        return -1;
+    }
+    // cell i is free for the producer at position i
+    for (uint32_t i = 0; i < cap; i++) {
+        q->cells[i].seq = i;
+        q->cells[i].value = 0;
+    }
+    return 0;
+}
+
+void swq_destroy(struct swq *q) {
+    if (!q) return;
+    free(q->cells);
+    q->cells = NULL;
+}
+
+unsigned swq_capacity(const struct swq *q) {
+    return q->mask + 1;
+}
+
+// Lamport ring: each side owns one index and only reads the other's, refreshing
+// its cached copy when the ring looks full (producer) or empty (consumer)
+static int spsc_push(struct swq *q, uint32_t value) {
+    uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    if (t - q->head_cache > q->mask) {
+        q->head_cache = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+        if (t - q->head_cache > q->mask) return -1;
+    }
+    q->cells[t & q->mask].value = value;
+    __atomic_store_n(&q->tail, t + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int spsc_pop(struct swq *q, uint32_t *out) {
+    uint32_t h = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    if (h == q->tail_cache) {
+        q->tail_cache = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+        if (h == q->tail_cache) return -1;
+    }
+    *out = q->cells[h & q->mask].value;
+    __atomic_store_n(&q->head, h + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Sequence-numbered cells (Vyukov): a cell at position p is writable when
+// seq == p and readable when seq == p + 1; the reader hands it to position
+// p + capacity. Producers always claim with a CAS here, consumers only for MPMC.
+static int mp_push(struct swq *q, uint32_t value) {
+    uint32_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    struct swq_cell *c;
+    for (;;) {
+        c = &q->cells[pos & q->mask];
+        uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        int32_t dif = (int32_t)(seq - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return -1;      // the cell still holds the word from one lap ago
+        } else {
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+    c->value = value;
+    __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int mp_pop(struct swq *q, uint32_t *out) {
+    uint32_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    struct swq_cell *c;
+    for (;;) {
+        c = &q->cells[pos & q->mask];
+        uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        int32_t dif = (int32_t)(seq - (pos + 1));
+        if (dif == 0) {
+            if (q->kind == SWQ_MPSC) {
+                __atomic_store_n(&q->head, pos + 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return -1;      // not written yet (empty, or a producer mid-push)
+        } else {
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+    *out = c->value;
+    __atomic_store_n(&c->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int swq_push(struct swq *q, uint32_t value) {
+    return q->kind == SWQ_SPSC ? spsc_push(q, value) : mp_push(q, value);
+}
+
+int swq_pop(struct swq *q, uint32_t *out) {
+    return q->kind == SWQ_SPSC ? spsc_pop(q, out) : mp_pop(q, out);
+}
+
+unsigned swq_occupancy(struct swq *q) {
+    uint32_t h = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    int32_t n = (int32_t)(t - h);   // head can pass a stale tail in the snapshot
+    if (n < 0) return 0;
+    return (uint32_t)n > q->mask + 1 ? q->mask + 1 : (unsigned)n;
+}
+
+bool swq_is_full(struct swq *q) {
+    return swq_occupancy(q) == q->mask + 1;
+}
+
+bool swq_is_valid(struct swq *q) {
+    return swq_occupancy(q) > 0;
+}
+
+const char *swq_kind_name(enum swq_kind kind) {
+    switch (kind) {
+    case SWQ_SPSC: return "spsc";
+    case SWQ_MPSC: return "mpsc";
+    case SWQ_MPMC: return "mpmc";
+    }
+    return "?";
+}
@@ -0,0 +1,56 @@
+// sw/src/sw_queue.h
+// Lock-free bounded rings of 32-bit task words: the software baseline for the
+// hardware queue. The calls mirror task_queue_mmio.h (push/pop return
+// 0=success, -1=refused; full/valid status) on an explicit queue object, with
+// no timeout since nothing waits on a bridge.
+//
+//   SWQ_SPSC  one producer, one consumer: two indices, no read-modify-write
+//   SWQ_MPSC  producers claim cells with a CAS on the tail, one consumer
+//   SWQ_MPMC  both sides claim cells with a CAS (per-cell sequence numbers)
+//
+// Using a queue with more producers or consumers than its kind allows is
+// undefined. swq_is_full() / swq_is_valid() are snapshots: with other threads
+// running, the next push or pop can still be refused.
+#ifndef SW_QUEUE_H
+#define SW_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum swq_kind {
+    SWQ_SPSC = 0,
+    SWQ_MPSC = 1,
+    SWQ_MPMC = 2,
+};
+
+struct swq_cell {
+    uint32_t seq;       // MPSC/MPMC: position the cell is ready for
+    uint32_t value;
+};
+
+struct swq {
+    enum swq_kind kind;
+    uint32_t mask;      // capacity - 1
+    struct swq_cell *cells;
+    // producer and consumer indices (free-running) on their own cache lines
+    _Alignas(64) uint32_t tail;
+    uint32_t head_cache;        // SPSC producer's last view of head
+    _Alignas(64) uint32_t head;
+    uint32_t tail_cache;        // SPSC consumer's last view of tail
+    _Alignas(64) char end[1];
+};
+
+int swq_init(struct swq *q, enum swq_kind kind, unsigned capacity); // capacity rounded up to a power of 2; 0=success, -1=bad args/no memory
+void swq_destroy(struct swq *q);
+unsigned swq_capacity(const struct swq *q);
+
+int swq_push(struct swq *q, uint32_t value); // 0=success, -1=refused (full)
+int swq_pop(struct swq *q, uint32_t *out);   // 0=success, -1=refused (empty)
+
+bool swq_is_full(struct swq *q);
+bool swq_is_valid(struct swq *q);           // at least one word queued
+unsigned swq_occupancy(struct swq *q);
+
+const char *swq_kind_name(enum swq_kind kind);
+
+#endif // SW_QUEUE_H
@@ -0,0 +1,79 @@
+// sw/src/task_arena.c
+#define _POSIX_C_SOURCE 200809L
+
+#include "task_arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HEAD(tag, idx) (((uint64_t)(tag) << 32) | (uint32_t)(idx))
+#define HEAD_IDX(h) ((uint32_t)(h))
+#define HEAD_TAG(h) ((uint32_t)((h) >> 32))
+
+int ta_init(struct ta_arena *a, uint32_t count, size_t desc_size) {
+    if (!a || count == 0 || count > TA_MAX_DESCS || desc_size == 0) return -1;
+    memset(a, 0, sizeof(*a));
+    a->stride = (desc_size + 63) & ~(size_t)63;
+    a->count = count;
+    void *mem = NULL;
+    if (posix_memalign(&mem, 64, a->stride * count) != 0) return -1;
+    a->base = mem;
+    a->next = malloc(count * sizeof(*a->next));
+    if (!a->next) {
+        ta_destroy(a);
+        return -1;
+    }
+    // touch every descriptor now rather than on first use in the dispatch loop
+    memset(a->base, 0, a->stride * count);
+    for (uint32_t i = 0; i < count; i++) a->next[i] = i + 1 < count ? i + 1 : TA_NULL;
+    a->head = HEAD(0, 0);
+    return 0;
+}
+
+void ta_destroy(struct ta_arena *a) {
+    if (!a) return;
+    free(a->base);
+    free(a->next);
+    a->base = NULL;
+    a->next = NULL;
+    a->count = 0;
+}
+
+uint32_t ta_alloc(struct ta_arena *a) {
+    uint64_t old = __atomic_load_n(&a->head, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t idx = HEAD_IDX(old);
+        if (idx == TA_NULL) {
+            __atomic_add_fetch(&a->empty, 1, __ATOMIC_RELAXED);
+            return TA_NULL;
+        }
+        // may read the link of a descriptor another thread just took; the tag
+        // check in the CAS then fails and we retry
+        uint32_t nxt = __atomic_load_n(&a->next[idx], __ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(&a->head, &old, HEAD(HEAD_TAG(old) + 1, nxt), true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            uint32_t n = __atomic_add_fetch(&a->in_use, 1, __ATOMIC_RELAXED);
+            uint32_t hw = __atomic_load_n(&a->high_water, __ATOMIC_RELAXED);
+            while (n > hw && !__atomic_compare_exchange_n(&a->high_water, &hw, n, true,
+                                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+            return idx;
+        }
+    }
+}
+
+void ta_free(struct ta_arena *a, uint32_t handle) {
+    if (!ta_valid(a, handle)) return;
+    uint64_t old = __atomic_load_n(&a->head, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&a->next[handle], HEAD_IDX(old), __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&a->head, &old, HEAD(HEAD_TAG(old) + 1, handle), true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_sub_fetch(&a->in_use, 1, __ATOMIC_RELAXED);
+}
+
+uint32_t ta_in_use(struct ta_arena *a) {
+    return __atomic_load_n(&a->in_use, __ATOMIC_RELAXED);
+}
+
+uint32_t ta_high_water(struct ta_arena *a) {
+    return __atomic_load_n(&a->high_water, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,51 @@
+// sw/src/task_arena.h
+// Fixed pool of task descriptors shared by the leader and the followers. The
+// queue only carries 32-bit handles: the leader takes a descriptor with
+// ta_alloc(), fills it through ta_ptr(), and pushes the handle; whoever pops it
+// translates it back and returns it with ta_free(). All memory is allocated
+// once in ta_init(), so dispatch never reaches malloc.
+//
+// The free list is a lock-free stack of indices whose head carries a tag that
+// changes on every update, so a handle freed and reallocated between another
+// thread's read and its CAS cannot corrupt the list (ABA). Any thread may
+// allocate or free. Handles are below 2^24, so they also fit the ID field of
+// MMIO_JOIN_CHILD().
+#ifndef TASK_ARENA_H
+#define TASK_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define TA_NULL 0xFFFFFFFFu
+#define TA_MAX_DESCS (1u << 24)
+
+struct ta_arena {
+    uint8_t *base;
+    size_t stride;          // descriptor size rounded up to a cache line
+    uint32_t count;
+    uint32_t *next;         // free-list link per descriptor
+    _Alignas(64) uint64_t head;     // tag << 32 | index of the top free descriptor
+    _Alignas(64) uint32_t in_use;
+    uint32_t high_water;
+    uint64_t empty;         // ta_alloc() calls that found no free descriptor
+};
+
+int ta_init(struct ta_arena *a, uint32_t count, size_t desc_size); // 0=success, -1=bad args/no memory
+void ta_destroy(struct ta_arena *a);
+
+uint32_t ta_alloc(struct ta_arena *a);          // handle, or TA_NULL when all are in use
+void ta_free(struct ta_arena *a, uint32_t handle);
+
+static inline void *ta_ptr(const struct ta_arena *a, uint32_t handle) {
+    return a->base + (size_t)handle * a->stride;
+}
+
+static inline int ta_valid(const struct ta_arena *a, uint32_t handle) {
+    return handle < a->count;
+}
+
+uint32_t ta_in_use(struct ta_arena *a);
+uint32_t ta_high_water(struct ta_arena *a);
+
+#endif // TASK_ARENA_H
@@ -0,0 +1,122 @@
+// sw/src/task_dispatch.c
+#define _POSIX_C_SOURCE 200809L
+
+#include "task_dispatch.h"
+#include "task_queue_mmio.h"
+#include <string.h>
+#include <time.h>
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void td_init(struct td_dispatcher *d, enum td_policy policy, unsigned batch, uint64_t max_wait_ns) {
+    memset(d, 0, sizeof(*d));
+    d->policy = policy;
+    d->max_batch = mmio_batch_capacity();
+    if (d->max_batch == 0) d->max_batch = 1;
+    d->batch = batch < 1 ? 1 : batch > d->max_batch ? d->max_batch : batch;
+    d->max_wait_ns = max_wait_ns;
+}
+
+int td_submit(struct td_dispatcher *d, uint32_t word) {
+    if (d->count == TD_PENDING_MAX) return -1;
+    unsigned i = (d->head + d->count) % TD_PENDING_MAX;
+    d->words[i] = word;
+    d->stamps[i] = now_ns();
+    d->count++;
+    d->stats.submitted++;
+    return 0;
+}
+
+unsigned td_pending(const struct td_dispatcher *d) {
+    return d->count;
+}
+
+// pushes the first n staged words as one batch; returns how many were accepted
+static unsigned push_front(struct td_dispatcher *d, unsigned n, int timeout_ms) {
+    uint32_t buf[MMIO_BATCH_MAX];
+    for (unsigned i = 0; i < n; i++) buf[i] = d->words[(d->head + i) % TD_PENDING_MAX];
+    unsigned acc = 0;
+    mmio_push_batch(buf, n, &acc, timeout_ms);
+    d->stats.batches++;
+    d->stats.refused += n - acc;
+
+    uint64_t t = now_ns();
+    for (unsigned i = 0; i < acc; i++) {
+        unsigned k = (d->head + i) % TD_PENDING_MAX;
+        if (d->on_dispatch) d->on_dispatch(d->words[k], t - d->stamps[k], d->ctx);
+    }
+    d->head = (d->head + acc) % TD_PENDING_MAX;
+    d->count -= acc;
+    d->stats.dispatched += acc;
+    return acc;
+}
+
+static void shrink(struct td_dispatcher *d) {
+    if (d->batch > 1) {
+        d->batch /= 2;
+        d->stats.shrinks++;
+    }
+}
+
+static void grow(struct td_dispatcher *d) {
+    if (d->batch < d->max_batch) {
+        d->batch = d->batch * 2 > d->max_batch ? d->max_batch : d->batch * 2;
+        d->stats.grows++;
+    }
+}
+
+unsigned td_poll(struct td_dispatcher *d) {
+    unsigned total = 0;
+    while (d->count > 0) {
+        bool late = now_ns() - d->stamps[d->head] >= d->max_wait_ns;
+        unsigned n = d->count < d->batch ? d->count : d->batch;
+
+        if (d->policy == TD_FIXED) {
+            if (d->count < d->batch && !late) break;
+        } else {
+            uint32_t credits = mmio_credits();
+            if (credits == 0) {
+                shrink(d);
+                break;      // a push now would only be refused
+            }
+            if (d->count < d->batch && !late) break;
+            if (n > credits) n = credits;
+            if (credits < d->batch) shrink(d);
+            else if (credits - n >= 2 * d->batch) grow(d);
+        }
+        if (n < d->batch && late) d->stats.deadline_flushes++;
+
+        unsigned acc = push_front(d, n, 100);
+        total += acc;
+        if (acc < n) {
+            if (d->policy == TD_ADAPTIVE) shrink(d);
+            break;
+        }
+    }
+    return total;
+}
+
+unsigned td_flush(struct td_dispatcher *d, int timeout_ms) {
+    unsigned total = 0;
+    uint64_t t0 = now_ns();
+    const struct timespec pause = {0, 50000};
+    while (d->count > 0) {
+        unsigned n = d->count < d->max_batch ? d->count : d->max_batch;
+        if (d->policy == TD_ADAPTIVE) {
+            uint32_t credits = mmio_credits();
+            if (n > credits) n = credits;
+        }
+        unsigned acc = n ? push_front(d, n, 100) : 0;
+        total += acc;
+        if (acc < n || n == 0) {
+            // queue full: give the followers time to drain it
+            if (now_ns() - t0 >= (uint64_t)timeout_ms * 1000000ull) break;
+            nanosleep(&pause, NULL);
+        }
+    }
+    return total;
+}
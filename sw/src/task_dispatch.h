@@ -0,0 +1,60 @@
+// sw/src/task_dispatch.h
+// Batching dispatcher on top of the MMIO driver. The leader submits task words
+// with td_submit(); they wait in a staging ring until td_poll() pushes them in
+// batches through the batch window (mmio_push_batch), one handshake per batch.
+// Words refused by a full queue stay at the front of the ring, so order is kept.
+//
+//   TD_FIXED     a batch is due once `batch` words are pending
+//   TD_ADAPTIVE  the batch target follows the queue: each poll reads CREDITS
+//                only; a batch is capped at the free entries, the target
+//                doubles while the queue keeps twice the target free and halves
+//                after a refusal or when fewer entries than the target are free.
+//                Nothing is pushed while CREDITS reads zero.
+//
+// In both, a partial batch goes out once its oldest word has waited max_wait_ns.
+#ifndef TASK_DISPATCH_H
+#define TASK_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TD_PENDING_MAX 1024
+
+enum td_policy {
+    TD_FIXED = 0,
+    TD_ADAPTIVE = 1,
+};
+
+struct td_stats {
+    unsigned long submitted;
+    unsigned long dispatched;
+    unsigned long batches;          // batch handshakes issued
+    unsigned long refused;          // words sent back by a full queue
+    unsigned long deadline_flushes; // batches sent short because max_wait_ns ran out
+    unsigned long grows, shrinks;   // adaptive target changes
+};
+
+// called for every word the queue accepted, with how long it was staged
+typedef void (*td_dispatch_fn)(uint32_t word, uint64_t wait_ns, void *ctx);
+
+struct td_dispatcher {
+    enum td_policy policy;
+    unsigned batch;         // TD_FIXED: batch size; TD_ADAPTIVE: current target
+    unsigned max_batch;     // mmio_batch_capacity() at init
+    uint64_t max_wait_ns;
+    uint32_t words[TD_PENDING_MAX];
+    uint64_t stamps[TD_PENDING_MAX];
+    unsigned head, count;
+    td_dispatch_fn on_dispatch;
+    void *ctx;
+    struct td_stats stats;
+};
+
+// batch is the fixed size or the adaptive starting target (clamped to 1..mmio_batch_capacity())
+void td_init(struct td_dispatcher *d, enum td_policy policy, unsigned batch, uint64_t max_wait_ns);
+int td_submit(struct td_dispatcher *d, uint32_t word);     // 0=staged, -1=staging ring full (td_poll first)
+unsigned td_poll(struct td_dispatcher *d);                 // pushes every batch that is due; words accepted
+unsigned td_flush(struct td_dispatcher *d, int timeout_ms); // pushes everything staged; words accepted
+unsigned td_pending(const struct td_dispatcher *d);
+
+#endif // TASK_DISPATCH_H
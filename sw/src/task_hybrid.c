@@ -0,0 +1,64 @@
+// sw/src/task_hybrid.c
+#define _POSIX_C_SOURCE 200809L
+
+#include "task_hybrid.h"
+#include <string.h>
+
+int hq_init(struct hq *q, unsigned capacity, int timeout_ms) {
+    memset(q, 0, sizeof(*q));
+    q->timeout_ms = timeout_ms;
+    return swq_init(&q->overflow, SWQ_SPSC, capacity);
+}
+
+void hq_destroy(struct hq *q) {
+    swq_destroy(&q->overflow);
+}
+
+unsigned hq_parked(struct hq *q) {
+    return q->carry_n + swq_occupancy(&q->overflow);
+}
+
+unsigned hq_drain(struct hq *q) {
+    unsigned moved = 0;
+    unsigned cap = mmio_batch_capacity();
+    while (q->carry_n > 0 || swq_is_valid(&q->overflow)) {
+        uint32_t credits = mmio_credits();
+        if (credits == 0) break;
+        unsigned want = credits < cap ? credits : cap;
+        while (q->carry_n < want && swq_pop(&q->overflow, &q->carry[q->carry_n]) == 0) q->carry_n++;
+
+        unsigned n = q->carry_n < want ? q->carry_n : want;
+        unsigned acc = 0;
+        int r = mmio_push_batch(q->carry, n, &acc, q->timeout_ms);
+        q->stats.drain_batches++;
+        // refused words stay at the front of carry
+        memmove(q->carry, q->carry + acc, (q->carry_n - acc) * sizeof(q->carry[0]));
+        q->carry_n -= acc;
+        q->stats.drained += acc;
+        moved += acc;
+        if (r != 0) break;
+    }
+    return moved;
+}
+
+int hq_push(struct hq *q, uint32_t value) {
+    if (hq_parked(q) > 0) hq_drain(q);
+    if (hq_parked(q) == 0 && !mmio_is_full()) {
+        int r = mmio_push(value, q->timeout_ms);
+        if (r == 0) {
+            q->stats.pushed++;
+            q->stats.direct++;
+            return 0;
+        }
+        if (r < -1) return r;   // timed out, or stalled with the task maybe in the FIFO
+    }
+    if (swq_push(&q->overflow, value) != 0) {
+        q->stats.overflow_full++;
+        return -1;
+    }
+    q->stats.pushed++;
+    q->stats.parked++;
+    unsigned parked = hq_parked(q);
+    if (parked > q->stats.peak_parked) q->stats.peak_parked = parked;
+    return 1;
+}
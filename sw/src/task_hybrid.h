@@ -0,0 +1,44 @@
+// sw/src/task_hybrid.h
+// Hybrid push path: the hardware queue first, a software ring behind it. A task
+// the FIFO cannot take (STATUS FULL, or a refused push) is parked in an
+// SWQ_SPSC ring (sw_queue.h) instead of being dropped or retried in a spin;
+// hq_drain() moves parked tasks into the FIFO in credit-sized batches while
+// CREDITS shows room. Once anything is parked, new tasks queue behind it until
+// the ring is empty again, so tasks reach the hardware in hq_push() order.
+//
+// A struct hq belongs to one leader thread: hq_push() and hq_drain() must be
+// called from the same thread.
+#ifndef TASK_HYBRID_H
+#define TASK_HYBRID_H
+
+#include "sw_queue.h"
+#include "task_queue_mmio.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+struct hq_stats {
+    unsigned long pushed;           // hq_push calls that took the task
+    unsigned long direct;           // went straight into the FIFO
+    unsigned long parked;           // went to the software ring
+    unsigned long drained;          // moved from the ring into the FIFO
+    unsigned long drain_batches;    // batch handshakes issued by hq_drain
+    unsigned long overflow_full;    // hq_push refused: ring full too
+    unsigned peak_parked;
+};
+
+struct hq {
+    struct swq overflow;
+    // words taken off the ring but not yet accepted by the FIFO; they go first
+    uint32_t carry[MMIO_BATCH_MAX];
+    unsigned carry_n;
+    int timeout_ms;
+    struct hq_stats stats;
+};
+
+int hq_init(struct hq *q, unsigned capacity, int timeout_ms); // ring capacity rounded up to a power of 2; 0=success, -1=no memory
+void hq_destroy(struct hq *q);
+int hq_push(struct hq *q, uint32_t value);  // 0=in the FIFO, 1=parked, -1=ring full (not taken), -2=timeout, -4=bridge stalled
+unsigned hq_drain(struct hq *q);            // parked tasks moved into the FIFO
+unsigned hq_parked(struct hq *q);           // tasks still waiting on the host
+
+#endif // TASK_HYBRID_H
@@ -0,0 +1,273 @@
+// sw/src/task_queue_co.hpp
+// C++20 coroutine front end for the MMIO driver. A leader stream is a coroutine
+// returning tq::Task that co_awaits queue operations instead of blocking on
+// their ACKs:
+//
+//     tq::Task stream(tq::Poller &p, uint32_t id) {
+//         while (co_await p.push(id) == -1) {}       // 0 / -1 refused / -2 timeout
+//         tq::PopResult r = co_await p.pop();        // {rc, value}
+//         mmio_completion c = co_await p.done(id);   // follower finished id
+//     }
+//
+// One Poller runs all streams on the calling thread. Each poll() pass reaps the
+// ACK of the push and the pop in flight (mmio_push_poll / mmio_pop_poll), issues
+// the next waiting request of each kind, drains the completion ring when
+// completions are awaited, then resumes every stream whose operation finished.
+// The hardware takes one push and one pop at a time, so other streams queue in
+// FIFO order behind them; nothing sleeps, and hundreds of streams can be
+// suspended at once.
+//
+// done() needs dispatch mode with posting (mmio_set_dispatch(true, true, ...)).
+// Completions that arrive before anyone awaits them are kept until claimed.
+#ifndef TASK_QUEUE_CO_HPP
+#define TASK_QUEUE_CO_HPP
+
+#include "task_queue_mmio.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tq {
+
+// Fire-and-forget stream; created suspended and owned by the Poller once spawned.
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> h) : h_(h) {}
+    Task(Task &&o) noexcept : h_(std::exchange(o.h_, {})) {}
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() {
+        if (h_) h_.destroy();
+    }
+    std::coroutine_handle<promise_type> release() { return std::exchange(h_, {}); }
+
+private:
+    std::coroutine_handle<promise_type> h_;
+};
+
+struct PopResult {
+    int rc;             // 0 popped, -1 refused (empty), -2 timeout
+    uint32_t value;
+};
+
+struct PollerStats {
+    uint64_t polls = 0;
+    uint64_t pushes = 0;            // handshakes issued
+    uint64_t pops = 0;
+    uint64_t push_refused = 0;
+    uint64_t pop_refused = 0;
+    uint64_t timeouts = 0;
+    uint64_t completions = 0;
+    uint64_t resumes = 0;
+};
+
+class Poller {
+    struct Op {
+        std::coroutine_handle<> h;
+        uint32_t value = 0;
+        int rc = 0;
+    };
+
+public:
+    struct PushOp : Op {
+        Poller *p;
+        PushOp(Poller *p_, uint32_t v) : p(p_) { this->value = v; }
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            this->h = h;
+            p->push_q_.push_back(this);
+        }
+        int await_resume() const noexcept { return this->rc; }
+    };
+
+    struct PopOp : Op {
+        Poller *p;
+        explicit PopOp(Poller *p_) : p(p_) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            this->h = h;
+            p->pop_q_.push_back(this);
+        }
+        PopResult await_resume() const noexcept { return PopResult{this->rc, this->value}; }
+    };
+
+    struct DoneOp {
+        Poller *p;
+        uint32_t task;
+        mmio_completion c{};
+        std::coroutine_handle<> h;
+        bool await_ready() {
+            auto it = p->early_.find(task);
+            if (it == p->early_.end() || it->second.empty()) return false;
+            c = it->second.front();
+            it->second.pop_front();
+            if (it->second.empty()) p->early_.erase(it);
+            return true;
+        }
+        void await_suspend(std::coroutine_handle<> h_) {
+            h = h_;
+            p->done_w_[task].push_back(this);
+            p->done_waiting_++;
+        }
+        mmio_completion await_resume() const noexcept { return c; }
+    };
+
+    explicit Poller(int timeout_ms = 1000) : timeout_(std::chrono::milliseconds(timeout_ms)) {}
+    Poller(const Poller &) = delete;
+    Poller &operator=(const Poller &) = delete;
+    ~Poller() {
+        for (auto h : live_) h.destroy();
+    }
+
+    PushOp push(uint32_t value) { return PushOp(this, value); }
+    PopOp pop() { return PopOp(this); }
+    DoneOp done(uint32_t task) { return DoneOp{this, task, {}, {}}; }
+
+    void spawn(Task t) {
+        auto h = t.release();
+        live_.push_back(h);
+        ready_.push_back(h);
+    }
+
+    size_t live() const { return live_.size(); }
+    const PollerStats &stats() const { return stats_; }
+
+    // one pass; false once every stream has finished
+    bool poll() {
+        stats_.polls++;
+        reap_push();
+        reap_pop();
+        if (done_waiting_ > 0) reap_completions();
+        if (!push_cur_ && !push_q_.empty()) issue_push();
+        if (!pop_cur_ && !pop_q_.empty()) issue_pop();
+
+        // resuming can queue new operations; they are issued on the next pass
+        std::vector<std::coroutine_handle<>> now;
+        now.swap(ready_);
+        for (auto h : now) {
+            stats_.resumes++;
+            h.resume();
+            if (h.done()) retire(h);
+        }
+        return !live_.empty();
+    }
+
+    void run() {
+        while (poll()) {}
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    void finish(Op *op, int rc) {
+        op->rc = rc;
+        ready_.push_back(op->h);
+    }
+
+    void issue_push() {
+        push_cur_ = push_q_.front();
+        push_q_.pop_front();
+        stats_.pushes++;
+        if (mmio_push_start(push_cur_->value) != 0) {
+            finish(std::exchange(push_cur_, nullptr), -2);
+            return;
+        }
+        push_t0_ = clock::now();
+    }
+
+    void issue_pop() {
+        pop_cur_ = pop_q_.front();
+        pop_q_.pop_front();
+        stats_.pops++;
+        if (mmio_pop_start() != 0) {
+            finish(std::exchange(pop_cur_, nullptr), -2);
+            return;
+        }
+        pop_t0_ = clock::now();
+    }
+
+    void reap_push() {
+        if (!push_cur_) return;
+        int r = mmio_push_poll();
+        if (r == 1) {
+            // past the timeout, withdraw the request; one the bridge already
+            // claimed is waited out so its ACK is not taken for the next push
+            if (clock::now() - push_t0_ < timeout_ || mmio_push_cancel() != 0) return;
+            r = -2;
+            stats_.timeouts++;
+        }
+        if (r == -1) stats_.push_refused++;
+        finish(std::exchange(push_cur_, nullptr), r);
+    }
+
+    void reap_pop() {
+        if (!pop_cur_) return;
+        int r = mmio_pop_poll(&pop_cur_->value);
+        if (r == 1) {
+            if (clock::now() - pop_t0_ < timeout_ || mmio_pop_cancel() != 0) return;
+            r = -2;
+            stats_.timeouts++;
+        }
+        if (r == -1) stats_.pop_refused++;
+        finish(std::exchange(pop_cur_, nullptr), r);
+    }
+
+    void reap_completions() {
+        mmio_completion buf[64];
+        unsigned n = mmio_drain_completions(buf, 64);
+        for (unsigned i = 0; i < n; i++) {
+            stats_.completions++;
+            auto it = done_w_.find(buf[i].task);
+            if (it == done_w_.end()) {
+                early_[buf[i].task].push_back(buf[i]);
+                continue;
+            }
+            DoneOp *op = it->second.front();
+            it->second.pop_front();
+            if (it->second.empty()) done_w_.erase(it);
+            done_waiting_--;
+            op->c = buf[i];
+            ready_.push_back(op->h);
+        }
+    }
+
+    void retire(std::coroutine_handle<> h) {
+        for (size_t i = 0; i < live_.size(); i++) {
+            if (live_[i] == h) {
+                live_[i] = live_.back();
+                live_.pop_back();
+                break;
+            }
+        }
+        h.destroy();
+    }
+
+    clock::duration timeout_;
+    std::vector<std::coroutine_handle<>> live_;
+    std::vector<std::coroutine_handle<>> ready_;
+    std::deque<Op *> push_q_, pop_q_;
+    Op *push_cur_ = nullptr;
+    Op *pop_cur_ = nullptr;
+    clock::time_point push_t0_, pop_t0_;
+    std::unordered_map<uint32_t, std::deque<DoneOp *>> done_w_;
+    std::unordered_map<uint32_t, std::deque<mmio_completion>> early_;
+    size_t done_waiting_ = 0;
+    PollerStats stats_;
+};
+
+} // namespace tq
+
+#endif // TASK_QUEUE_CO_HPP
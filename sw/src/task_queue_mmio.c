@@ -1,5 +1,6 @@
 // sw/src/task_queue_mmio.c
 #define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE   // syscall() for the doorbell futex
 
 #include "task_queue_mmio.h"
 #include <stdio.h>
@@ -12,10 +13,15 @@
 #include <errno.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 static volatile uint8_t *mmio = NULL;
 static size_t mmio_size = 4096;
 static char mmio_path_used[512];
+static struct mmio_stats stats;
 
 // MMIO offsets (must match verilator_main.cpp in sw/sw_hw/)
 enum {
@@ -24,7 +30,63 @@ enum {
     OFF_ACK      = 0x08,   // ack: PUSH_OK(1), PUSH_REFUSED(2), POP_OK(4), POP_REFUSED(8)
     OFF_STATUS   = 0x0C,   // status: FULL(1), VALID(2)
     OFF_DATA_OUT = 0x10,
-    OFF_TB_DONE  = 0x14
+    OFF_TB_DONE  = 0x14,
+    OFF_CREDITS  = 0x18,   // free queue entries
+    OFF_BATCH_LEN = 0x1C,
+    OFF_BATCH_ACC = 0x20,
+    OFF_WM_HIGH  = 0x24,
+    OFF_WM_LOW   = 0x28,
+    OFF_DOORBELL = 0x2C,   // sticky: ROOM(1), DATA(2)
+    OFF_DB_SEQ   = 0x30,   // futex word, bumped on every doorbell
+    OFF_RESIDENCY = 0x34,  // cycles the last popped task was queued
+    OFF_DATA_TS  = 0x38,   // push cycle of the last popped task
+    OFF_BRIDGE_CPU  = 0x3C, // CPU the bridge last ran on, plus one (0: not reported)
+    OFF_DESC_WORDS  = 0x40, // descriptor size in 32-bit words
+    OFF_DATA_IN_HI  = 0x44, // descriptor words 1..7 to push
+    OFF_BRIDGE_MODE = 0x60, // PINNED(1), BUSY_POLL(2)
+    OFF_DATA_OUT_HI = 0x64, // descriptor words 1..7 popped
+    OFF_SPILL_CTRL = 0x80, // ENABLE(1)
+    OFF_SPILL_OCC  = 0x84, // descriptors waiting in the spill ring
+    OFF_SPILLED    = 0x88,
+    OFF_REFILLED   = 0x8C,
+    OFF_SPILL_CAP  = 0x90,
+    OFF_RELEASE    = 0x94, // release cycle for PUSH_AT
+    OFF_TIMER_NOW  = 0x98,
+    OFF_TIMER_PEND = 0x9C, // delayed tasks held in the timer wheel
+    OFF_TIMER_HORIZON = 0xA0,
+    OFF_DISPATCH_CTRL = 0xA4, // ENABLE(1), POST(2)
+    OFF_FOLLOWER_SVC  = 0xA8,
+    OFF_NUM_FOLLOWERS = 0xAC,
+    OFF_CQ_TAIL  = 0xB0,   // completions written by the bridge (free-running)
+    OFF_CQ_HEAD  = 0xB4,   // completions consumed by the host (free-running)
+    OFF_CQ_SLOTS = 0xB8,
+    OFF_NUM_LANES = 0xBC,
+    OFF_FOLLOWER_DONE = 0xC0, // per follower, up to MMIO_FOLLOWER_REGS
+    OFF_FOLLOWER_LAST = 0xE0,
+    OFF_BATCH_WIN = 0x100, // MMIO_BATCH_MAX words
+    OFF_PERF_SEQ  = 0x200, // seqlock over the perf block: odd while updating
+    OFF_PERF_CTRL = 0x204, // CLEAR(1)
+    OFF_PERF      = 0x208, // CYCLES(2 words), PUSHES, POPS, PUSH_REFUSED, POP_REFUSED,
+                           // FULL_CYCLES, EMPTY_CYCLES, OCC_SUM(2 words), MAX_OCC
+    OFF_JOIN_SLOT   = 0x240,
+    OFF_JOIN_COUNT  = 0x244,
+    OFF_JOIN_ACTIVE = 0x248,
+    OFF_JOIN_SLOTS  = 0x24C,
+    OFF_HEAD_SEQ    = 0x250, // head mirror: pops so far (31:1), VALID (0)
+    OFF_HEAD_DATA   = 0x254,
+    OFF_POP_COMMIT  = 0x258, // head entries taken by the host (free-running)
+    OFF_CQ_RING   = 0x400, // CQ_SLOTS entries of {task, follower}
+    OFF_LANES     = 0x800, // NUM_LANES blocks of LANE_STRIDE bytes
+    LANE_STRIDE   = 0x20,
+    L_CTRL = 0x00, L_DATA_IN = 0x04, L_ACK = 0x08, L_DATA_OUT = 0x0C, L_OWNER = 0x10
+};
+
+// ctrl / ack bits beyond the single-word handshake
+enum {
+    CTRL_PUSH_BATCH = 0x4,
+    CTRL_PUSH_AT    = 0x8,
+    CTRL_JOIN_REG   = 0x10,
+    ACK_BATCH_DONE  = 0x10
 };
 
 static inline uint32_t read32(size_t off) {
@@ -39,6 +101,15 @@ static inline void write32(size_t off, uint32_t v) {
     memcpy(dst, &v, sizeof(v));
 }
 
+// descriptor width advertised by the bridge, and whether DATA_IN_HI may hold
+// words of an earlier descriptor that a plain 32-bit push must clear
+static unsigned desc_words = 1;
+static bool hi_dirty = false;
+
+static inline volatile uint32_t *db_seq_word(void) {
+    return (volatile uint32_t *)(mmio + OFF_DB_SEQ);
+}
+
 // small sleep in milliseconds using nanosleep
 static void sleep_ms(int ms) {
     struct timespec ts;
@@ -47,6 +118,48 @@ static void sleep_ms(int ms) {
     nanosleep(&ts, NULL);
 }
 
+static bool busy_poll = false;
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Pause between two polls of a blocking call and charge it to timeout_ms;
+// false once the timeout is used up. By default each pause sleeps 1 ms; in
+// busy-poll mode it is a CPU pause hint and the timeout runs on the clock.
+struct poll_wait {
+    int waited_ms;
+    uint64_t start_ns;
+};
+
+static bool poll_pause(struct poll_wait *w, int timeout_ms) {
+    if (busy_poll) {
+        uint64_t now = mono_ns();
+        if (w->start_ns == 0) w->start_ns = now;
+        cpu_relax();
+        return now - w->start_ns < (uint64_t)timeout_ms * 1000000ull;
+    }
+    sleep_ms(1);
+    return ++w->waited_ms < timeout_ms;
+}
+
+// Head mirror: spec_taken is the POP_COMMIT value last written. Until the
+// bridge's pop count in HEAD_SEQ reaches it, the mirror still shows the entry
+// this consumer has already taken.
+#define HEAD_IDX_MASK 0x7FFFFFFFu
+static uint32_t spec_taken = 0;
+static bool spec_pending = false;
+
 int mmio_init(const char *path) {
     const char *p = path ? path : MMIO_DEFAULT_PATH;
 
@@ -63,8 +176,14 @@ int mmio_init(const char *path) {
         return -1;
     }
 
+    uint32_t dw = read32(OFF_DESC_WORDS);
+    desc_words = (dw >= 1 && dw <= MMIO_DESC_MAX_WORDS) ? dw : 1;
+    hi_dirty = desc_words > 1;
+
     strncpy(mmio_path_used, p, sizeof(mmio_path_used) - 1);
     mmio_path_used[sizeof(mmio_path_used) - 1] = '\0';
+    memset(&stats, 0, sizeof(stats));
+    spec_pending = false;
     return 0;
 }
 
@@ -75,74 +194,698 @@ void mmio_close(void) {
     }
 }
 
-// return 0 success, -1 refused, -2 timeout
+static void clear_hi_words(void) {
+    if (!hi_dirty) return;
+    for (unsigned i = 1; i < desc_words; i++) write32(OFF_DATA_IN_HI + 4 * (i - 1), 0);
+    hi_dirty = false;
+}
+
+static int push_word0(uint32_t value, uint32_t ctrl_bit, int timeout_ms);
+
+// return 0 success, -1 refused, -2 timeout, -4 bridge stalled
 int mmio_push(uint32_t value, int timeout_ms) {
     if (!mmio) return -2;
+    clear_hi_words();
+    return push_word0(value, 0x1, timeout_ms);
+}
+
+// return 0 success, -1 refused, -2 timeout, -3 descriptor wider than the hardware, -4 bridge stalled
+int mmio_push_desc(const uint32_t *words, unsigned nwords, int timeout_ms) {
+    if (!mmio) return -2;
+    if (nwords == 0 || nwords > desc_words) return -3;
+    for (unsigned i = 1; i < desc_words; i++) {
+        write32(OFF_DATA_IN_HI + 4 * (i - 1), i < nwords ? words[i] : 0);
+    }
+    hi_dirty = true;
+    return push_word0(words[0], 0x1, timeout_ms);
+}
+
+// return 0 success, -1 refused, -2 timeout, -3 buffer narrower than the hardware, -4 bridge stalled
+int mmio_pop_desc(uint32_t *words, unsigned nwords, int timeout_ms) {
+    if (!mmio) return -2;
+    if (nwords < desc_words) return -3;
+    int r = mmio_pop_ts(&words[0], NULL, timeout_ms);
+    if (r != 0) return r;
+    for (unsigned i = 1; i < nwords; i++) {
+        words[i] = i < desc_words ? read32(OFF_DATA_OUT_HI + 4 * (i - 1)) : 0;
+    }
+    return 0;
+}
+
+unsigned mmio_desc_words(void) {
+    return desc_words;
+}
+
+unsigned mmio_batch_capacity(void) {
+    return MMIO_BATCH_MAX / desc_words;
+}
+
+// return 0 success, -1 refused (beyond the horizon or bucket full), -2 timeout, -4 bridge stalled
+int mmio_push_at(uint32_t value, uint32_t release_cycle, int timeout_ms) {
+    if (!mmio) return -2;
+    clear_hi_words();
+    write32(OFF_RELEASE, release_cycle);
+    return push_word0(value, CTRL_PUSH_AT, timeout_ms);
+}
+
+// return 0 success, -1 refused (slot occupied or out of range), -2 timeout, -4 bridge stalled
+int mmio_join_register(unsigned slot, uint32_t count, uint32_t continuation, int timeout_ms) {
+    if (!mmio) return -2;
+    clear_hi_words();
+    write32(OFF_JOIN_SLOT, slot);
+    write32(OFF_JOIN_COUNT, count);
+    return push_word0(continuation, CTRL_JOIN_REG, timeout_ms);
+}
+
+unsigned mmio_join_slots(void) {
+    if (!mmio) return 0;
+    return read32(OFF_JOIN_SLOTS);
+}
+
+uint32_t mmio_join_active(void) {
+    if (!mmio) return 0;
+    return read32(OFF_JOIN_ACTIVE);
+}
+
+// CTRL and ACK are shared with the bridge, and a push and a pop may be in
+// flight together, so both words only change through atomic or/and: the host
+// sets CTRL bits and clears ACK bits, the bridge clears CTRL bits (claiming the
+// request) and sets ACK bits.
+static inline volatile uint32_t *reg(size_t off) {
+    return (volatile uint32_t *)(mmio + off);
+}
+
+static inline void set_ctrl(uint32_t bits) {
+    __atomic_fetch_or(reg(OFF_CTRL), bits, __ATOMIC_RELEASE);   // publishes DATA_IN and friends
+}
+
+static inline uint32_t load_ack(void) {
+    return __atomic_load_n(reg(OFF_ACK), __ATOMIC_ACQUIRE);
+}
+
+static inline void clear_ack(uint32_t bits) {
+    __atomic_fetch_and(reg(OFF_ACK), ~bits, __ATOMIC_RELAXED);
+}
+
+// Withdraw a request: 0 if its CTRL bit was still set (the bridge never saw
+// it, no ACK will come), 1 if the bridge already claimed it.
+static int cancel_request(uint32_t ctrl_bit) {
+    return (__atomic_fetch_and(reg(OFF_CTRL), ~ctrl_bit, __ATOMIC_ACQ_REL) & ctrl_bit) ? 0 : 1;
+}
+
+// How long a timed-out call waits for the ACK of a request the bridge had
+// already claimed; the bridge finishes a claimed request within one pass, so
+// running out means it stalled mid-request and the call returns -4.
+#define SETTLE_MS 1000
+
+static void issue_push(uint32_t value, uint32_t ctrl_bit) {
+    stats.round_trips++;
 
     // write data then set push bit
-    uint32_t ctrl = read32(OFF_CTRL);
     write32(OFF_DATA_IN, value);
-    write32(OFF_CTRL, ctrl | 0x1);
-
-    int waited = 0;
-    const int step_ms = 1;
+    set_ctrl(ctrl_bit);
+}
 
-    while (waited < timeout_ms) {
-        uint32_t ack = read32(OFF_ACK);
-        if (ack & 0x1) {   // PUSH_OK
-            write32(OFF_ACK, ack & ~0x1);
-            return 0;
-        }
-        if (ack & 0x2) {   // PUSH_REFUSED
-            write32(OFF_ACK, ack & ~0x2);
-            return -1;
-        }
-        sleep_ms(step_ms);
-        waited += step_ms;
+// 0 accepted, -1 refused, 1 no ack yet
+static int reap_push(void) {
+    uint32_t ack = load_ack();
+    if (ack & 0x1) {   // PUSH_OK
+        clear_ack(0x1);
+        return 0;
     }
-    return -2;
+    if (ack & 0x2) {   // PUSH_REFUSED
+        clear_ack(0x2);
+        stats.refused_pushes++;
+        return -1;
+    }
+    return 1;
 }
 
-// return 0 success, -1 refused, -2 timeout
-int mmio_pop(uint32_t *out, int timeout_ms) {
+// Timeout of a blocking push: withdraw the request, or if the bridge already
+// took it, wait for its ACK so it is not credited to the next call. -2 means
+// the request is withdrawn, -4 that the bridge claimed it and never answered.
+static int settle_push(uint32_t ctrl_bit) {
+    if (cancel_request(ctrl_bit) == 0) return -2;
+    struct poll_wait w = {0, 0};
+    do {
+        int r = reap_push();
+        if (r <= 0) return r;
+    } while (poll_pause(&w, SETTLE_MS));
+    return -4;
+}
+
+// DATA_IN_HI already holds the upper descriptor words; ctrl_bit is PUSH, PUSH_AT
+// or JOIN_REG, all acked with PUSH_OK / PUSH_REFUSED
+static int push_word0(uint32_t value, uint32_t ctrl_bit, int timeout_ms) {
+    issue_push(value, ctrl_bit);
+
+    struct poll_wait w = {0, 0};
+    do {
+        int r = reap_push();
+        if (r <= 0) return r;
+    } while (poll_pause(&w, timeout_ms));
+    return settle_push(ctrl_bit);
+}
+
+int mmio_push_start(uint32_t value) {
     if (!mmio) return -2;
+    clear_hi_words();
+    issue_push(value, 0x1);
+    return 0;
+}
 
-    uint32_t ctrl = read32(OFF_CTRL);
-    write32(OFF_CTRL, ctrl | 0x2); // set pop_req
+int mmio_push_poll(void) {
+    if (!mmio) return -2;
+    return reap_push();
+}
 
-    int waited = 0;
-    const int step_ms = 1;
+int mmio_push_cancel(void) {
+    if (!mmio) return 0;
+    return cancel_request(0x1);
+}
 
-    while (waited < timeout_ms) {
-        uint32_t ack = read32(OFF_ACK);
-        if (ack & 0x4) { // POP_OK
-            uint32_t data = read32(OFF_DATA_OUT);
-            if (out) *out = data;
-            write32(OFF_ACK, ack & ~0x4);
-            return 0;
-        }
-        if (ack & 0x8) { // POP_REFUSED
-            write32(OFF_ACK, ack & ~0x8);
-            return -1;
-        }
-        sleep_ms(step_ms);
-        waited += step_ms;
+// return 0 success, -1 refused, -2 timeout, -4 bridge stalled
+int mmio_pop(uint32_t *out, int timeout_ms) {
+    return mmio_pop_ts(out, NULL, timeout_ms);
+}
+
+static void issue_pop(void) {
+    stats.round_trips++;
+
+    set_ctrl(0x2); // set pop_req
+}
+
+// 0 popped, -1 refused, 1 no ack yet
+static int reap_pop(uint32_t *out, uint32_t *residency) {
+    uint32_t ack = load_ack();
+    if (ack & 0x4) { // POP_OK
+        uint32_t data = read32(OFF_DATA_OUT);
+        if (out) *out = data;
+        if (residency) *residency = read32(OFF_RESIDENCY);
+        clear_ack(0x4);
+        return 0;
     }
-    return -2;
+    if (ack & 0x8) { // POP_REFUSED
+        clear_ack(0x8);
+        stats.refused_pops++;
+        return -1;
+    }
+    return 1;
+}
+
+// return 0 success, -1 refused, -2 timeout, -4 bridge stalled
+int mmio_pop_ts(uint32_t *out, uint32_t *residency, int timeout_ms) {
+    if (!mmio) return -2;
+
+    issue_pop();
+
+    struct poll_wait w = {0, 0};
+    do {
+        int r = reap_pop(out, residency);
+        if (r <= 0) return r;
+    } while (poll_pause(&w, timeout_ms));
+
+    // withdraw the pop, or take the word the bridge already popped for it
+    if (cancel_request(0x2) == 0) return -2;
+    w = (struct poll_wait){0, 0};
+    do {
+        int r = reap_pop(out, residency);
+        if (r <= 0) return r;
+    } while (poll_pause(&w, SETTLE_MS));
+    return -4;
+}
+
+int mmio_pop_start(void) {
+    if (!mmio) return -2;
+    issue_pop();
+    return 0;
+}
+
+int mmio_pop_poll(uint32_t *out) {
+    if (!mmio) return -2;
+    return reap_pop(out, NULL);
+}
+
+int mmio_pop_cancel(void) {
+    if (!mmio) return 0;
+    return cancel_request(0x2);
 }
 
 bool mmio_is_full(void) {
     if (!mmio) return true;
+    stats.status_reads++;
     uint32_t st = read32(OFF_STATUS);
     return (st & 0x1) != 0;
 }
 
 bool mmio_is_valid(void) {
     if (!mmio) return false;
+    stats.status_reads++;
     uint32_t st = read32(OFF_STATUS);
     return (st & 0x2) != 0;
 }
 
+uint32_t mmio_credits(void) {
+    if (!mmio) return 0;
+    stats.status_reads++;
+    return read32(OFF_CREDITS);
+}
+
+// return 0 all n accepted, -1 some words refused or beyond the batch capacity
+// (only the first mmio_batch_capacity() are sent), -2 timeout, -4 bridge stalled
+int mmio_push_batch(const uint32_t *values, unsigned n, unsigned *accepted, int timeout_ms) {
+    if (accepted) *accepted = 0;
+    if (!mmio) return -2;
+    if (n == 0) return 0;
+    unsigned asked = n;
+    if (n > mmio_batch_capacity()) n = mmio_batch_capacity();
+
+    stats.round_trips++;
+
+    // one descriptor per DESC_WORDS words; 32-bit tasks are zero-extended
+    for (unsigned i = 0; i < n; i++) {
+        write32(OFF_BATCH_WIN + 4 * desc_words * i, values[i]);
+        for (unsigned w = 1; w < desc_words; w++) write32(OFF_BATCH_WIN + 4 * (desc_words * i + w), 0);
+    }
+    write32(OFF_BATCH_LEN, n);
+    set_ctrl(CTRL_PUSH_BATCH);
+
+    // on timeout, withdraw the batch or wait out the one the bridge is serving
+    struct poll_wait w = {0, 0};
+    bool settling = false;
+    for (;;) {
+        uint32_t ack = load_ack();
+        if (ack & ACK_BATCH_DONE) {
+            uint32_t acc = read32(OFF_BATCH_ACC);
+            clear_ack(ACK_BATCH_DONE);
+            if (accepted) *accepted = acc;
+            stats.refused_pushes += n - acc;
+            return (acc == asked) ? 0 : -1;
+        }
+        if (poll_pause(&w, settling ? SETTLE_MS : timeout_ms)) continue;
+        if (settling) return -4;
+        if (cancel_request(CTRL_PUSH_BATCH) == 0) return -2;
+        settling = true;
+        w = (struct poll_wait){0, 0};
+    }
+}
+
+// Push all n words, each batch sized from the advertised credits; words refused
+// because something else took the room first go out in the next batch. Waits
+// (polling CREDITS) while the queue is full.
+// Returns the number of words pushed; less than n only on timeout.
+int mmio_push_credited(const uint32_t *values, unsigned n, int timeout_ms) {
+    if (!mmio) return 0;
+
+    unsigned done = 0;
+    struct poll_wait w = {0, 0};
+
+    while (done < n) {
+        uint32_t credits = mmio_credits();
+        if (credits == 0) {
+            if (!poll_pause(&w, timeout_ms)) break;
+            continue;
+        }
+        unsigned batch = n - done;
+        if (batch > credits) batch = credits;
+        if (batch > mmio_batch_capacity()) batch = mmio_batch_capacity();
+
+        unsigned acc = 0;
+        int r = mmio_push_batch(values + done, batch, &acc, timeout_ms);
+        done += acc;
+        if (r < -1) break;
+    }
+    return (int)done;
+}
+
+int mmio_set_watermarks(uint32_t high, uint32_t low) {
+    if (!mmio) return -1;
+    if (low > high) return -1;
+    write32(OFF_WM_LOW, low);
+    write32(OFF_WM_HIGH, high);
+    return 0;
+}
+
+bool mmio_is_almost_full(void) {
+    if (!mmio) return true;
+    stats.status_reads++;
+    return (read32(OFF_STATUS) & 0x4) != 0;
+}
+
+bool mmio_is_almost_empty(void) {
+    if (!mmio) return true;
+    stats.status_reads++;
+    return (read32(OFF_STATUS) & 0x8) != 0;
+}
+
+uint32_t mmio_doorbell_seq(void) {
+    if (!mmio) return 0;
+    return __atomic_load_n(db_seq_word(), __ATOMIC_ACQUIRE);
+}
+
+// Park until one of the doorbell bits in mask is set, then clear them.
+// seen_seq is a DB_SEQ value read before the caller decided to wait (e.g. before
+// a refused op): if the bridge rang in between, the futex wait returns at once,
+// so no wakeup is lost. return 0 rang, -2 timeout
+int mmio_wait_doorbell(uint32_t mask, uint32_t seen_seq, int timeout_ms) {
+    if (!mmio) return -2;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    for (;;) {
+        // clear only our bits, atomically: the bridge may set the other one meanwhile
+        uint32_t db = __atomic_fetch_and(reg(OFF_DOORBELL), ~mask, __ATOMIC_ACQ_REL);
+        if (db & mask) return 0;
+
+        struct timespec now, rel;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        rel.tv_sec = deadline.tv_sec - now.tv_sec;
+        rel.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+        if (rel.tv_nsec < 0) {
+            rel.tv_sec--;
+            rel.tv_nsec += 1000000000L;
+        }
+        if (rel.tv_sec < 0) return -2;
+        if (busy_poll) {
+            // spin on the doorbell word itself; never enter the kernel
+            cpu_relax();
+            continue;
+        }
+
+        stats.doorbell_waits++;
+        // shared (non-private) futex: the bridge process wakes it through its own mapping
+        syscall(SYS_futex, (uint32_t *)db_seq_word(), FUTEX_WAIT, seen_seq, &rel, NULL, 0);
+        seen_seq = mmio_doorbell_seq();
+    }
+}
+
+// milliseconds left until deadline_ns, 0 once it has passed
+static int ms_left(uint64_t deadline_ns) {
+    uint64_t now = mono_ns();
+    return now < deadline_ns ? (int)((deadline_ns - now + 999999) / 1000000) : 0;
+}
+
+// Push, parking on the ROOM doorbell instead of retrying while the queue is full.
+// timeout_ms covers the whole call: a doorbell whose room someone else takes
+// first does not restart it. return 0 success, -2 timeout, -4 bridge stalled
+int mmio_push_wait(uint32_t value, int timeout_ms) {
+    uint64_t deadline = mono_ns() + (uint64_t)timeout_ms * 1000000ull;
+    for (;;) {
+        uint32_t seq = mmio_doorbell_seq();
+        int r = mmio_push(value, ms_left(deadline));
+        if (r != -1) return r;
+        int left = ms_left(deadline);
+        if (left == 0 || mmio_wait_doorbell(MMIO_DOORBELL_ROOM, seq, left) != 0) return -2;
+    }
+}
+
+// Pop, parking on the DATA doorbell instead of retrying while the queue is empty.
+// Same deadline as mmio_push_wait(). return 0 success, -2 timeout, -4 bridge stalled
+int mmio_pop_wait(uint32_t *out, int timeout_ms) {
+    uint64_t deadline = mono_ns() + (uint64_t)timeout_ms * 1000000ull;
+    for (;;) {
+        uint32_t seq = mmio_doorbell_seq();
+        int r = mmio_pop(out, ms_left(deadline));
+        if (r != -1) return r;
+        int left = ms_left(deadline);
+        if (left == 0 || mmio_wait_doorbell(MMIO_DOORBELL_DATA, seq, left) != 0) return -2;
+    }
+}
+
+void mmio_get_stats(struct mmio_stats *out) {
+    if (out) *out = stats;
+}
+
+void mmio_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+#define PERF_WORDS 11
+
+int mmio_read_perf(struct mmio_perf *out) {
+    if (!mmio || !out) return -1;
+    volatile uint32_t *seq = (volatile uint32_t *)(mmio + OFF_PERF_SEQ);
+    uint32_t w[PERF_WORDS];
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint32_t s0 = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (s0 & 1) continue;
+        for (int i = 0; i < PERF_WORDS; i++) w[i] = read32(OFF_PERF + 4 * i);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(seq, __ATOMIC_RELAXED) != s0) continue;
+
+        out->cycles = (uint64_t)w[1] << 32 | w[0];
+        out->pushes = w[2];
+        out->pops = w[3];
+        out->push_refused = w[4];
+        out->pop_refused = w[5];
+        out->full_cycles = w[6];
+        out->empty_cycles = w[7];
+        out->occ_sum = (uint64_t)w[9] << 32 | w[8];
+        out->max_occ = w[10];
+        return 0;
+    }
+    return -2;
+}
+
+void mmio_clear_perf(void) {
+    if (mmio) write32(OFF_PERF_CTRL, 0x1);
+}
+
+int mmio_set_spill(bool enable) {
+    if (!mmio) return -1;
+    write32(OFF_SPILL_CTRL, enable ? 0x1 : 0x0);
+    return 0;
+}
+
+bool mmio_is_spilling(void) {
+    if (!mmio) return false;
+    stats.status_reads++;
+    return (read32(OFF_STATUS) & 0x10) != 0;
+}
+
+int mmio_get_spill_stats(struct mmio_spill_stats *out) {
+    if (!mmio || !out) return -1;
+    out->occupancy = read32(OFF_SPILL_OCC);
+    out->capacity = read32(OFF_SPILL_CAP);
+    out->spilled = read32(OFF_SPILLED);
+    out->refilled = read32(OFF_REFILLED);
+    return 0;
+}
+
+uint32_t mmio_timer_now(void) {
+    if (!mmio) return 0;
+    return read32(OFF_TIMER_NOW);
+}
+
+uint32_t mmio_timer_pending(void) {
+    if (!mmio) return 0;
+    return read32(OFF_TIMER_PEND);
+}
+
+uint32_t mmio_timer_horizon(void) {
+    if (!mmio) return 0;
+    return read32(OFF_TIMER_HORIZON);
+}
+
+int mmio_set_dispatch(bool enable, bool post_completions, uint32_t service_cycles) {
+    if (!mmio) return -1;
+    write32(OFF_FOLLOWER_SVC, service_cycles);
+    write32(OFF_DISPATCH_CTRL, (enable ? 0x1 : 0) | (enable && post_completions ? 0x2 : 0));
+    return 0;
+}
+
+unsigned mmio_num_followers(void) {
+    if (!mmio) return 0;
+    return read32(OFF_NUM_FOLLOWERS);
+}
+
+// copy everything available (up to max) out of the ring, then free the slots
+// with a single CQ_HEAD store
+unsigned mmio_drain_completions(struct mmio_completion *out, unsigned max) {
+    if (!mmio) return 0;
+    volatile uint32_t *tail_w = (volatile uint32_t *)(mmio + OFF_CQ_TAIL);
+    volatile uint32_t *head_w = (volatile uint32_t *)(mmio + OFF_CQ_HEAD);
+    uint32_t tail = __atomic_load_n(tail_w, __ATOMIC_ACQUIRE);
+    uint32_t head = *head_w;
+    uint32_t slots = read32(OFF_CQ_SLOTS);
+    unsigned n = 0;
+    if (slots == 0) return 0;
+    for (; head != tail && n < max; head++, n++) {
+        size_t off = OFF_CQ_RING + 8 * (head % slots);
+        out[n].task = read32(off);
+        out[n].follower = read32(off + 4);
+    }
+    if (n) {
+        __atomic_store_n(head_w, head, __ATOMIC_RELEASE);
+        stats.completions += n;
+    }
+    return n;
+}
+
+int mmio_follower_status(unsigned follower, uint32_t *done, uint32_t *last_task) {
+    if (!mmio || follower >= MMIO_FOLLOWER_REGS) return -1;
+    *done = __atomic_load_n((volatile uint32_t *)(mmio + OFF_FOLLOWER_DONE + 4 * follower), __ATOMIC_ACQUIRE);
+    if (last_task) *last_task = read32(OFF_FOLLOWER_LAST + 4 * follower);
+    return 0;
+}
+
+static inline volatile uint32_t *lane_word(unsigned lane, size_t reg) {
+    return (volatile uint32_t *)(mmio + OFF_LANES + LANE_STRIDE * lane + reg);
+}
+
+unsigned mmio_num_lanes(void) {
+    if (!mmio) return 0;
+    uint32_t n = read32(OFF_NUM_LANES);
+    return n > MMIO_MAX_LANES ? MMIO_MAX_LANES : n;
+}
+
+// claim the first free lane; OWNER is shared by every process mapping the region
+int mmio_lane_open(void) {
+    unsigned n = mmio_num_lanes();
+    uint32_t me = (uint32_t)getpid();
+    for (unsigned i = 0; i < n; i++) {
+        uint32_t expect = 0;
+        if (__atomic_compare_exchange_n(lane_word(i, L_OWNER), &expect, me, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            __atomic_store_n(lane_word(i, L_ACK), 0u, __ATOMIC_RELAXED);
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// leave nothing behind for the next owner: no request, no ACK
+void mmio_lane_close(int lane) {
+    if (!mmio || lane < 0 || (unsigned)lane >= mmio_num_lanes()) return;
+    __atomic_store_n(lane_word(lane, L_CTRL), 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(lane_word(lane, L_ACK), 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(lane_word(lane, L_OWNER), 0u, __ATOMIC_RELEASE);
+}
+
+// 0 done (PUSH_OK / POP_OK), -1 refused, 1 no ack yet
+static int lane_reap(int lane, uint32_t *out) {
+    uint32_t ack = __atomic_load_n(lane_word(lane, L_ACK), __ATOMIC_ACQUIRE);
+    if (!ack) return 1;
+    if ((ack & 0x4) && out) *out = *lane_word(lane, L_DATA_OUT);
+    __atomic_store_n(lane_word(lane, L_ACK), 0u, __ATOMIC_RELAXED);
+    return (ack & 0x5) ? 0 : -1;
+}
+
+// One handshake on a lane. The lane belongs to the caller, so ACK is written
+// outright; DATA_IN is published by the release store of CTRL, DATA_OUT by the
+// bridge's release store of ACK. The bridge claims CTRL with a compare-and-swap
+// to 0, and a timed-out call withdraws it the same way, so exactly one side
+// wins; if the bridge did, its ACK is waited out as in settle_push().
+static int lane_op(int lane, uint32_t req, uint32_t value, uint32_t *out, int timeout_ms) {
+    if (!mmio || lane < 0 || (unsigned)lane >= mmio_num_lanes()) return -2;
+    __atomic_store_n(lane_word(lane, L_DATA_IN), value, __ATOMIC_RELAXED);
+    __atomic_store_n(lane_word(lane, L_CTRL), req, __ATOMIC_RELEASE);
+
+    struct poll_wait w = {0, 0};
+    do {
+        int r = lane_reap(lane, out);
+        if (r <= 0) return r;
+    } while (poll_pause(&w, timeout_ms));
+
+    uint32_t expect = req;
+    if (__atomic_compare_exchange_n(lane_word(lane, L_CTRL), &expect, 0u, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return -2;
+    }
+    w = (struct poll_wait){0, 0};
+    do {
+        int r = lane_reap(lane, out);
+        if (r <= 0) return r;
+    } while (poll_pause(&w, SETTLE_MS));
+    return -4;
+}
+
+int mmio_lane_push(int lane, uint32_t value, int timeout_ms) {
+    return lane_op(lane, 0x1, value, NULL, timeout_ms);
+}
+
+int mmio_lane_pop(int lane, uint32_t *out, int timeout_ms) {
+    return lane_op(lane, 0x2, 0, out, timeout_ms);
+}
+
+// seqlock-style read of the mirror: 0=*out is the head entry *idx, -1=empty,
+// 1=our last take is not retired yet or the head moved while we read it
+static int head_read(uint32_t *out, uint32_t *idx) {
+    volatile uint32_t *seq = (volatile uint32_t *)(mmio + OFF_HEAD_SEQ);
+    uint32_t s0 = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    *idx = s0 >> 1;
+    if (spec_pending) {
+        uint32_t behind = (spec_taken - *idx) & HEAD_IDX_MASK;
+        if (behind != 0 && behind <= HEAD_IDX_MASK / 2) return 1;
+        spec_pending = false;
+    }
+    if (!(s0 & 0x1)) return -1;
+    uint32_t v = read32(OFF_HEAD_DATA);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(seq, __ATOMIC_RELAXED) != s0) return 1;
+    *out = v;
+    return 0;
+}
+
+int mmio_head_peek(uint32_t *out) {
+    if (!mmio) return -2;
+    uint32_t v, idx;
+    int r = head_read(&v, &idx);
+    if (r == 0 && out) *out = v;
+    return r;
+}
+
+int mmio_pop_spec(uint32_t *out, int timeout_ms) {
+    if (!mmio) return -2;
+    uint64_t start = 0;
+    for (;;) {
+        uint32_t v, idx;
+        int r = head_read(&v, &idx);
+        if (r == 0) {
+            // take it: one release store, the bridge pops it on its next pass
+            spec_taken = (idx + 1) & HEAD_IDX_MASK;
+            spec_pending = true;
+            __atomic_store_n((volatile uint32_t *)(mmio + OFF_POP_COMMIT), spec_taken, __ATOMIC_RELEASE);
+            stats.head_takes++;
+            if (out) *out = v;
+            return 0;
+        }
+        if (r < 0) return -1;
+        // a take retires within one bridge pass, so yield rather than sleep 1 ms
+        stats.head_waits++;
+        uint64_t now = mono_ns();
+        if (start == 0) start = now;
+        if (now - start >= (uint64_t)timeout_ms * 1000000ull) return -2;
+        if (busy_poll) cpu_relax();
+        else sched_yield();
+    }
+}
+
+void mmio_set_busy_poll(bool enable) {
+    busy_poll = enable;
+}
+
+bool mmio_busy_poll(void) {
+    return busy_poll;
+}
+
+int mmio_bridge_cpu(uint32_t *mode) {
+    if (!mmio) return -1;
+    if (mode) *mode = read32(OFF_BRIDGE_MODE);
+    return (int)read32(OFF_BRIDGE_CPU) - 1;
+}
+
+void mmio_signal_done(void) {
+    if (mmio) write32(OFF_TB_DONE, 1);
+}
+
 void mmio_write_log_header(FILE *f) {
     time_t now = time(NULL);
     char buf[64];
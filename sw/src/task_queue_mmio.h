@@ -12,17 +12,200 @@
 #define MMIO_DEFAULT_PATH "sw_hw/mmio_region.bin"
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // API
 int mmio_init(const char *path);   // map mmio file (path may be NULL to use default)
 void mmio_close(void);
 
-int mmio_push(uint32_t value, int timeout_ms); // 0=success, -1=refused, -2=timeout
-int mmio_pop(uint32_t *out, int timeout_ms);   // 0=success, -1=refused, -2=timeout
+int mmio_push(uint32_t value, int timeout_ms); // 0=success, -1=refused, -2=timeout, -4=bridge stalled
+int mmio_pop(uint32_t *out, int timeout_ms);   // 0=success, -1=refused, -2=timeout, -4=bridge stalled
+// On timeout a blocking call withdraws its request, and -2 means the operation
+// did not happen. If the bridge had already claimed it, the call waits for
+// that ACK instead and returns its result; -4 means no ACK came even then, so
+// the bridge stalled mid-request and the outcome is unknown (a push may still
+// land, a popped word is lost). The other blocking calls below do the same.
+// Pop that also returns the task's queue residency in cycles (0 when the
+// hardware is built with QUEUE_TIMESTAMPS=0). residency may be NULL.
+int mmio_pop_ts(uint32_t *out, uint32_t *residency, int timeout_ms);
+
+// Wide descriptors: the hardware queue holds mmio_desc_words() 32-bit words per
+// entry (TASK_WIDTH / 32, up to MMIO_DESC_MAX_WORDS). A descriptor is pushed or
+// popped in one handshake. mmio_push() zero-extends a 32-bit task and
+// mmio_pop() returns word 0 only.
+#define MMIO_DESC_MAX_WORDS 8
+unsigned mmio_desc_words(void);
+int mmio_push_desc(const uint32_t *words, unsigned nwords, int timeout_ms); // 0=success, -1=refused, -2=timeout, -3=too wide, -4=bridge stalled
+int mmio_pop_desc(uint32_t *words, unsigned nwords, int timeout_ms);       // nwords >= mmio_desc_words(); 0=success, -1=refused, -2=timeout, -3=buffer too small, -4=bridge stalled
 
 bool mmio_is_full(void);
 bool mmio_is_valid(void);
 
+// Credit-based pushes: CREDITS is the number of free queue entries as of the
+// bridge's last pass. It is a hint: timer releases, join releases and lane
+// pushes also enter the queue, so a batch sized from it can still be partly
+// refused.
+#define MMIO_BATCH_MAX 64
+uint32_t mmio_credits(void);
+unsigned mmio_batch_capacity(void); // tasks per batch: MMIO_BATCH_MAX / mmio_desc_words()
+// mmio_push_batch() sends at most mmio_batch_capacity() words and returns -1
+// unless all n were accepted; *accepted (the leading words taken) is
+// authoritative, and the caller resends values[*accepted..n-1].
+int mmio_push_batch(const uint32_t *values, unsigned n, unsigned *accepted, int timeout_ms); // 0=all accepted, -1=some refused or n too large, -2=timeout, -4=bridge stalled
+int mmio_push_credited(const uint32_t *values, unsigned n, int timeout_ms); // pushes all n in credit-sized batches; returns words pushed
+
+// Watermarks and doorbells. The bridge rings ROOM when occupancy falls below
+// the high watermark and DATA when it rises above the low watermark, bumping a
+// futex word so parked callers wake without polling.
+#define MMIO_DOORBELL_ROOM 0x1
+#define MMIO_DOORBELL_DATA 0x2
+int mmio_set_watermarks(uint32_t high, uint32_t low);
+bool mmio_is_almost_full(void);
+bool mmio_is_almost_empty(void);
+int mmio_wait_doorbell(uint32_t mask, uint32_t seen_seq, int timeout_ms); // 0=rang, -2=timeout
+uint32_t mmio_doorbell_seq(void);
+int mmio_push_wait(uint32_t value, int timeout_ms); // parks while full; 0=success, -2=timeout, -4=bridge stalled
+int mmio_pop_wait(uint32_t *out, int timeout_ms);   // parks while empty; 0=success, -2=timeout, -4=bridge stalled
+
+// Handshake statistics since mmio_init() or mmio_reset_stats()
+struct mmio_stats {
+    unsigned long round_trips;      // CTRL/ACK handshakes issued
+    unsigned long refused_pushes;   // words refused by the hardware
+    unsigned long refused_pops;
+    unsigned long status_reads;     // STATUS/CREDITS polls
+    unsigned long doorbell_waits;   // times a caller parked on the doorbell futex
+    unsigned long completions;      // entries drained from the completion ring
+    unsigned long head_takes;       // pops taken from the head mirror (mmio_pop_spec)
+    unsigned long head_waits;       // mirror polls that found the last take not yet retired
+};
+void mmio_get_stats(struct mmio_stats *out);
+void mmio_reset_stats(void);
+
+// Hardware performance counters (hb_perf_counters), mirrored by the bridge at
+// 0x200. mmio_read_perf() returns a consistent snapshot of the whole block.
+struct mmio_perf {
+    uint64_t cycles;
+    uint32_t pushes;
+    uint32_t pops;
+    uint32_t push_refused;
+    uint32_t pop_refused;
+    uint32_t full_cycles;
+    uint32_t empty_cycles;
+    uint64_t occ_sum;       // occupancy summed every cycle: mean depth = occ_sum / cycles
+    uint32_t max_occ;
+};
+int mmio_read_perf(struct mmio_perf *out); // 0=success, -2=bridge kept updating
+void mmio_clear_perf(void);                // zeroes the counters on the bridge's next pass
+
+// Spill mode: while enabled, a push that finds the FIFO full is accepted into a
+// ring in host memory owned by the bridge, which refills the FIFO from it in
+// push order as pops free entries. mmio_is_full() and mmio_credits() then
+// cover FIFO plus ring, so a push is only refused once the ring is full too.
+struct mmio_spill_stats {
+    uint32_t occupancy;     // descriptors waiting in the ring
+    uint32_t capacity;      // ring size in descriptors
+    uint32_t spilled;       // descriptors ever sent to the ring
+    uint32_t refilled;      // descriptors ever moved from the ring into the FIFO
+};
+int mmio_set_spill(bool enable);    // 0=success, -1=not mapped
+bool mmio_is_spilling(void);        // the ring holds at least one descriptor
+int mmio_get_spill_stats(struct mmio_spill_stats *out); // 0=success, -1=not mapped
+
+// Delayed tasks: mmio_push_at() hands a task to the hardware timer wheel, which
+// enters it into the queue at simulation cycle release_cycle (same time base as
+// mmio_timer_now()), or as soon after as the queue has room. Releases up to
+// mmio_timer_horizon() cycles ahead are accepted; one already past is due at once.
+int mmio_push_at(uint32_t value, uint32_t release_cycle, int timeout_ms); // 0=success, -1=refused, -2=timeout, -4=bridge stalled
+uint32_t mmio_timer_now(void);      // bridge's cycle count, refreshed every pass
+uint32_t mmio_timer_pending(void);  // delayed tasks not yet released
+uint32_t mmio_timer_horizon(void);  // furthest release accepted, in cycles past now
+
+// Completions: in dispatch mode the bridge's follower models execute the tasks
+// the distributor hands them (service_cycles each, 0 selects 16) and host pops
+// are refused. With post_completions set, every finished task comes back
+// through the hardware completion queue into a ring at 0x400, which
+// mmio_drain_completions() empties in bulk. Without it the host can only poll
+// the per-follower counters with mmio_follower_status().
+#define MMIO_FOLLOWER_REGS 8
+struct mmio_completion {
+    uint32_t task;          // descriptor word 0 of the finished task
+    uint32_t follower;      // follower that ran it
+};
+int mmio_set_dispatch(bool enable, bool post_completions, uint32_t service_cycles); // 0=success, -1=not mapped
+unsigned mmio_num_followers(void);
+unsigned mmio_drain_completions(struct mmio_completion *out, unsigned max); // entries copied to out
+int mmio_follower_status(unsigned follower, uint32_t *done, uint32_t *last_task); // 0=success, -1=no such follower
+
+// Join counters: mmio_join_register() parks a continuation task in a hardware
+// join slot until `count` children have completed, then the hardware pushes it.
+// A child is a task whose word is MMIO_JOIN_CHILD(id, slot); its completion
+// counts the slot down instead of entering the completion ring. Register the
+// join before pushing any of its children.
+#define MMIO_JOIN_CHILD(id, slot) (0x80000000u | ((uint32_t)(slot) << 24) | ((uint32_t)(id) & 0xFFFFFFu))
+int mmio_join_register(unsigned slot, uint32_t count, uint32_t continuation, int timeout_ms); // 0=success, -1=refused, -2=timeout, -4=bridge stalled
+unsigned mmio_join_slots(void);     // number of join slots in the hardware
+uint32_t mmio_join_active(void);    // slots currently holding a continuation
+
+// Split-phase handshakes: *_start() issues the request and returns at once;
+// *_poll() reaps its ACK without sleeping. One push and one pop may be in
+// flight together, but not two of either, and not next to a blocking call of
+// the same kind. *_cancel() withdraws a request that is taking too long; if
+// the bridge already claimed it, keep polling for its ACK before issuing the
+// next one. task_queue_co.hpp builds awaitable operations on these.
+int mmio_push_start(uint32_t value);    // 0=issued, -2=not mapped
+int mmio_push_poll(void);               // 0=accepted, -1=refused, 1=no ack yet
+int mmio_push_cancel(void);             // 0=withdrawn (no ACK will come), 1=claimed, poll on
+int mmio_pop_start(void);               // 0=issued, -2=not mapped
+int mmio_pop_poll(uint32_t *out);       // 0=popped, -1=refused (empty), 1=no ack yet
+int mmio_pop_cancel(void);              // 0=withdrawn (no ACK will come), 1=claimed, poll on
+
+// Request lanes: the calls above share one CTRL/ACK pair and the driver's
+// stats, so they belong to a single thread. For concurrent clients, call
+// mmio_init() once per process, then give each thread (or process) its own lane
+// from mmio_lane_open(); the bridge serves the lanes round-robin. Lane calls
+// move descriptor word 0 only and do not update mmio_stats. A lane call that
+// times out withdraws its request like the calls above, so the lane stays
+// usable; mmio_lane_close() clears any request or ACK left on it.
+#define MMIO_MAX_LANES 64
+unsigned mmio_num_lanes(void);          // lanes the bridge serves (0: none)
+int mmio_lane_open(void);               // lane index, or -1 if all are taken
+void mmio_lane_close(int lane);
+int mmio_lane_push(int lane, uint32_t value, int timeout_ms); // 0=success, -1=refused, -2=timeout/bad lane, -4=bridge stalled
+int mmio_lane_pop(int lane, uint32_t *out, int timeout_ms);   // 0=success, -1=refused (empty), -2=timeout/bad lane, -4=bridge stalled
+
+// Head mirror: the bridge keeps the queue head (descriptor word 0) and a
+// sequence word in the page, so a pop can read it without a request.
+// mmio_pop_spec() takes the head and commits with one store to POP_COMMIT,
+// without waiting for an ACK; the bridge pops the entry on its next pass. The
+// next call waits (yielding, or spinning in busy-poll mode) until that pop is
+// retired. The take is not arbitrated by the bridge: use it from one consumer
+// thread only, not alongside mmio_pop/lane pops or dispatch mode.
+int mmio_head_peek(uint32_t *out);                 // 0=head in *out (not taken), -1=empty, 1=last take not retired yet, -2=not mapped
+int mmio_pop_spec(uint32_t *out, int timeout_ms);  // 0=taken, -1=empty, -2=timeout/not mapped
+
+// Polling: blocking calls sleep 1 ms between ACK polls by default. Busy-poll
+// mode spins instead (with a CPU pause hint), and mmio_wait_doorbell() spins
+// on the doorbell word rather than parking on the futex; pin the caller to a
+// core of its own, since it never yields. Timeouts stay in milliseconds.
+void mmio_set_busy_poll(bool enable);
+bool mmio_busy_poll(void);
+
+// The bridge publishes the CPU it runs on and how it was started
+// (verilator_main --cpu N / --busy-poll), so runs can record both sides.
+#define MMIO_BRIDGE_PINNED    0x1
+#define MMIO_BRIDGE_BUSY_POLL 0x2
+int mmio_bridge_cpu(uint32_t *mode);    // CPU number, -1 if unknown; *mode gets MMIO_BRIDGE_* bits
+
+// Ask the simulator to exit (sets TB_DONE)
+void mmio_signal_done(void);
+
 // Logging helper
 void mmio_write_log_header(FILE *f);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // TASK_QUEUE_MMIO_H
@@ -0,0 +1,238 @@
+// sw/src/task_runtime.c
+#define _POSIX_C_SOURCE 200809L
+
+#include "task_runtime.h"
+#include "task_queue_mmio.h"
+#include "task_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+struct rt_task {
+    rt_task_fn fn;
+    void *arg;
+};
+
+// closures live in the descriptor arena; the queue carries their handles
+static struct ta_arena arena;
+static uint64_t submitted = 0, executed = 0;
+// descriptors of pushes the bridge claimed but never acknowledged; they come
+// back only if a follower pops them
+static uint64_t disowned = 0;
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cv = PTHREAD_COND_INITIALIZER;
+
+// software backend: bounded ring of handles
+static uint32_t *ring = NULL;
+static unsigned ring_head = 0, ring_count = 0;
+static pthread_mutex_t ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ring_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t ring_not_full = PTHREAD_COND_INITIALIZER;
+
+// MMIO backend: the driver keeps one CTRL/ACK handshake in flight, so every
+// push or pop holds this lock for the whole round trip
+static pthread_mutex_t driver_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct rt_config cfg;
+static pthread_t *threads = NULL;
+static unsigned nthreads = 0;
+static int stopping = 0;
+static struct rt_stats stats;
+
+static void backoff(unsigned *spins) {
+    if (++*spins < 16) {
+        sched_yield();
+    } else {
+        const struct timespec ts = {0, 2000};
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 0=popped, -1=empty (MMIO only), 1=stopping
+static int queue_pop(uint32_t *handle) {
+    if (cfg.backend == RT_BACKEND_SW) {
+        pthread_mutex_lock(&ring_lock);
+        while (ring_count == 0 && !stopping) {
+            __atomic_add_fetch(&stats.pop_empty, 1, __ATOMIC_RELAXED);
+            pthread_cond_wait(&ring_not_empty, &ring_lock);
+        }
+        if (ring_count == 0) {
+            pthread_mutex_unlock(&ring_lock);
+            return 1;
+        }
+        *handle = ring[ring_head];
+        ring_head = (ring_head + 1) % cfg.capacity;
+        ring_count--;
+        pthread_cond_signal(&ring_not_full);
+        pthread_mutex_unlock(&ring_lock);
+        return 0;
+    }
+    pthread_mutex_lock(&driver_lock);
+    int rc = mmio_pop(handle, 100);
+    pthread_mutex_unlock(&driver_lock);
+    if (rc == 0) return 0;
+    if (__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) return 1;
+    __atomic_add_fetch(&stats.pop_empty, 1, __ATOMIC_RELAXED);
+    return -1;
+}
+
+// 0=pushed, -2=driver timeout (withdrawn), -4=bridge stalled (may still arrive)
+static int queue_push(uint32_t handle) {
+    if (cfg.backend == RT_BACKEND_SW) {
+        pthread_mutex_lock(&ring_lock);
+        while (ring_count == cfg.capacity) {
+            stats.push_refused++;
+            pthread_cond_wait(&ring_not_full, &ring_lock);
+        }
+        ring[(ring_head + ring_count) % cfg.capacity] = handle;
+        ring_count++;
+        pthread_cond_signal(&ring_not_empty);
+        pthread_mutex_unlock(&ring_lock);
+        return 0;
+    }
+    unsigned spins = 0;
+    for (;;) {
+        pthread_mutex_lock(&driver_lock);
+        int rc = mmio_push(handle, 100);
+        pthread_mutex_unlock(&driver_lock);
+        if (rc == 0) return 0;
+        if (rc != -1) return rc;
+        stats.push_refused++;
+        backoff(&spins);
+    }
+}
+
+// wakes rt_wait_idle() once the counts meet; it checks them under idle_lock,
+// so taking the lock here cannot slip between its check and its wait
+static void wake_if_idle(void) {
+    if (__atomic_load_n(&executed, __ATOMIC_ACQUIRE) == __atomic_load_n(&submitted, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&idle_lock);
+        pthread_cond_broadcast(&idle_cv);
+        pthread_mutex_unlock(&idle_lock);
+    }
+}
+
+static void *follower_main(void *unused) {
+    (void)unused;
+    unsigned spins = 0;
+    for (;;) {
+        uint32_t h;
+        int rc = queue_pop(&h);
+        if (rc == 1) break;
+        if (rc == -1) {
+            backoff(&spins);
+            continue;
+        }
+        spins = 0;
+        if (!ta_valid(&arena, h)) continue;     // not one of ours
+        // claim the closure; a NULL fn is a submit that timed out and was
+        // disowned by the leader, so only the descriptor is left to recycle
+        struct rt_task *d = ta_ptr(&arena, h);
+        void *arg = d->arg;
+        rt_task_fn fn = __atomic_exchange_n(&d->fn, NULL, __ATOMIC_ACQ_REL);
+        ta_free(&arena, h);
+        if (!fn) {
+            __atomic_sub_fetch(&disowned, 1, __ATOMIC_ACQ_REL);
+            continue;
+        }
+        fn(arg);
+        __atomic_add_fetch(&executed, 1, __ATOMIC_ACQ_REL);
+        wake_if_idle();
+    }
+    return NULL;
+}
+
+int rt_init(const struct rt_config *c) {
+    if (!c || c->followers == 0 || threads) return -1;
+    cfg = *c;
+    if (cfg.capacity == 0) cfg.capacity = 1024;
+    memset(&stats, 0, sizeof(stats));
+    submitted = executed = disowned = 0;
+    stopping = 0;
+    ring_head = ring_count = 0;
+
+    // every allocation the runtime makes happens here
+    if (ta_init(&arena, cfg.capacity, sizeof(struct rt_task)) != 0) return -1;
+    ring = cfg.backend == RT_BACKEND_SW ? calloc(cfg.capacity, sizeof(*ring)) : NULL;
+    threads = calloc(cfg.followers, sizeof(*threads));
+    if (!threads || (cfg.backend == RT_BACKEND_SW && !ring)) {
+        rt_shutdown();
+        return -1;
+    }
+
+    for (nthreads = 0; nthreads < cfg.followers; nthreads++) {
+        if (pthread_create(&threads[nthreads], NULL, follower_main, NULL) != 0) {
+            rt_shutdown();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int rt_submit(rt_task_fn fn, void *arg) {
+    uint32_t h;
+    unsigned spins = 0;
+    while ((h = ta_alloc(&arena)) == TA_NULL) {
+        // once stalled pushes hold every descriptor, none will be freed
+        if (__atomic_load_n(&disowned, __ATOMIC_ACQUIRE) >= cfg.capacity) return -3;
+        stats.arena_waits++;
+        backoff(&spins);
+    }
+    struct rt_task *t = ta_ptr(&arena, h);
+    t->fn = fn;
+    t->arg = arg;
+    __atomic_add_fetch(&submitted, 1, __ATOMIC_ACQ_REL);
+    int rc = queue_push(h);
+    if (rc == 0) return 0;
+    if (rc == -2) {
+        // withdrawn: the handle never reached the queue
+        ta_free(&arena, h);
+    } else {
+        // The bridge claimed the push and stalled, so it may still reach the
+        // queue: disown the closure, unless a follower already claimed it, and
+        // leave the descriptor for whichever follower pops it.
+        __atomic_add_fetch(&disowned, 1, __ATOMIC_ACQ_REL);
+        if (__atomic_exchange_n(&t->fn, NULL, __ATOMIC_ACQ_REL) == NULL) {
+            __atomic_sub_fetch(&disowned, 1, __ATOMIC_ACQ_REL);
+            return 0;
+        }
+        stats.abandoned++;
+    }
+    __atomic_sub_fetch(&submitted, 1, __ATOMIC_ACQ_REL);
+    wake_if_idle();
+    return -2;
+}
+
+void rt_wait_idle(void) {
+    pthread_mutex_lock(&idle_lock);
+    while (__atomic_load_n(&executed, __ATOMIC_ACQUIRE) != __atomic_load_n(&submitted, __ATOMIC_ACQUIRE)) {
+        pthread_cond_wait(&idle_cv, &idle_lock);
+    }
+    pthread_mutex_unlock(&idle_lock);
+}
+
+void rt_shutdown(void) {
+    if (nthreads > 0) rt_wait_idle();
+    pthread_mutex_lock(&ring_lock);
+    __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&ring_not_empty);
+    pthread_mutex_unlock(&ring_lock);
+    for (unsigned i = 0; i < nthreads; i++) pthread_join(threads[i], NULL);
+    nthreads = 0;
+    free(threads);
+    free(ring);
+    ta_destroy(&arena);
+    threads = NULL;
+    ring = NULL;
+}
+
+void rt_get_stats(struct rt_stats *out) {
+    if (!out) return;
+    *out = stats;
+    out->submitted = __atomic_load_n(&submitted, __ATOMIC_ACQUIRE);
+    out->executed = __atomic_load_n(&executed, __ATOMIC_ACQUIRE);
+    out->pop_empty = __atomic_load_n(&stats.pop_empty, __ATOMIC_RELAXED);
+    out->arena_high_water = ta_high_water(&arena);
+}
@@ -0,0 +1,47 @@
+// sw/src/task_runtime.h
+// Leader/follower thread pool on top of the task queue. The leader (the thread
+// that calls rt_submit) stores each closure in a descriptor from a fixed arena
+// (task_arena.h) and pushes the descriptor's 32-bit handle as the queue entry;
+// follower threads pop handles, run the closures and recycle the descriptors.
+// Nothing is allocated after rt_init(). The queue is either the hardware model
+// behind the MMIO driver or a plain software ring, so the same workload can be
+// timed on both.
+#ifndef TASK_RUNTIME_H
+#define TASK_RUNTIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef void (*rt_task_fn)(void *arg);
+
+enum rt_backend {
+    RT_BACKEND_SW = 0,      // mutex/condvar ring in host memory
+    RT_BACKEND_MMIO = 1,    // task_queue_mmio driver; the caller runs mmio_init() first
+};
+
+struct rt_config {
+    enum rt_backend backend;
+    unsigned followers;     // follower threads, at least 1
+    unsigned capacity;      // closures in flight (arena descriptors and SW ring size); 0 selects 1024
+};
+
+struct rt_stats {
+    uint64_t submitted;
+    uint64_t executed;
+    uint64_t push_refused;  // queue full: the leader backed off and retried
+    uint64_t pop_empty;     // a follower found the queue empty
+    uint64_t arena_waits;   // rt_submit found every descriptor in use and backed off
+    uint64_t abandoned;     // rt_submit pushes the bridge claimed and never acknowledged; their
+                            // descriptors are only recycled if a follower pops them later
+    uint32_t arena_high_water;  // most descriptors in use at once
+};
+
+// Only one runtime exists at a time, and only one thread submits to it.
+int rt_init(const struct rt_config *cfg);   // 0=success, -1=bad config or thread start failed
+int rt_submit(rt_task_fn fn, void *arg);    // 0=queued, -2=driver timeout (the closure will not run),
+                                            // -3=every descriptor is held by an abandoned push
+void rt_wait_idle(void);                    // returns once every submitted task has run
+void rt_shutdown(void);                     // waits for idle, then joins the followers
+void rt_get_stats(struct rt_stats *out);
+
+#endif // TASK_RUNTIME_H
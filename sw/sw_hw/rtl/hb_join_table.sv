@@ -0,0 +1,84 @@
+// hb_join_table.sv
+// Join counters for fork/join task graphs. The leader registers a continuation
+// task in a slot together with the number of child completions it waits for
+// (reg_count, at least 1); every dec_req on that slot counts one down, and when
+// the count reaches zero the continuation is released through out_valid /
+// out_data, in the order slots became ready. The slot is free again once its
+// continuation has been taken with out_ready.
+//
+// reg_ok is low (the registration is dropped) for an occupied slot or a zero
+// count. A decrement on a free slot, or on one already released, is ignored, so
+// the leader must register the join before pushing its children.
+
+module hb_join_table #(
+    parameter ENTRIES = 16,
+    parameter WIDTH = 32,
+    parameter COUNT_W = 8
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic reg_req,
+    input  logic [((ENTRIES > 1) ? $clog2(ENTRIES) : 1)-1:0] reg_slot,
+    input  logic [COUNT_W-1:0] reg_count,
+    input  logic [WIDTH-1:0] reg_task,
+    output logic reg_ok,
+    input  logic dec_req,
+    input  logic [((ENTRIES > 1) ? $clog2(ENTRIES) : 1)-1:0] dec_slot,
+    output logic out_valid,
+    output logic [WIDTH-1:0] out_data,
+    input  logic out_ready,
+    output logic [$clog2(ENTRIES+1)-1:0] active    // slots holding a continuation
+);
+
+    localparam SLOT_W = (ENTRIES > 1) ? $clog2(ENTRIES) : 1;
+    localparam CNT_W = $clog2(ENTRIES+1);
+
+    logic [ENTRIES-1:0] armed;
+    logic [COUNT_W-1:0] count [0:ENTRIES-1];
+    logic [WIDTH-1:0] task_mem [0:ENTRIES-1];
+
+    // slots whose count reached zero, oldest first; a slot is queued at most once
+    logic [SLOT_W-1:0] rq [0:ENTRIES-1];
+    logic [SLOT_W-1:0] rq_head, rq_tail;
+    logic [CNT_W-1:0] rq_count;
+
+    assign reg_ok    = reg_req && !armed[reg_slot] && (reg_count != '0);
+    assign out_valid = (rq_count != 0);
+    assign out_data  = task_mem[rq[rq_head]];
+
+    wire do_out  = out_valid && out_ready;
+    wire do_dec  = dec_req && armed[dec_slot] && (count[dec_slot] != '0);
+    wire to_zero = do_dec && (count[dec_slot] == COUNT_W'(1));
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            armed    <= '0;
+            rq_head  <= '0;
+            rq_tail  <= '0;
+            rq_count <= '0;
+            active   <= '0;
+        end else begin
+            // reg_ok needs a free slot and do_dec an armed one, so they never
+            // touch the same slot; do_out frees a slot whose count is already zero
+            if (reg_ok) begin
+                armed[reg_slot]    <= 1'b1;
+                count[reg_slot]    <= reg_count;
+                task_mem[reg_slot] <= reg_task;
+            end
+            if (do_dec) begin
+                count[dec_slot] <= count[dec_slot] - COUNT_W'(1);
+            end
+            if (to_zero) begin
+                rq[rq_tail] <= dec_slot;
+                rq_tail <= (int'(rq_tail) == ENTRIES - 1) ? '0 : rq_tail + SLOT_W'(1);
+            end
+            if (do_out) begin
+                armed[rq[rq_head]] <= 1'b0;
+                rq_head <= (int'(rq_head) == ENTRIES - 1) ? '0 : rq_head + SLOT_W'(1);
+            end
+            rq_count <= rq_count + CNT_W'(to_zero) - CNT_W'(do_out);
+            active <= active + CNT_W'(reg_ok) - CNT_W'(do_out);
+        end
+    end
+
+endmodule
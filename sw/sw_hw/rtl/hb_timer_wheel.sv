@@ -0,0 +1,99 @@
+// hb_timer_wheel.sv
+// Single-level timer wheel that holds delayed tasks until their release cycle.
+// `now` counts cycles from reset. A push carries release_at, an absolute cycle;
+// the task lands in bucket release_at % SLOTS, a BUCKET-entry FIFO. The cursor
+// (cur_time) follows `now` and stops on a slot until its bucket has drained
+// through out_valid / out_ready, so a task never leaves before its release
+// cycle and leaves late only while the downstream queue or the port is busy.
+// After such a stall the cursor skips up to two empty slots per cycle to catch
+// up with `now`. Tasks due in the same cycle leave in push order.
+//
+// A push is accepted (push_ok) when its bucket has room and the release cycle
+// is less than SLOTS cycles past the cursor; a release at or before the cursor
+// is due already and joins the cursor's bucket. Because the cursor only moves
+// on from an empty slot, every bucket holds tasks of a single release cycle.
+// SLOTS and BUCKET must be powers of two, BUCKET at least 2.
+
+module hb_timer_wheel #(
+    parameter SLOTS = 64,
+    parameter BUCKET = 4,
+    parameter WIDTH = 32,
+    parameter TIME_W = 32
+)(
+    input  logic clk,
+    input  logic reset,                 // synchronous reset
+    input  logic push_req,
+    input  logic [WIDTH-1:0] data_in,
+    input  logic [TIME_W-1:0] release_at,
+    output logic push_ok,
+    output logic out_valid,
+    output logic [WIDTH-1:0] out_data,
+    input  logic out_ready,
+    output logic [TIME_W-1:0] now,
+    output logic [$clog2(SLOTS*BUCKET+1)-1:0] pending
+);
+
+    localparam SLOT_W = $clog2(SLOTS);
+    localparam BPTR_W = (BUCKET > 1) ? $clog2(BUCKET) : 1;
+    localparam BCNT_W = $clog2(BUCKET+1);
+    localparam PEND_W = $clog2(SLOTS*BUCKET+1);
+    localparam [TIME_W-1:0] SLOTS_T = SLOTS;
+    localparam [BCNT_W-1:0] BUCKET_C = BUCKET;
+
+    logic [WIDTH-1:0] mem [0:SLOTS*BUCKET-1];
+    logic [BPTR_W-1:0] bhead [0:SLOTS-1];
+    logic [BCNT_W-1:0] bcount [0:SLOTS-1];
+    logic [TIME_W-1:0] cur_time;
+
+    wire [SLOT_W-1:0] cur_slot = cur_time[SLOT_W-1:0];
+    wire [TIME_W-1:0] delta = release_at - cur_time;
+    wire due = (delta == '0) || delta[TIME_W-1];           // at or before the cursor
+    wire [SLOT_W-1:0] push_slot = due ? cur_slot : release_at[SLOT_W-1:0];
+    wire [BPTR_W-1:0] push_idx = bhead[push_slot] + BPTR_W'(bcount[push_slot]);
+
+    assign push_ok   = push_req && (due || delta < SLOTS_T) && (bcount[push_slot] != BUCKET_C);
+    assign out_valid = (bcount[cur_slot] != 0);
+    assign out_data  = mem[{cur_slot, bhead[cur_slot]}];
+
+    wire do_out = out_valid && out_ready;
+    // hold the cursor while a due task joins its bucket, and never skip a slot
+    // that is receiving a task, so nothing can be left behind
+    wire [SLOT_W-1:0] next_slot = cur_slot + SLOT_W'(1);
+    wire next_empty = (bcount[next_slot] == 0) && !(push_ok && push_slot == next_slot);
+    wire step1 = !out_valid && (cur_time != now) && !(push_ok && due);
+    wire step2 = step1 && next_empty && (cur_time + 1 != now);
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            now      <= '0;
+            cur_time <= '0;
+            pending  <= '0;
+            for (int s = 0; s < SLOTS; s++) begin
+                bhead[s]  <= '0;
+                bcount[s] <= '0;
+            end
+        end else begin
+            now <= now + 1;
+            if (step2) cur_time <= cur_time + 2;
+            else if (step1) cur_time <= cur_time + 1;
+
+            if (push_ok) begin
+                mem[{push_slot, push_idx}] <= data_in;
+            end
+            if (do_out) begin
+                bhead[cur_slot] <= bhead[cur_slot] + BPTR_W'(1);
+            end
+
+            // a push and a release in the same bucket leave its count unchanged
+            for (int s = 0; s < SLOTS; s++) begin
+                if (push_ok && push_slot == SLOT_W'(s) && !(do_out && cur_slot == SLOT_W'(s))) begin
+                    bcount[s] <= bcount[s] + BCNT_W'(1);
+                end else if (do_out && cur_slot == SLOT_W'(s) && !(push_ok && push_slot == SLOT_W'(s))) begin
+                    bcount[s] <= bcount[s] - BCNT_W'(1);
+                end
+            end
+            pending <= pending + PEND_W'(push_ok) - PEND_W'(do_out);
+        end
+    end
+
+endmodule
@@ -1,38 +1,149 @@
 // hw/testbenches/tb_task_queue.v
 `timescale 1ns/1ps
 
-module tb_task_queue (
+module tb_task_queue #(
+    parameter NUM_FOLLOWERS = 4,
+    parameter DISPATCH_POLICY = 0,      // 0: round-robin, 1: first-ready, 2: least-recently-served
+    parameter FOLLOWER_CREDITS = 0,     // 0: ready/valid follower ports, >0: credit-based
+    parameter QUEUE_DEPTH = 16,
+    parameter QUEUE_TIMESTAMPS = 1,     // 1: carry a push timestamp with every entry
+    parameter TASK_WIDTH = 32,          // descriptor width: 32, 64, 128 or 256 bits
+    parameter TIMER_SLOTS = 64,         // timer wheel: release cycles up to TIMER_SLOTS-1 ahead
+    parameter TIMER_BUCKET = 4,         // timer wheel: tasks per release cycle
+    parameter COMPLETION_DEPTH = 16,    // completion queue entries
+    parameter JOIN_SLOTS = 16           // join counter slots (at most 128)
+)(
     input  logic clk,
     input  logic reset,
 
     // Host-side ports (driven by the Verilator MMIO harness)
     input  logic host_mode,           // when 1, host controls push/pop
     input  logic host_push_req,
-    input  logic [31:0] host_data_in,
+    input  logic [TASK_WIDTH-1:0] host_data_in,
     input  logic host_pop_req,
 
+    // Delayed push: with host_push_at set, host_push_req hands the task to the
+    // timer wheel, which enters it into the queue at cycle host_release.
+    // timer_push_ok reports acceptance in the same cycle.
+    input  logic host_push_at,
+    input  logic [31:0] host_release,
+    output logic timer_push_ok,
+    output logic [31:0] timer_now,
+    output logic [$clog2(TIMER_SLOTS*TIMER_BUCKET+1)-1:0] timer_pending,
+
+    // Follower-side dispatch ports: when dispatch_mode is 1 the distributor drains
+    // the queue into the follower ports instead of host pops.
+    // dispatch_data carries follower i's task in bits [TASK_WIDTH*i +: TASK_WIDTH].
+    input  logic dispatch_mode,
+    input  logic [NUM_FOLLOWERS-1:0] follower_ready,
+    output logic [NUM_FOLLOWERS-1:0] dispatch_valid,
+    output logic [NUM_FOLLOWERS*TASK_WIDTH-1:0] dispatch_data,
+    input  logic [NUM_FOLLOWERS-1:0] credit_return,   // credit mode: one pulse per freed follower buffer entry
+
+    // Completion return path: follower i posts a finished task ID in bits
+    // [32*i +: 32] and holds it until cpl_ready[i]; the host drains the queue
+    // with cq_pop and sees which follower posted each entry.
+    input  logic [NUM_FOLLOWERS-1:0] cpl_valid,
+    input  logic [NUM_FOLLOWERS*32-1:0] cpl_data,
+    output logic [NUM_FOLLOWERS-1:0] cpl_ready,
+    input  logic cq_pop,
+    output logic cq_valid,
+    output logic [31:0] cq_data,
+    output logic [((NUM_FOLLOWERS > 1) ? $clog2(NUM_FOLLOWERS) : 1)-1:0] cq_follower,
+    output logic [$clog2(COMPLETION_DEPTH+1)-1:0] cq_occupancy,
+
+    // Join counters: host_join_reg registers host_data_in as the continuation
+    // of slot host_join_slot, released into the queue after host_join_count
+    // child completions. A completion word with bit 31 set is a child of the
+    // slot in bits [24 +: slot width]; it goes to the join table instead of
+    // the completion queue.
+    input  logic host_join_reg,
+    input  logic [((JOIN_SLOTS > 1) ? $clog2(JOIN_SLOTS) : 1)-1:0] host_join_slot,
+    input  logic [7:0] host_join_count,
+    output logic join_reg_ok,
+    output logic [$clog2(JOIN_SLOTS+1)-1:0] join_active,
+
     // Observability
     output logic full,
     output logic valid_out,
-    output logic [31:0] data_out,
+    output logic [TASK_WIDTH-1:0] data_out,
+    output logic [$clog2(QUEUE_DEPTH+1)-1:0] occupancy,
+    output logic [$clog2(QUEUE_DEPTH+1)-1:0] credits,   // free queue entries the leader may push without refusal
+    output logic [31:0] data_ts,        // push cycle of the head entry
+    output logic [31:0] residency,      // cycles the head entry has been queued
+
+    // Watermarks: wm_we loads wm_high/wm_low into the queue core
+    input  logic wm_we,
+    input  logic [$clog2(QUEUE_DEPTH+1)-1:0] wm_high,
+    input  logic [$clog2(QUEUE_DEPTH+1)-1:0] wm_low,
+    output logic almost_full,
+    output logic almost_empty,
+    output logic [1:0] doorbell,        // bit 0: room for producers, bit 1: data for consumers
+
+    // Performance counters (hb_perf_counters); perf_clear zeroes them
+    input  logic perf_clear,
+    output logic [63:0] perf_cycles,
+    output logic [31:0] perf_pushes,
+    output logic [31:0] perf_pops,
+    output logic [31:0] perf_push_refused,
+    output logic [31:0] perf_pop_refused,
+    output logic [31:0] perf_full_cycles,
+    output logic [31:0] perf_empty_cycles,
+    output logic [63:0] perf_occ_sum,
+    output logic [$clog2(QUEUE_DEPTH+1)-1:0] perf_max_occ,
 
     // Top-level done signal
     output logic tb_done
 );
 
     reg        push_req;
-    reg [31:0] data_in;
+    reg [TASK_WIDTH-1:0] data_in;
     reg        pop_req;
 
     // downstream wires
-    wire       dist_out_valid;
-    wire [31:0] dist_out_data;
+    wire       dist_in_ready;
     wire [1:0] arb_grant_out;
     wire [1:0] arb_served_bank;
 
+    wire       timed_push = host_mode && host_push_req && host_push_at;
+    wire       plain_push = host_mode && host_push_req && !host_push_at;
+    wire       tw_valid;
+    wire [TASK_WIDTH-1:0] tw_data;
+    wire       jt_valid;
+    wire [TASK_WIDTH-1:0] jt_data;
+    wire       cq_post_valid;
+    wire [31:0] cq_post_data;
+    wire       join_post = cq_post_valid && cq_post_data[31];
+    localparam JSLOT_W = (JOIN_SLOTS > 1) ? $clog2(JOIN_SLOTS) : 1;
+
     initial tb_done = 1'b0;
 
-    hb_task_queue_core #(.DEPTH(16)) dut_queue (
+    // released tasks enter the queue on cycles the host is not pushing itself
+    hb_timer_wheel #(
+        .SLOTS(TIMER_SLOTS),
+        .BUCKET(TIMER_BUCKET),
+        .WIDTH(TASK_WIDTH),
+        .TIME_W(32)
+    ) timer (
+        .clk(clk),
+        .reset(reset),
+        .push_req(timed_push),
+        .data_in(host_data_in),
+        .release_at(host_release),
+        .push_ok(timer_push_ok),
+        .out_valid(tw_valid),
+        .out_data(tw_data),
+        .out_ready(host_mode && !full && !plain_push),
+        .now(timer_now),
+        .pending(timer_pending)
+    );
+
+    hb_task_queue_core #(
+        .DEPTH(QUEUE_DEPTH),
+        .WIDTH(TASK_WIDTH),
+        .TIMESTAMPS(QUEUE_TIMESTAMPS),
+        .TS_WIDTH(32)
+    ) dut_queue (
         .clk(clk),
         .reset(reset),
         .push_req(push_req),
@@ -40,24 +151,105 @@ module tb_task_queue (
         .full(full),
         .valid_out(valid_out),
         .data_out(data_out),
-        .pop_req(pop_req)
+        .pop_req(pop_req),
+        .occupancy(occupancy),
+        .wm_we(wm_we),
+        .wm_high_in(wm_high),
+        .wm_low_in(wm_low),
+        .almost_full(almost_full),
+        .almost_empty(almost_empty),
+        .doorbell(doorbell),
+        .ts_out(data_ts),
+        .residency(residency)
     );
 
-    hb_task_distributor distributor (
+    hb_perf_counters #(.DEPTH(QUEUE_DEPTH)) perf (
         .clk(clk),
         .reset(reset),
-        .in_valid(valid_out),
+        .clear(perf_clear),
+        .push_req(push_req),
+        .pop_req(pop_req),
+        .full(full),
+        .valid_out(valid_out),
+        .occupancy(occupancy),
+        .cycles(perf_cycles),
+        .pushes(perf_pushes),
+        .pops(perf_pops),
+        .push_refused(perf_push_refused),
+        .pop_refused(perf_pop_refused),
+        .full_cycles(perf_full_cycles),
+        .empty_cycles(perf_empty_cycles),
+        .occ_sum(perf_occ_sum),
+        .max_occ(perf_max_occ)
+    );
+
+    localparam OCC_W = $clog2(QUEUE_DEPTH+1);
+    localparam [OCC_W-1:0] QUEUE_DEPTH_W = QUEUE_DEPTH;
+    assign credits = QUEUE_DEPTH_W - occupancy;
+
+    hb_task_distributor #(
+        .WIDTH(TASK_WIDTH),
+        .NUM_FOLLOWERS(NUM_FOLLOWERS),
+        .POLICY(DISPATCH_POLICY),
+        .CREDITS(FOLLOWER_CREDITS)
+    ) distributor (
+        .clk(clk),
+        .reset(reset),
+        .in_valid(valid_out && dispatch_mode),
         .in_data(data_out),
-        .out_valid(dist_out_valid),
-        .out_data(dist_out_data),
-        .consumer_ready(1'b1)
+        .in_ready(dist_in_ready),
+        .out_valid(dispatch_valid),
+        .out_data(dispatch_data),
+        .consumer_ready(follower_ready),
+        .credit_return(credit_return)
+    );
+
+    hb_completion_queue #(
+        .NUM_FOLLOWERS(NUM_FOLLOWERS),
+        .DEPTH(COMPLETION_DEPTH),
+        .WIDTH(32)
+    ) completions (
+        .clk(clk),
+        .reset(reset),
+        .cpl_valid(cpl_valid),
+        .cpl_data(cpl_data),
+        .cpl_ready(cpl_ready),
+        .cq_pop(cq_pop),
+        .cq_valid(cq_valid),
+        .cq_data(cq_data),
+        .cq_follower(cq_follower),
+        .cq_occupancy(cq_occupancy),
+        .post_valid(cq_post_valid),
+        .post_data(cq_post_data),
+        .post_consume(join_post)
+    );
+
+    // released continuations enter the queue after host pushes and timer releases
+    hb_join_table #(
+        .ENTRIES(JOIN_SLOTS),
+        .WIDTH(TASK_WIDTH),
+        .COUNT_W(8)
+    ) joins (
+        .clk(clk),
+        .reset(reset),
+        .reg_req(host_mode && host_join_reg),
+        .reg_slot(host_join_slot),
+        .reg_count(host_join_count),
+        .reg_task(host_data_in),
+        .reg_ok(join_reg_ok),
+        .dec_req(join_post),
+        .dec_slot(cq_post_data[24 +: JSLOT_W]),
+        .out_valid(jt_valid),
+        .out_data(jt_data),
+        .out_ready(host_mode && !full && !plain_push && !tw_valid),
+        .active(join_active)
     );
 
     hb_arbiter_banked arbiter (
         .clk(clk),
         .reset(reset),
         .in_valid(valid_out),
-        .in_data(data_out),
+        .in_data(data_out[31:0]),
         .grant_out(arb_grant_out),
         .served_bank(arb_served_bank)
     );
@@ -65,18 +257,18 @@ module tb_task_queue (
     // When host_mode is set, forward host ports directly to DUT for single-cycle pulses.
     always_comb begin
         if (host_mode) begin
-            push_req = host_push_req;
-            data_in  = host_data_in;
-            pop_req  = host_pop_req;
+            push_req = plain_push || ((tw_valid || jt_valid) && !full);
+            data_in  = plain_push ? host_data_in : (tw_valid ? tw_data : jt_data);
+            pop_req  = dispatch_mode ? (valid_out && dist_in_ready) : host_pop_req;
         end else begin
             push_req = 1'b0;
-            data_in  = 32'h0;
+            data_in  = '0;
             pop_req  = 1'b0;
         end
     end
 
     // silence unused warnings
-    wire __unused_signals = dist_out_valid | (|dist_out_data) | (|arb_grant_out) | (|arb_served_bank);
+    wire __unused_signals = (|arb_grant_out) | (|arb_served_bank);
     // synthesis translate_off
     initial begin
         if (__unused_signals) begin end
@@ -9,11 +9,132 @@
 // 0x0C STATUS     : bits: FULL(0x1), VALID(0x2)
 // 0x10 DATA_OUT   : uint32_t (value popped)
 // 0x14 TB_DONE    : uint32_t (software can set to 1 to ask sim to stop)
+// 0x18 CREDITS    : uint32_t free queue entries as of the last pass (a hint; other producers may take them)
+// 0x1C BATCH_LEN  : uint32_t words in the batch window for a PUSH_BATCH request
+// 0x20 BATCH_ACC  : uint32_t words accepted by the last PUSH_BATCH (the rest were refused)
+// 0x24 WM_HIGH    : uint32_t almost-full watermark (host writes; reset value = queue depth)
+// 0x28 WM_LOW     : uint32_t almost-empty watermark (host writes; reset value = 0)
+// 0x2C DOORBELL   : sticky bits set by the bridge, cleared by the host:
+//                   ROOM(0x1) almost_full fell, DATA(0x2) almost_empty fell
+// 0x30 DB_SEQ     : uint32_t incremented on every doorbell; futex word the bridge wakes
+// 0x34 RESIDENCY  : uint32_t cycles the last popped task spent queued (valid with POP_OK)
+// 0x38 DATA_TS    : uint32_t push cycle of the last popped task
+// 0x3C BRIDGE_CPU : uint32_t CPU the bridge last ran on, plus one, refreshed every pass
+// 0x40 DESC_WORDS : uint32_t descriptor size in 32-bit words (TASK_WIDTH / 32), set by the bridge
+// 0x44-0x5C       : DATA_IN_HI, descriptor words 1..7 to push (word 0 is DATA_IN)
+// 0x60 BRIDGE_MODE : uint32_t how the bridge was started: PINNED(0x1), BUSY_POLL(0x2)
+// 0x64-0x7C       : DATA_OUT_HI, descriptor words 1..7 popped (word 0 is DATA_OUT)
+// 0x80 SPILL_CTRL : host writes ENABLE(0x1) to spill pushes that find the FIFO full
+// 0x84 SPILL_OCC  : uint32_t descriptors waiting in the spill ring
+// 0x88 SPILLED    : uint32_t descriptors ever sent to the spill ring
+// 0x8C REFILLED   : uint32_t descriptors ever moved from the ring into the FIFO
+// 0x90 SPILL_CAP  : uint32_t spill ring capacity in descriptors, set by the bridge
+// 0x94 RELEASE    : uint32_t release cycle for a PUSH_AT request (compare TIMER_NOW)
+// 0x98 TIMER_NOW  : uint32_t current simulation cycle as counted by the timer wheel
+// 0x9C TIMER_PEND : uint32_t delayed tasks held in the timer wheel
+// 0xA0 TIMER_HORIZON : uint32_t furthest release accepted, in cycles past TIMER_NOW (set by the bridge)
+// 0xA4 DISPATCH_CTRL : host writes ENABLE(0x1) to dispatch to the follower models,
+//                   POST(0x2) to have them post completions to the completion ring
+// 0xA8 FOLLOWER_SVC  : uint32_t cycles a follower spends on each task (0: 16)
+// 0xAC NUM_FOLLOWERS : uint32_t follower count, set by the bridge
+// 0xB0 CQ_TAIL    : uint32_t completions written to the ring (free-running, bridge)
+// 0xB4 CQ_HEAD    : uint32_t completions consumed from the ring (free-running, host)
+// 0xB8 CQ_SLOTS   : uint32_t completion ring capacity in entries, set by the bridge
+// 0xBC NUM_LANES  : uint32_t request lanes at 0x800, set by the bridge
+// 0xC0-0xDF       : FOLLOWER_DONE[0..7], tasks finished by each follower
+// 0xE0-0xFF       : FOLLOWER_LAST[0..7], last task word each follower finished
+// 0x100-0x1FF     : batch window, up to 64 words pushed in order: BATCH_LEN descriptors
+//                   of DESC_WORDS words each, so 64 / DESC_WORDS descriptors per batch
+// 0x200-0x23F     : performance counters mirrored from hb_perf_counters:
+//   0x200 PERF_SEQ      seqlock word: odd while the bridge is updating the block
+//   0x204 PERF_CTRL     host writes CLEAR(0x1) to zero the counters; bridge clears it
+//   0x208 CYCLES        64-bit (low word first)
+//   0x210 PUSHES, 0x214 POPS, 0x218 PUSH_REFUSED, 0x21C POP_REFUSED
+//   0x220 FULL_CYCLES, 0x224 EMPTY_CYCLES
+//   0x228 OCC_SUM       64-bit occupancy summed every cycle (mean depth = OCC_SUM / CYCLES)
+//   0x230 MAX_OCC
+// 0x240 JOIN_SLOT : uint32_t join slot for a JOIN_REG request
+// 0x244 JOIN_COUNT: uint32_t child completions the continuation waits for (1..255)
+// 0x248 JOIN_ACTIVE : uint32_t join slots holding a continuation
+// 0x24C JOIN_SLOTS: uint32_t number of join slots, set by the bridge
+// 0x250 HEAD_SEQ  : uint32_t head mirror: entries ever popped (bits 31:1), head VALID (bit 0)
+// 0x254 HEAD_DATA : uint32_t descriptor word 0 of the queue head, valid with HEAD_SEQ bit 0
+// 0x258 POP_COMMIT: uint32_t entries the host has taken from the mirror (free-running, 31 bits)
+// 0x400-0x7FF     : completion ring, CQ_SLOTS entries of two words {task word 0, follower}
+// 0x800-0xFFF     : request lanes, NUM_LANES blocks of 0x20 bytes:
+//   +0x00 L_CTRL     PUSH_REQ(0x1), POP_REQ(0x2); host sets, bridge claims with a compare-and-swap to 0
+//                    (a host that times out withdraws it the same way)
+//   +0x04 L_DATA_IN  word to push (upper descriptor words are zero)
+//   +0x08 L_ACK      PUSH_OK(0x1), PUSH_REFUSED(0x2), POP_OK(0x4), POP_REFUSED(0x8); host clears
+//   +0x0C L_DATA_OUT descriptor word 0 popped
+//   +0x10 L_OWNER    0 when free; a host thread claims the lane with a compare-and-swap
+// CTRL also has PUSH_BATCH(0x4), PUSH_AT(0x8) and JOIN_REG(0x10); ACK also has BATCH_DONE(0x10).
+// STATUS also has ALMOST_FULL(0x4), ALMOST_EMPTY(0x8), SPILLING(0x10).
+// STATUS and CREDITS are refreshed before any ACK bit is set, so a host that
+// sees an ACK also sees the queue state after that operation.
+// CTRL and ACK are only changed with atomic or/and on both sides. The bridge
+// claims a request by clearing its CTRL bit before serving it; a host that
+// times out withdraws the request the same way, and if the bridge got there
+// first, an ACK is on its way.
 // file size: 4096 bytes
+//
+// Spill mode: with SPILL_CTRL.ENABLE set, a push that finds the FIFO full is
+// accepted into a ring of SPILL_SLOTS descriptors kept in host shared memory
+// ("spill_ring.bin", owned by the bridge) instead of being refused. While the
+// ring holds anything, every new push goes behind it, and the bridge refills
+// the FIFO from the ring head as pops free entries, so tasks still leave in
+// push order. FULL and CREDITS then describe FIFO plus ring; RESIDENCY and the
+// perf counters only see the FIFO (a refill counts as a push).
+//
+// Delayed pushes: PUSH_AT hands DATA_IN (and DATA_IN_HI) to the hardware timer
+// wheel with release cycle RELEASE, acked with PUSH_OK or PUSH_REFUSED like a
+// push. The task enters the FIFO at that cycle, or later if the FIFO is full.
+// A release more than TIMER_HORIZON cycles ahead, or a release cycle whose
+// bucket is full, is refused; a release already past is due at once. Delayed
+// tasks never go to the spill ring.
+//
+// Dispatch mode: with DISPATCH_CTRL.ENABLE set the distributor drains the queue
+// into NUM_FOLLOWERS follower models (follower_model.h) that run every
+// simulated cycle; host pops are refused meanwhile. Each follower counts its
+// finished tasks in FOLLOWER_DONE / FOLLOWER_LAST. With POST also set, it posts
+// every finished task to hb_completion_queue, and the bridge moves completions
+// from there into the ring whenever the ring has room (CQ_TAIL - CQ_HEAD <
+// CQ_SLOTS), so a slow host holds the followers' posts back instead of losing them.
+//
+// Join counters: JOIN_REG registers DATA_IN (and DATA_IN_HI) as the
+// continuation of join slot JOIN_SLOT, acked PUSH_OK, or PUSH_REFUSED if the
+// slot is occupied. A posted completion with bit 31 set counts down the slot in
+// bits 30:24 instead of entering the ring; at zero the continuation is pushed
+// into the queue by the hardware.
+//
+// Request lanes: each host thread (or process) owns a lane and runs plain
+// push/pop handshakes on it, so clients never share CTRL/ACK words. Every pass
+// the bridge serves each lane with a request pending, one queue operation per
+// cycle, starting after the lane it granted first last pass (round-robin).
+// Lanes go through the same routing as the CTRL handshake (spill ring, dispatch
+// mode), which is served first each pass.
+//
+// Head mirror: the bridge keeps HEAD_DATA and HEAD_SEQ current on every
+// status refresh, writing the data before the sequence word, so the queue head
+// can be read before any pop is requested. A consumer takes it by reading
+// HEAD_SEQ, HEAD_DATA and HEAD_SEQ again (equal and VALID), then commits with
+// one release store of HEAD_SEQ[31:1] + 1 to POP_COMMIT, without a handshake.
+// The bridge pops once per entry the new POP_COMMIT is ahead of its pop count
+// and acts on each value once, so a stale commit (the entry already went
+// through another path) is dropped rather than held against later pushes.
+// The mirror counts pops from every path, but the take itself is not
+// arbitrated: one consumer may use it, and not alongside other pops or
+// dispatch mode.
+//
+// Options: --cpu N pins the bridge to CPU N (sched_setaffinity) so it does not
+// migrate during a run. --busy-poll drops the msync at the end of every pass,
+// leaving a pure spin over the shared mapping (the host sees the stores
+// through its own MAP_SHARED view either way); give the bridge a core of its own.
 
 #include "Vtb_task_queue.h"
 #include "verilated.h"
 #include "verilated_vcd_c.h"
+#include "follower_model.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -24,17 +145,104 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <iostream>
+#include <vector>
+#include <sched.h>
 
 using namespace std;
 
+// Must match the tb_task_queue parameters (the Makefile passes them via -G and -CFLAGS)
+#ifndef QUEUE_DEPTH
+#define QUEUE_DEPTH 16
+#endif
+#ifndef TASK_WIDTH
+#define TASK_WIDTH 32
+#endif
+#define TASK_WORDS (TASK_WIDTH / 32)
+#ifndef SPILL_SLOTS
+#define SPILL_SLOTS 4096
+#endif
+#ifndef TIMER_SLOTS
+#define TIMER_SLOTS 64
+#endif
+#ifndef NUM_FOLLOWERS
+#define NUM_FOLLOWERS 4
+#endif
+#ifndef FOLLOWER_CREDITS
+#define FOLLOWER_CREDITS 0
+#endif
+#ifndef JOIN_SLOTS
+#define JOIN_SLOTS 16
+#endif
+#ifndef MMIO_LANES
+#define MMIO_LANES 16
+#endif
+
 static Vtb_task_queue *top = nullptr;
 static VerilatedVcdC *tfp = nullptr;
 static uint64_t tick_count = 0;
+static uint32_t pending_doorbell = 0;   // doorbell pulses seen since the last publish_status()
 
 // MMIO definitions
 const char *MMIO_FILE = "mmio_region.bin";
 const size_t MMIO_SIZE = 4096;
+const char *SPILL_FILE = "spill_ring.bin";
+const size_t SPILL_SIZE = (size_t)SPILL_SLOTS * TASK_WORDS * 4;
+const size_t OFF_CREDITS   = 0x18;
+const size_t OFF_BATCH_LEN = 0x1C;
+const size_t OFF_BATCH_ACC = 0x20;
+const size_t OFF_WM_HIGH   = 0x24;
+const size_t OFF_WM_LOW    = 0x28;
+const size_t OFF_DOORBELL  = 0x2C;
+const size_t OFF_DB_SEQ    = 0x30;
+const size_t OFF_RESIDENCY = 0x34;
+const size_t OFF_DATA_TS   = 0x38;
+const size_t OFF_BRIDGE_CPU  = 0x3C;
+const size_t OFF_DESC_WORDS  = 0x40;
+const size_t OFF_DATA_IN_HI  = 0x44;
+const size_t OFF_BRIDGE_MODE = 0x60;
+const size_t OFF_DATA_OUT_HI = 0x64;
+const size_t OFF_SPILL_CTRL = 0x80;
+const size_t OFF_SPILL_OCC  = 0x84;
+const size_t OFF_SPILLED    = 0x88;
+const size_t OFF_REFILLED   = 0x8C;
+const size_t OFF_SPILL_CAP  = 0x90;
+const size_t OFF_RELEASE    = 0x94;
+const size_t OFF_TIMER_NOW  = 0x98;
+const size_t OFF_TIMER_PEND = 0x9C;
+const size_t OFF_TIMER_HORIZON = 0xA0;
+const size_t OFF_DISPATCH_CTRL = 0xA4;
+const size_t OFF_FOLLOWER_SVC  = 0xA8;
+const size_t OFF_NUM_FOLLOWERS = 0xAC;
+const size_t OFF_CQ_TAIL  = 0xB0;
+const size_t OFF_CQ_HEAD  = 0xB4;
+const size_t OFF_CQ_SLOTS = 0xB8;
+const size_t OFF_NUM_LANES = 0xBC;
+const size_t OFF_FOLLOWER_DONE = 0xC0;
+const size_t OFF_FOLLOWER_LAST = 0xE0;
+const size_t OFF_CQ_RING  = 0x400;
+const uint32_t CQ_SLOTS   = (0x800 - 0x400) / 8;
+const int FOLLOWER_REGS   = 8;
+const size_t OFF_BATCH_WIN = 0x100;
+const size_t OFF_PERF_SEQ  = 0x200;
+const size_t OFF_PERF_CTRL = 0x204;
+const size_t OFF_PERF      = 0x208;   // first counter word
+const size_t OFF_JOIN_SLOT   = 0x240;
+const size_t OFF_JOIN_COUNT  = 0x244;
+const size_t OFF_JOIN_ACTIVE = 0x248;
+const size_t OFF_JOIN_SLOTS  = 0x24C;
+const size_t OFF_HEAD_SEQ    = 0x250;
+const size_t OFF_HEAD_DATA   = 0x254;
+const size_t OFF_POP_COMMIT  = 0x258;
+const uint32_t HEAD_IDX_MASK = 0x7FFFFFFF;
+const uint32_t BATCH_MAX   = 64;
+const size_t OFF_LANES   = 0x800;
+const size_t LANE_STRIDE = 0x20;
+const size_t L_CTRL = 0x00, L_DATA_IN = 0x04, L_ACK = 0x08, L_DATA_OUT = 0x0C;
+static_assert(OFF_LANES + MMIO_LANES * LANE_STRIDE <= MMIO_SIZE, "MMIO_LANES does not fit the MMIO page");
 
 inline uint32_t mmio_read32(volatile uint8_t *base, size_t off) {
     uint32_t v;
@@ -49,8 +257,44 @@ inline void mmio_write32(volatile uint8_t *base, size_t off, uint32_t val) {
     // no need for clear_cache here; this is just an MMIO data file
 }
 
+// Verilator exposes buses as plain integers up to 64 bits and as arrays of
+// 32-bit words beyond that.
+static inline uint32_t bus_word(uint32_t bus, int) { return bus; }
+static inline uint32_t bus_word(uint64_t bus, int i) { return (uint32_t)(bus >> (32 * i)); }
+template <typename W>
+static inline uint32_t bus_word(const W &bus, int i) { return bus[i]; }
+
+static inline void bus_set(uint32_t &bus, const uint32_t *w, int) { bus = w[0]; }
+static inline void bus_set(uint64_t &bus, const uint32_t *w, int) { bus = ((uint64_t)w[1] << 32) | w[0]; }
+template <typename W>
+static inline void bus_set(W &bus, const uint32_t *w, int n) {
+    for (int i = 0; i < n; i++) bus[i] = w[i];
+}
+
+// read a descriptor held in MMIO: word 0 at off0, words 1.. at off_hi
+static void read_descriptor(volatile uint8_t *mmio, size_t off0, size_t off_hi, uint32_t *w) {
+    w[0] = mmio_read32(mmio, off0);
+    for (int i = 1; i < TASK_WORDS; i++) w[i] = mmio_read32(mmio, off_hi + 4 * (i - 1));
+}
+
+static void load_descriptor(volatile uint8_t *mmio, size_t off0, size_t off_hi) {
+    uint32_t w[TASK_WORDS];
+    read_descriptor(mmio, off0, off_hi, w);
+    bus_set(top->host_data_in, w, TASK_WORDS);
+}
+
+// Dispatch mode state. The follower models advance on every simulated cycle,
+// so tick() reaches the MMIO region through mmio_base.
+static volatile uint8_t *mmio_base = nullptr;
+static bool dispatch_on = false, post_on = false;
+static vector<FollowerModel> followers(NUM_FOLLOWERS);
+static uint32_t cq_tail = 0;
+
+static void followers_cycle();
+
 // tick helper: one full clock (falling + rising) with VCD dump
 static void tick() {
+    followers_cycle();
     // falling edge
     top->clk = 0;
     top->eval();
@@ -59,20 +303,337 @@ static void tick() {
     top->clk = 1;
     top->eval();
     if (tfp) tfp->dump(tick_count++);
+    pending_doorbell |= top->doorbell;
+    top->cq_pop = 0;
+}
+
+// One cycle of the follower side, driven before the clock edge: take dispatched
+// tasks (as follower_cycle() in hw/verilator_main.cpp does), move one completion
+// from hb_completion_queue to the ring, and offer new posts.
+static void followers_cycle() {
+    if (!dispatch_on) return;
+    uint32_t svc = mmio_read32(mmio_base, OFF_FOLLOWER_SVC);
+    if (svc == 0) svc = 16;
+
+    uint32_t ready = 0, credit_return = 0;
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        if (FOLLOWER_CREDITS > 0 || followers[f].ready()) ready |= 1u << f;
+    }
+    top->follower_ready = ready;
+    uint32_t accepted = ready & top->dispatch_valid;
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        FollowerModel &fm = followers[f];
+        if (fm.step()) {
+            if (f < FOLLOWER_REGS) {
+                mmio_write32(mmio_base, OFF_FOLLOWER_LAST + 4 * f, fm.task);
+                __atomic_store_n((volatile uint32_t *)(mmio_base + OFF_FOLLOWER_DONE + 4 * f),
+                                 (uint32_t)fm.completed, __ATOMIC_RELEASE);
+            }
+            if (post_on) fm.outbox.push_back(fm.task);
+        }
+        if (accepted & (1u << f)) {
+            uint32_t t = bus_word(top->dispatch_data, f * TASK_WORDS);
+            if (FOLLOWER_CREDITS > 0) fm.inbox.push_back(t);
+            else fm.accept(t, svc);
+        }
+        if (FOLLOWER_CREDITS > 0 && fm.ready() && !fm.inbox.empty()) {
+            fm.accept(fm.inbox.front(), svc);
+            fm.inbox.pop_front();
+            credit_return |= 1u << f;
+        }
+    }
+    top->credit_return = credit_return;
+
+    // the entry is written before CQ_TAIL is published, so the host never reads a stale slot
+    uint32_t cq_head = __atomic_load_n((volatile uint32_t *)(mmio_base + OFF_CQ_HEAD), __ATOMIC_ACQUIRE);
+    if (top->cq_valid && cq_tail - cq_head < CQ_SLOTS) {
+        size_t off = OFF_CQ_RING + 8 * (cq_tail % CQ_SLOTS);
+        mmio_write32(mmio_base, off, top->cq_data);
+        mmio_write32(mmio_base, off + 4, top->cq_follower);
+        cq_tail++;
+        __atomic_store_n((volatile uint32_t *)(mmio_base + OFF_CQ_TAIL), cq_tail, __ATOMIC_RELEASE);
+        top->cq_pop = 1;
+    }
+
+    uint32_t valid = 0, data[NUM_FOLLOWERS];
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        data[f] = followers[f].outbox.empty() ? 0 : followers[f].outbox.front();
+        if (!followers[f].outbox.empty()) valid |= 1u << f;
+    }
+    top->cpl_valid = valid;
+    bus_set(top->cpl_data, data, NUM_FOLLOWERS);
+    top->eval();   // cpl_ready is combinational on cpl_valid
+    for (int f = 0; f < NUM_FOLLOWERS; f++) {
+        if (top->cpl_ready & (1u << f)) followers[f].outbox.pop_front();
+    }
+}
+
+// pick up DISPATCH_CTRL changes; the host should only turn dispatch off once idle
+static void apply_dispatch(volatile uint8_t *mmio) {
+    uint32_t ctrl = mmio_read32(mmio, OFF_DISPATCH_CTRL);
+    dispatch_on = (ctrl & 0x1) != 0;
+    post_on = dispatch_on && (ctrl & 0x2) != 0;
+    top->dispatch_mode = dispatch_on;
+    if (!dispatch_on) {
+        top->follower_ready = 0;
+        top->credit_return = 0;
+        top->cpl_valid = 0;
+    }
+}
+
+// Spill ring: descriptors accepted while the FIFO was full, oldest at spill_head.
+// Head and tail are free-running counters; the slot is the counter mod SPILL_SLOTS.
+static uint32_t *spill_ring = nullptr;
+static uint32_t spill_head = 0, spill_tail = 0;
+static uint32_t spill_total = 0, refill_total = 0;
+
+static inline uint32_t spill_occ() { return spill_tail - spill_head; }
+
+static inline bool spill_enabled(volatile uint8_t *mmio) {
+    return (mmio_read32(mmio, OFF_SPILL_CTRL) & 0x1) != 0;
+}
+
+// where the next push goes
+enum PushRoute { ROUTE_FIFO, ROUTE_SPILL, ROUTE_REFUSE };
+
+static PushRoute route_push(volatile uint8_t *mmio) {
+    // anything already spilled is older, so a new push must queue behind it
+    // (even if the host has since turned spilling off)
+    if (spill_occ() == 0) {
+        if (!top->full) return ROUTE_FIFO;
+        if (!spill_enabled(mmio)) return ROUTE_REFUSE;
+    }
+    return spill_occ() < SPILL_SLOTS ? ROUTE_SPILL : ROUTE_REFUSE;
+}
+
+static void spill_put(const uint32_t *w) {
+    memcpy(spill_ring + (size_t)(spill_tail % SPILL_SLOTS) * TASK_WORDS, w, 4 * TASK_WORDS);
+    spill_tail++;
+    spill_total++;
+}
+
+// move spilled descriptors into the FIFO, oldest first, one per cycle while it has room
+static void refill_from_spill() {
+    while (spill_occ() > 0 && !top->full) {
+        bus_set(top->host_data_in, spill_ring + (size_t)(spill_head % SPILL_SLOTS) * TASK_WORDS, TASK_WORDS);
+        top->host_push_req = 1;
+        tick();
+        top->host_push_req = 0;
+        spill_head++;
+        refill_total++;
+    }
+}
+
+// Head mirror state: pops of the queue head from any path (31 bits), and the
+// last POP_COMMIT value acted on
+static uint32_t head_pops = 0, commit_seen = 0;
+
+// refresh STATUS (full / valid), CREDITS, the head mirror and the spill registers from the current DUT state
+static void publish_status(volatile uint8_t *mmio) {
+    // with spilling on, the host sees FIFO + ring as one queue
+    bool spill_on = spill_enabled(mmio);
+    bool full = top->full && (!spill_on || spill_occ() == SPILL_SLOTS);
+    uint32_t credits = (uint32_t)top->credits;
+    if (spill_on) credits += SPILL_SLOTS - spill_occ();
+    uint32_t status_bits = 0;
+    if (full) status_bits |= 0x1;
+    if (top->valid_out) status_bits |= 0x2;
+    if (top->almost_full) status_bits |= 0x4;
+    if (top->almost_empty) status_bits |= 0x8;
+    if (spill_occ() > 0) status_bits |= 0x10;
+    mmio_write32(mmio, 0x0C, status_bits);
+    mmio_write32(mmio, OFF_CREDITS, credits);
+    mmio_write32(mmio, OFF_SPILL_OCC, spill_occ());
+    mmio_write32(mmio, OFF_SPILLED, spill_total);
+    mmio_write32(mmio, OFF_REFILLED, refill_total);
+    mmio_write32(mmio, OFF_TIMER_NOW, top->timer_now);
+    mmio_write32(mmio, OFF_TIMER_PEND, top->timer_pending);
+    mmio_write32(mmio, OFF_JOIN_ACTIVE, top->join_active);
+
+    // head mirror: the data goes out before the sequence word that vouches for it
+    bool head_valid = top->valid_out && !dispatch_on;
+    if (head_valid) mmio_write32(mmio, OFF_HEAD_DATA, bus_word(top->data_out, 0));
+    __atomic_store_n((volatile uint32_t *)(mmio + OFF_HEAD_SEQ),
+                     (head_pops << 1) | (head_valid ? 1u : 0u), __ATOMIC_RELEASE);
+
+    // ring the doorbell: sticky bits for pollers, sequence bump + futex wake for
+    // parked producers/consumers (the mapping is shared, so the wake crosses processes)
+    if (pending_doorbell) {
+        __atomic_fetch_or((volatile uint32_t *)(mmio + OFF_DOORBELL), pending_doorbell, __ATOMIC_RELEASE);
+        volatile uint32_t *seq = (volatile uint32_t *)(mmio + OFF_DB_SEQ);
+        __atomic_add_fetch(seq, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, (uint32_t *)seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+        pending_doorbell = 0;
+    }
+}
+
+// mirror the perf counter block under the PERF_SEQ seqlock so the host can read
+// it in one pass: the sequence is odd while the words are being rewritten.
+static void publish_perf(volatile uint8_t *mmio) {
+    if (mmio_read32(mmio, OFF_PERF_CTRL) & 0x1) {
+        top->perf_clear = 1;
+        tick();
+        top->perf_clear = 0;
+        mmio_write32(mmio, OFF_PERF_CTRL, 0);
+    }
+    volatile uint32_t *seq = (volatile uint32_t *)(mmio + OFF_PERF_SEQ);
+    __atomic_add_fetch(seq, 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const uint32_t words[] = {
+        (uint32_t)top->perf_cycles, (uint32_t)(top->perf_cycles >> 32),
+        top->perf_pushes, top->perf_pops, top->perf_push_refused, top->perf_pop_refused,
+        top->perf_full_cycles, top->perf_empty_cycles,
+        (uint32_t)top->perf_occ_sum, (uint32_t)(top->perf_occ_sum >> 32),
+        (uint32_t)top->perf_max_occ,
+    };
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        mmio_write32(mmio, OFF_PERF + 4 * i, words[i]);
+    }
+    __atomic_add_fetch(seq, 1, __ATOMIC_RELEASE);
+}
+
+// load WM_HIGH / WM_LOW into the queue core when the host changed them
+static void apply_watermarks(volatile uint8_t *mmio) {
+    static uint32_t cur_high = 0xFFFFFFFF, cur_low = 0xFFFFFFFF;
+    uint32_t high = mmio_read32(mmio, OFF_WM_HIGH);
+    uint32_t low = mmio_read32(mmio, OFF_WM_LOW);
+    if (high == cur_high && low == cur_low) return;
+    top->wm_high = high;
+    top->wm_low = low;
+    top->wm_we = 1;
+    tick();
+    top->wm_we = 0;
+    cur_high = high;
+    cur_low = low;
+}
+
+// Claim a CTRL request before serving it: clear its bit atomically and report
+// whether it was still set. A host that gives up on a request clears the bit
+// the same way, so exactly one side wins: the request is either withdrawn
+// before we see it or claimed and then ACKed. Both sides only ever touch CTRL
+// and ACK with atomic or/and, so a push and a pop can be in flight together.
+static bool claim_request(volatile uint8_t *mmio, uint32_t ctrl_bit) {
+    volatile uint32_t *ctrl = (volatile uint32_t *)(mmio + 0x00);
+    return (__atomic_fetch_and(ctrl, ~ctrl_bit, __ATOMIC_ACQ_REL) & ctrl_bit) != 0;
+}
+
+// raise the ACK bit of a claimed request; the host clears it with an atomic and
+static void complete_request(volatile uint8_t *mmio, uint32_t ack_bit) {
+    __atomic_fetch_or((volatile uint32_t *)(mmio + 0x08), ack_bit, __ATOMIC_RELEASE);
 }
 
-// create or open mmio file and mmap it, return pointer
-volatile uint8_t *mmio_map_or_die(const char *path) {
+// one push of descriptor w, routed like any push; false if refused
+static bool push_descriptor(volatile uint8_t *mmio, const uint32_t *w) {
+    PushRoute route = route_push(mmio);
+    if (route == ROUTE_REFUSE) {
+        // present the request for a cycle anyway so the perf counters see the refusal
+        top->host_push_req = 1;
+        tick();
+        top->host_push_req = 0;
+        return false;
+    }
+    if (route == ROUTE_FIFO) {
+        // perform push by pulsing host_push_req for one cycle
+        bus_set(top->host_data_in, w, TASK_WORDS);
+        top->host_push_req = 1;
+        tick(); // rising edge executes push
+        top->host_push_req = 0;
+    } else {
+        spill_put(w);
+    }
+    return true;
+}
+
+// one pop of the queue head into popped; false if refused (empty, or dispatch mode)
+static bool pop_descriptor(uint32_t *popped, uint32_t *residency, uint32_t *ts) {
+    // in dispatch mode the distributor owns the queue head
+    bool is_valid = (top->valid_out != 0) && !dispatch_on;
+    if (!is_valid) {
+        top->host_pop_req = 1;
+        tick();
+        top->host_pop_req = 0;
+        return false;
+    }
+    // sample the head entry (data, timestamp, residency) before the
+    // pop edge moves the head on, then pulse pop_req for a cycle
+    for (int i = 0; i < TASK_WORDS; i++) popped[i] = bus_word(top->data_out, i);
+    *residency = top->residency;
+    *ts = top->data_ts;
+    top->host_pop_req = 1;
+    tick(); // rising edge triggers pop
+    top->host_pop_req = 0;
+    refill_from_spill(); // the freed entry goes to the oldest spilled task
+    head_pops = (head_pops + 1) & HEAD_IDX_MASK;
+    return true;
+}
+
+// Retire speculative pops: pop the head once for every entry a new POP_COMMIT
+// is ahead of head_pops. A commit at or behind head_pops is stale and dropped.
+static bool apply_pop_commit(volatile uint8_t *mmio) {
+    uint32_t commit = __atomic_load_n((volatile uint32_t *)(mmio + OFF_POP_COMMIT), __ATOMIC_ACQUIRE) & HEAD_IDX_MASK;
+    if (commit == commit_seen) return false;
+    commit_seen = commit;
+    uint32_t ahead = (commit - head_pops) & HEAD_IDX_MASK;
+    if (ahead > HEAD_IDX_MASK / 2) return false;   // behind: another path popped it
+    bool popped_any = false;
+    while (ahead-- > 0 && top->valid_out && !dispatch_on) {
+        uint32_t popped[TASK_WORDS], residency, ts;
+        pop_descriptor(popped, &residency, &ts);
+        popped_any = true;
+    }
+    if (popped_any) publish_status(mmio);
+    return popped_any;
+}
+
+// Serve every lane with a request pending, round-robin from the lane after the
+// one granted first last pass. A lane's CTRL is claimed with a compare-and-swap
+// to 0 before it is served; it fails only if the host withdrew the request.
+static unsigned lane_rr = 0;
+
+static bool serve_lanes(volatile uint8_t *mmio) {
+    unsigned first = MMIO_LANES;
+    for (unsigned k = 0; k < MMIO_LANES; k++) {
+        unsigned lane = (lane_rr + k) % MMIO_LANES;
+        size_t base = OFF_LANES + LANE_STRIDE * lane;
+        volatile uint32_t *ctrl = (volatile uint32_t *)(mmio + base + L_CTRL);
+        uint32_t req = __atomic_load_n(ctrl, __ATOMIC_ACQUIRE);
+        if (!(req & 0x3)) continue;
+        if (!__atomic_compare_exchange_n(ctrl, &req, 0u, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) continue;
+
+        uint32_t ack;
+        if (req & 0x1) {
+            uint32_t w[TASK_WORDS] = {0};
+            w[0] = mmio_read32(mmio, base + L_DATA_IN);
+            ack = push_descriptor(mmio, w) ? 0x1 : 0x2;   // PUSH_OK / PUSH_REFUSED
+        } else {
+            uint32_t popped[TASK_WORDS], residency, ts;
+            ack = 0x8;                                     // POP_REFUSED
+            if (pop_descriptor(popped, &residency, &ts)) {
+                mmio_write32(mmio, base + L_DATA_OUT, popped[0]);
+                ack = 0x4;                                 // POP_OK
+            }
+        }
+        publish_status(mmio);
+        __atomic_store_n((volatile uint32_t *)(mmio + base + L_ACK), ack, __ATOMIC_RELEASE);
+        if (first == MMIO_LANES) first = lane;
+    }
+    if (first == MMIO_LANES) return false;
+    lane_rr = (first + 1) % MMIO_LANES;
+    return true;
+}
+
+// create or open a shared file of the given size and mmap it, return pointer
+volatile uint8_t *mmio_map_or_die(const char *path, size_t size) {
     int fd = open(path, O_RDWR | O_CREAT, 0666);
     if (fd < 0) {
         perror("open mmio file");
         exit(1);
     }
-    if (ftruncate(fd, MMIO_SIZE) != 0) {
+    if (ftruncate(fd, size) != 0) {
         perror("ftruncate mmio file");
         exit(1);
     }
-    void *ptr = mmap(NULL, MMIO_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     if (ptr == MAP_FAILED) {
         perror("mmap");
         exit(1);
@@ -81,11 +642,40 @@ volatile uint8_t *mmio_map_or_die(const char *path) {
     return (volatile uint8_t *)ptr;
 }
 
+// bridge options (see the header comment); Verilator's own +args pass through
+static int pin_cpu = -1;
+static bool busy_poll = false;
+
+static void parse_bridge_args(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            pin_cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--busy-poll") == 0) {
+            busy_poll = true;
+        }
+    }
+}
+
+static void pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("sched_setaffinity");
+        exit(1);
+    }
+}
+
 int main(int argc, char **argv) {
     Verilated::commandArgs(argc, argv);
+    parse_bridge_args(argc, argv);
+    if (pin_cpu >= 0) pin_to_cpu(pin_cpu);
 
     // map mmio file (creates file if missing)
-    volatile uint8_t *mmio = mmio_map_or_die(MMIO_FILE);
+    volatile uint8_t *mmio = mmio_map_or_die(MMIO_FILE, MMIO_SIZE);
+    mmio_base = mmio;
+    // spill ring in host memory; only the bridge touches it
+    spill_ring = (uint32_t *)mmio_map_or_die(SPILL_FILE, SPILL_SIZE);
 
     // zero region
     memset((void*)mmio, 0, MMIO_SIZE);
@@ -103,7 +693,19 @@ int main(int argc, char **argv) {
     top->host_mode = 1;
     top->host_push_req = 0;
     top->host_pop_req = 0;
-    top->host_data_in = 0;
+    top->host_push_at = 0;
+    top->host_release = 0;
+    load_descriptor(mmio, 0x04, OFF_DATA_IN_HI);   // region is zeroed: all-zero descriptor
+    top->dispatch_mode = 0;
+    top->follower_ready = 0;
+    top->credit_return = 0;
+    top->cpl_valid = 0;
+    top->cq_pop = 0;
+    top->host_join_reg = 0;
+    top->host_join_slot = 0;
+    top->host_join_count = 0;
+    top->wm_we = 0;
+    top->perf_clear = 0;
     top->tb_done = 0;
     top->eval();
     tfp->dump(tick_count++);
@@ -112,14 +714,27 @@ int main(int argc, char **argv) {
     for (int i=0;i<4;i++) tick();
     top->reset = 0;
     tick();
+    mmio_write32(mmio, OFF_DESC_WORDS, TASK_WORDS);
+    mmio_write32(mmio, OFF_WM_HIGH, QUEUE_DEPTH);  // almost_full == full
+    mmio_write32(mmio, OFF_WM_LOW, 0);            // almost_empty == empty
+    mmio_write32(mmio, OFF_SPILL_CAP, SPILL_SLOTS);
+    mmio_write32(mmio, OFF_TIMER_HORIZON, TIMER_SLOTS - 1);
+    mmio_write32(mmio, OFF_NUM_FOLLOWERS, NUM_FOLLOWERS);
+    mmio_write32(mmio, OFF_CQ_SLOTS, CQ_SLOTS);
+    mmio_write32(mmio, OFF_JOIN_SLOTS, JOIN_SLOTS);
+    mmio_write32(mmio, OFF_NUM_LANES, MMIO_LANES);
+    mmio_write32(mmio, OFF_BRIDGE_MODE, (pin_cpu >= 0 ? 0x1 : 0) | (busy_poll ? 0x2 : 0));
+    mmio_write32(mmio, OFF_BRIDGE_CPU, sched_getcpu() + 1);
+    apply_watermarks(mmio);
+    publish_status(mmio);
+    publish_perf(mmio);
 
     // Main loop: poll MMIO for requests until tb_done is set by SW or until ctrl-c
     cout << "[hw] MMIO bridge running. MMIO file: " << MMIO_FILE << endl;
+    if (pin_cpu >= 0) cout << "[hw] pinned to CPU " << pin_cpu << endl;
+    if (busy_poll) cout << "[hw] busy-poll mode" << endl;
     while (true) {
-        uint32_t ctrl = mmio_read32(mmio, 0x00);
-        uint32_t data_in = mmio_read32(mmio, 0x04);
-        uint32_t ack = mmio_read32(mmio, 0x08);
-        uint32_t status = mmio_read32(mmio, 0x0C);
+        uint32_t ctrl = __atomic_load_n((volatile uint32_t *)(mmio + 0x00), __ATOMIC_ACQUIRE);
         uint32_t tb_done = mmio_read32(mmio, 0x14);
 
         // If software asked to stop, break
@@ -130,82 +745,119 @@ int main(int argc, char **argv) {
 
         bool did_something = false;
 
+        apply_watermarks(mmio);
+        apply_dispatch(mmio);
+
         // Handle push request
-        if (ctrl & 0x1) {
-            // check current full status
-            // sample DUT signals
-            // tick once without asserting host push to get up-to-date status
-            // (but take immediate status as of now)
-            bool is_full = (top->full != 0);
-            if (is_full) {
-                // refuse push
-                uint32_t new_ack = mmio_read32(mmio, 0x08);
-                new_ack |= 0x2; // PUSH_REFUSED
-                mmio_write32(mmio, 0x08, new_ack);
-                // clear ctrl
-                msync((void*)mmio, MMIO_SIZE, MS_SYNC);
-                mmio_write32(mmio, 0x00, ctrl & ~0x1);
-                did_something = true;
-            } else {
-                // perform push by pulsing host_push_req for one cycle
-                top->host_data_in = data_in;
-                top->host_push_req = 1;
-                tick(); // rising edge executes push
-                top->host_push_req = 0;
-                // set ACK push_ok
-                uint32_t new_ack = mmio_read32(mmio, 0x08);
-                new_ack |= 0x1; // PUSH_OK
-                mmio_write32(mmio, 0x08, new_ack);
-                // clear ctrl
-                mmio_write32(mmio, 0x00, ctrl & ~0x1);
-                did_something = true;
+        if ((ctrl & 0x1) && claim_request(mmio, 0x1)) {
+            // route on the immediate full / spill state as of now
+            uint32_t w[TASK_WORDS];
+            read_descriptor(mmio, 0x04, OFF_DATA_IN_HI, w);
+            bool pushed = push_descriptor(mmio, w);
+            publish_status(mmio);
+            complete_request(mmio, pushed ? 0x1 : 0x2); // PUSH_OK / PUSH_REFUSED
+            did_something = true;
+        }
+
+        // Handle delayed push: the timer wheel decides acceptance in the cycle
+        // the request is presented, so sample timer_push_ok before the edge
+        if ((ctrl & 0x8) && claim_request(mmio, 0x8)) {
+            load_descriptor(mmio, 0x04, OFF_DATA_IN_HI);
+            top->host_release = mmio_read32(mmio, OFF_RELEASE);
+            top->host_push_at = 1;
+            top->host_push_req = 1;
+            top->eval();
+            bool accepted = top->timer_push_ok;
+            tick();
+            top->host_push_req = 0;
+            top->host_push_at = 0;
+            publish_status(mmio);
+            complete_request(mmio, accepted ? 0x1 : 0x2); // PUSH_OK / PUSH_REFUSED
+            did_something = true;
+        }
+
+        // Handle join registration, decided combinationally like a delayed push
+        if ((ctrl & 0x10) && claim_request(mmio, 0x10)) {
+            uint32_t slot = mmio_read32(mmio, OFF_JOIN_SLOT);
+            uint32_t count = mmio_read32(mmio, OFF_JOIN_COUNT);
+            bool accepted = false;
+            if (slot < JOIN_SLOTS && count <= 0xFF) {
+                load_descriptor(mmio, 0x04, OFF_DATA_IN_HI);
+                top->host_join_slot = slot;
+                top->host_join_count = count;
+                top->host_join_reg = 1;
+                top->eval();
+                accepted = top->join_reg_ok;
+                tick();
+                top->host_join_reg = 0;
+            }
+            publish_status(mmio);
+            complete_request(mmio, accepted ? 0x1 : 0x2); // PUSH_OK / PUSH_REFUSED
+            did_something = true;
+        }
+
+        // Handle batch push: one descriptor per cycle from the batch window until
+        // the batch is exhausted or the queue (FIFO, plus the ring when spilling)
+        // fills. CREDITS only bounds what the host sends: timer and join releases
+        // and lane pushes may take room first, so a credit-sized batch can be cut short.
+        if ((ctrl & 0x4) && claim_request(mmio, 0x4)) {
+            uint32_t n = mmio_read32(mmio, OFF_BATCH_LEN);
+            if (n > BATCH_MAX / TASK_WORDS) n = BATCH_MAX / TASK_WORDS;
+            uint32_t accepted = 0;
+            PushRoute route;
+            while (accepted < n && (route = route_push(mmio)) != ROUTE_REFUSE) {
+                size_t off = OFF_BATCH_WIN + 4 * TASK_WORDS * accepted;
+                uint32_t w[TASK_WORDS];
+                read_descriptor(mmio, off, off + 4, w);
+                if (route == ROUTE_FIFO) {
+                    bus_set(top->host_data_in, w, TASK_WORDS);
+                    top->host_push_req = 1;
+                    tick();
+                    top->host_push_req = 0;
+                } else {
+                    spill_put(w);
+                }
+                accepted++;
             }
+            publish_status(mmio);
+            mmio_write32(mmio, OFF_BATCH_ACC, accepted);
+            complete_request(mmio, 0x10); // BATCH_DONE
+            did_something = true;
         }
 
         // Handle pop request
-        if (ctrl & 0x2) {
-            // check current valid
-            bool is_valid = (top->valid_out != 0);
-            if (!is_valid) {
-                // refuse pop
-                uint32_t new_ack = mmio_read32(mmio, 0x08);
-                new_ack |= 0x8; // POP_REFUSED
-                mmio_write32(mmio, 0x08, new_ack);
-                // clear ctrl
-                mmio_write32(mmio, 0x00, ctrl & ~0x2);
-                did_something = true;
-            } else {
-                // pulse pop_req for a cycle and capture the popped data
-                top->host_pop_req = 1;
-                tick(); // rising edge triggers pop
-                // read data_out sample
-                uint32_t popped = (uint32_t) (top->data_out & 0xFFFFFFFF);
-                // write DATA_OUT
-                mmio_write32(mmio, 0x10, popped);
-                // set ack pop_ok
-                uint32_t new_ack = mmio_read32(mmio, 0x08);
-                new_ack |= 0x4; // POP_OK
-                mmio_write32(mmio, 0x08, new_ack);
-                // clear ctrl
-                mmio_write32(mmio, 0x00, ctrl & ~0x2);
-                top->host_pop_req = 0;
-                did_something = true;
+        if ((ctrl & 0x2) && claim_request(mmio, 0x2)) {
+            uint32_t popped[TASK_WORDS], residency, ts;
+            bool popped_ok = pop_descriptor(popped, &residency, &ts);
+            if (popped_ok) {
+                mmio_write32(mmio, 0x10, popped[0]);
+                for (int i = 1; i < TASK_WORDS; i++) mmio_write32(mmio, OFF_DATA_OUT_HI + 4 * (i - 1), popped[i]);
+                mmio_write32(mmio, OFF_RESIDENCY, residency);
+                mmio_write32(mmio, OFF_DATA_TS, ts);
             }
+            publish_status(mmio);
+            complete_request(mmio, popped_ok ? 0x4 : 0x8); // POP_OK / POP_REFUSED
+            did_something = true;
         }
 
+        if (apply_pop_commit(mmio)) did_something = true;
+        if (serve_lanes(mmio)) did_something = true;
+
         // if we didn't do push/pop, advance one idle cycle to keep simulation moving
         if (!did_something) {
             tick();
         }
 
-        // update status register (full / valid)
-        uint32_t status_bits = 0;
-        if (top->full) status_bits |= 0x1;
-        if (top->valid_out) status_bits |= 0x2;
-        mmio_write32(mmio, 0x0C, status_bits);
+        // keep the FIFO topped up from the ring (also drains it if spilling was turned off)
+        refill_from_spill();
+
+        // update status register (full / valid), credits and perf counters
+        publish_status(mmio);
+        publish_perf(mmio);
+        mmio_write32(mmio, OFF_BRIDGE_CPU, sched_getcpu() + 1);
 
         // small msync to flush mmio to file (helps other process see updates)
-        msync((void*)mmio, MMIO_SIZE, MS_SYNC);
+        if (!busy_poll) msync((void*)mmio, MMIO_SIZE, MS_SYNC);
 
         // small sleep to avoid busy-wait burning CPU if desired (commented out for max speed)
         // usleep(10);
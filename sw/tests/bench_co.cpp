@@ -0,0 +1,195 @@
+// sw/tests/bench_co.cpp
+// Dispatch rate of the coroutine front end (src/task_queue_co.hpp) against the
+// blocking C API. Needs the sw/sw_hw bridge, like bench_mmio_host; the bridge's
+// follower models consume the tasks (dispatch mode), so the leader only pushes.
+//   dispatch    push --tasks task IDs: blocking mmio_push vs 1/16/256 streams
+//   roundtrip   push, then wait for that task's completion from the ring:
+//               blocking (one task at a time) vs 1/16/256 streams
+// Results are written to logs/bench_co.json in the bench_mmio_host layout.
+#include "../src/task_queue_co.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+struct BenchEntry {
+    std::string bench;
+    std::string key;
+    double value;
+};
+static std::vector<BenchEntry> bench_results;
+
+static void bench_record(const std::string &bench, const char *key, double value) {
+    bench_results.push_back({bench, key, value});
+}
+
+static void write_bench_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("open bench_co.json");
+        return;
+    }
+    fprintf(f, "{\n");
+    for (size_t i = 0; i < bench_results.size(); i++) {
+        const BenchEntry &e = bench_results[i];
+        bool first = i == 0 || bench_results[i-1].bench != e.bench;
+        bool last = i + 1 == bench_results.size() || bench_results[i+1].bench != e.bench;
+        if (first) fprintf(f, "  \"%s\": {\n", e.bench.c_str());
+        fprintf(f, "    \"%s\": %.6g%s\n", e.key.c_str(), e.value, last ? "" : ",");
+        if (last) fprintf(f, "  }%s\n", i + 1 == bench_results.size() ? "" : ",");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+static const char *arg_value(int argc, char **argv, const char *flag) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], flag) == 0) return argv[i+1];
+    }
+    return nullptr;
+}
+
+static double clock_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double now_ns() { return clock_ns(CLOCK_MONOTONIC); }
+static double cpu_ns() { return clock_ns(CLOCK_THREAD_CPUTIME_ID); }
+
+static void drain_ring() {
+    mmio_completion c[64];
+    while (mmio_drain_completions(c, 64) > 0) {}
+}
+
+static void report(const std::string &name, unsigned streams, unsigned long tasks, unsigned long errors,
+                   double wall, double cpu, unsigned long round_trips) {
+    double rate = wall > 0 ? tasks / (wall / 1e9) : 0.0;
+    printf("[SW] %s: tasks=%lu tasks_per_sec=%.0f leader_cpu_us/task=%.2f handshakes/task=%.2f errors=%lu\n",
+           name.c_str(), tasks, rate, tasks ? cpu / tasks / 1e3 : 0.0, tasks ? (double)round_trips / tasks : 0.0, errors);
+    bench_record(name, "streams", streams);
+    bench_record(name, "tasks", (double)tasks);
+    bench_record(name, "wall_ns", wall);
+    bench_record(name, "tasks_per_sec", rate);
+    bench_record(name, "leader_cpu_us_per_task", tasks ? cpu / tasks / 1e3 : 0.0);
+    bench_record(name, "handshakes_per_task", tasks ? (double)round_trips / tasks : 0.0);
+    bench_record(name, "errors", (double)errors);
+}
+
+static unsigned long handshakes() {
+    mmio_stats st;
+    mmio_get_stats(&st);
+    return st.round_trips;
+}
+
+// ---- blocking C API ----
+
+static void run_blocking(bool roundtrip, unsigned ntasks, uint32_t svc) {
+    std::string name = roundtrip ? "roundtrip_blocking" : "dispatch_blocking";
+    mmio_set_dispatch(true, roundtrip, svc);
+    drain_ring();
+    mmio_reset_stats();
+    unsigned long errors = 0;
+    double t0 = now_ns(), c0 = cpu_ns();
+    for (unsigned i = 0; i < ntasks; i++) {
+        int r;
+        while ((r = mmio_push(i, 1000)) == -1) {}
+        if (r != 0) {
+            errors++;
+            break;
+        }
+        if (!roundtrip) continue;
+        // wait for this task, one ring pass per millisecond like the driver's handshakes
+        bool seen = false;
+        for (int waited = 0; !seen && waited < 5000; waited++) {
+            mmio_completion c[64];
+            unsigned n = mmio_drain_completions(c, 64);
+            for (unsigned k = 0; k < n; k++) seen |= c[k].task == i;
+            if (!seen) {
+                struct timespec ts = {0, 1000000};
+                nanosleep(&ts, nullptr);
+            }
+        }
+        if (!seen) errors++;
+    }
+    double wall = now_ns() - t0, cpu = cpu_ns() - c0;
+    mmio_set_dispatch(false, false, 0);
+    report(name, 1, ntasks, errors, wall, cpu, handshakes());
+}
+
+// ---- coroutine streams ----
+
+static tq::Task dispatch_stream(tq::Poller &p, uint32_t first, unsigned count, unsigned long &errors) {
+    for (unsigned i = 0; i < count; i++) {
+        int r;
+        while ((r = co_await p.push(first + i)) == -1) {}
+        if (r != 0) {
+            errors++;
+            co_return;
+        }
+    }
+}
+
+static tq::Task roundtrip_stream(tq::Poller &p, uint32_t first, unsigned count, unsigned long &errors) {
+    for (unsigned i = 0; i < count; i++) {
+        int r;
+        while ((r = co_await p.push(first + i)) == -1) {}
+        if (r != 0) {
+            errors++;
+            co_return;
+        }
+        mmio_completion c = co_await p.done(first + i);
+        if (c.task != first + i) errors++;
+    }
+}
+
+static void run_streams(bool roundtrip, unsigned streams, unsigned ntasks, uint32_t svc) {
+    std::string name = std::string(roundtrip ? "roundtrip_co_s" : "dispatch_co_s") + std::to_string(streams);
+    mmio_set_dispatch(true, roundtrip, svc);
+    drain_ring();
+    mmio_reset_stats();
+    unsigned long errors = 0;
+    unsigned per = ntasks / streams ? ntasks / streams : 1;
+    tq::Poller p;
+    for (unsigned s = 0; s < streams; s++) {
+        // distinct IDs per stream, so completions route back to their stream
+        uint32_t first = s * per;
+        p.spawn(roundtrip ? roundtrip_stream(p, first, per, errors) : dispatch_stream(p, first, per, errors));
+    }
+    double t0 = now_ns(), c0 = cpu_ns();
+    p.run();
+    double wall = now_ns() - t0, cpu = cpu_ns() - c0;
+    mmio_set_dispatch(false, false, 0);
+    report(name, streams, (unsigned long)per * streams, errors + p.stats().timeouts, wall, cpu, handshakes());
+}
+
+int main(int argc, char **argv) {
+    const char *path = arg_value(argc, argv, "--mmio");
+    if (!path) path = getenv("MMIO_PATH");
+    if (mmio_init(path) != 0) {
+        fprintf(stderr, "Could not open MMIO file; start the sw/sw_hw bridge first or pass --mmio <path>.\n");
+        return 1;
+    }
+    const char *v;
+    unsigned ntasks = 2048;
+    uint32_t svc = 4;
+    if ((v = arg_value(argc, argv, "--tasks"))) ntasks = (unsigned)strtoul(v, nullptr, 0);
+    if ((v = arg_value(argc, argv, "--svc"))) svc = (uint32_t)strtoul(v, nullptr, 0);
+    const unsigned stream_counts[] = {1, 16, 256};
+
+    run_blocking(false, ntasks, svc);
+    for (unsigned s : stream_counts) run_streams(false, s, ntasks, svc);
+    // the blocking round trip sleeps per task; keep its count small
+    run_blocking(true, ntasks / 8 ? ntasks / 8 : 1, svc);
+    for (unsigned s : stream_counts) run_streams(true, s, ntasks, svc);
+
+    mkdir("logs", 0755);
+    write_bench_json("logs/bench_co.json");
+    printf("Results in logs/bench_co.json\n");
+    mmio_close();
+    return 0;
+}
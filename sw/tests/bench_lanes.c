@@ -0,0 +1,211 @@
+// sw/tests/bench_lanes.c
+// Aggregate throughput of concurrent host clients on one queue. Needs the
+// sw/sw_hw bridge, like bench_mmio_host. Each client thread runs --ops
+// push/pop pairs; the client count is swept 1, 2, 4, ... up to --max-clients.
+//   locked  every client goes through the shared CTRL/ACK handshake
+//           (mmio_push / mmio_pop) under one mutex, the only safe way before lanes
+//   lanes   every client owns a request lane (mmio_lane_open) and the bridge
+//           arbitrates among them
+// Pushed and popped words are summed per run (the remainder is drained at the
+// end), so a lost or duplicated task shows up as a checksum mismatch. Results
+// go to logs/bench_lanes.json in the bench_mmio_host layout.
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/task_queue_mmio.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define MAX_BENCH_RESULTS 256
+#define MAX_CLIENTS MMIO_MAX_LANES
+
+struct bench_entry {
+    char bench[32];
+    char key[48];
+    double value;
+};
+static struct bench_entry bench_results[MAX_BENCH_RESULTS];
+static int n_bench_results = 0;
+
+static void bench_record(const char *bench, const char *key, double value) {
+    if (n_bench_results >= MAX_BENCH_RESULTS) return;
+    struct bench_entry *e = &bench_results[n_bench_results++];
+    snprintf(e->bench, sizeof(e->bench), "%s", bench);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    e->value = value;
+}
+
+static void write_bench_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("open bench_lanes.json");
+        return;
+    }
+    fprintf(f, "{\n");
+    for (int i = 0; i < n_bench_results; i++) {
+        const struct bench_entry *e = &bench_results[i];
+        int first = (i == 0) || strcmp(bench_results[i-1].bench, e->bench) != 0;
+        int last = (i + 1 == n_bench_results) || strcmp(bench_results[i+1].bench, e->bench) != 0;
+        if (first) fprintf(f, "  \"%s\": {\n", e->bench);
+        fprintf(f, "    \"%s\": %.6g%s\n", e->key, e->value, last ? "" : ",");
+        if (last) fprintf(f, "  }%s\n", (i + 1 == n_bench_results) ? "" : ",");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+static const char *arg_value(int argc, char **argv, const char *flag) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], flag) == 0) return argv[i+1];
+    }
+    return NULL;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static pthread_mutex_t driver_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct client {
+    pthread_t tid;
+    unsigned id, ops;
+    int use_lane;
+    int lane;
+    uint64_t pushed_sum, popped_sum;
+    unsigned long handshakes, refused, errors;
+};
+
+static int client_push(struct client *c, uint32_t v) {
+    if (c->use_lane) return mmio_lane_push(c->lane, v, 1000);
+    pthread_mutex_lock(&driver_lock);
+    int r = mmio_push(v, 1000);
+    pthread_mutex_unlock(&driver_lock);
+    return r;
+}
+
+static int client_pop(struct client *c, uint32_t *v) {
+    if (c->use_lane) return mmio_lane_pop(c->lane, v, 1000);
+    pthread_mutex_lock(&driver_lock);
+    int r = mmio_pop(v, 1000);
+    pthread_mutex_unlock(&driver_lock);
+    return r;
+}
+
+// push/pop pairs; a refused pop (another client took the word) is not retried
+static void *client_main(void *arg) {
+    struct client *c = arg;
+    for (unsigned i = 0; i < c->ops && c->errors == 0; i++) {
+        uint32_t v = (c->id << 24) | (i & 0xFFFFFF);
+        int r;
+        while ((r = client_push(c, v)) == -1) {
+            c->handshakes++;
+            c->refused++;
+        }
+        c->handshakes++;
+        if (r != 0) {
+            c->errors++;
+            break;
+        }
+        c->pushed_sum += v;
+        uint32_t out;
+        r = client_pop(c, &out);
+        c->handshakes++;
+        if (r == 0) c->popped_sum += out;
+        else if (r == -1) c->refused++;
+        else c->errors++;
+    }
+    return NULL;
+}
+
+static void run_lanes_bench(int use_lane, unsigned nclients, unsigned ops) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s_c%u", use_lane ? "lanes" : "locked", nclients);
+    struct client cl[MAX_CLIENTS];
+    memset(cl, 0, sizeof(cl));
+    while (mmio_pop(NULL, 10) == 0) {}
+
+    for (unsigned i = 0; i < nclients; i++) {
+        cl[i].id = i;
+        cl[i].ops = ops;
+        cl[i].use_lane = use_lane;
+        cl[i].lane = use_lane ? mmio_lane_open() : -1;
+        if (use_lane && cl[i].lane < 0) {
+            fprintf(stderr, "%s: no free lane for client %u\n", name, i);
+            for (unsigned k = 0; k < i; k++) mmio_lane_close(cl[k].lane);
+            return;
+        }
+    }
+    double t0 = now_ns();
+    for (unsigned i = 0; i < nclients; i++) pthread_create(&cl[i].tid, NULL, client_main, &cl[i]);
+    for (unsigned i = 0; i < nclients; i++) pthread_join(cl[i].tid, NULL);
+    double wall = now_ns() - t0;
+
+    uint64_t pushed = 0, popped = 0;
+    unsigned long handshakes = 0, refused = 0, errors = 0;
+    for (unsigned i = 0; i < nclients; i++) {
+        pushed += cl[i].pushed_sum;
+        popped += cl[i].popped_sum;
+        handshakes += cl[i].handshakes;
+        refused += cl[i].refused;
+        errors += cl[i].errors;
+        if (use_lane) mmio_lane_close(cl[i].lane);
+    }
+    uint32_t out;
+    while (mmio_pop(&out, 10) == 0) popped += out;
+
+    double rate = wall > 0 ? handshakes / (wall / 1e9) : 0.0;
+    int checksum_ok = pushed == popped;
+    printf("[SW] %s: clients=%u handshakes=%lu handshakes_per_sec=%.0f us/handshake/client=%.1f refused=%lu errors=%lu checksum=%s\n",
+           name, nclients, handshakes, rate, handshakes ? wall / 1e3 * nclients / handshakes : 0.0,
+           refused, errors, checksum_ok ? "ok" : "MISMATCH");
+    bench_record(name, "lanes", use_lane);
+    bench_record(name, "clients", nclients);
+    bench_record(name, "handshakes", (double)handshakes);
+    bench_record(name, "wall_ns", wall);
+    bench_record(name, "handshakes_per_sec", rate);
+    bench_record(name, "refused", (double)refused);
+    bench_record(name, "errors", (double)errors);
+    bench_record(name, "checksum_ok", checksum_ok);
+}
+
+int main(int argc, char **argv) {
+    const char *path = arg_value(argc, argv, "--mmio");
+    if (!path) path = getenv("MMIO_PATH");
+    if (mmio_init(path) != 0) {
+        fprintf(stderr, "Could not open MMIO file; start the sw/sw_hw bridge first or pass --mmio <path>.\n");
+        return 1;
+    }
+    const char *v;
+    unsigned ops = 200, max_clients = 16;
+    if ((v = arg_value(argc, argv, "--ops"))) ops = (unsigned)strtoul(v, NULL, 0);
+    if ((v = arg_value(argc, argv, "--max-clients"))) max_clients = (unsigned)strtoul(v, NULL, 0);
+    if (max_clients > mmio_num_lanes()) max_clients = mmio_num_lanes();
+    if (max_clients == 0) {
+        fprintf(stderr, "The bridge serves no request lanes (NUM_LANES is 0).\n");
+        mmio_close();
+        return 1;
+    }
+
+    // clients beyond the free cores time-share, but they mostly wait on the bridge
+    bench_record("host", "cpus", (double)sysconf(_SC_NPROCESSORS_ONLN));
+    bench_record("host", "lanes", mmio_num_lanes());
+    for (unsigned c = 1; c <= max_clients; c *= 2) {
+        run_lanes_bench(0, c, ops);
+        run_lanes_bench(1, c, ops);
+    }
+
+    mkdir("logs", 0755);
+    write_bench_json("logs/bench_lanes.json");
+    printf("Results in logs/bench_lanes.json\n");
+    mmio_close();
+    return 0;
+}
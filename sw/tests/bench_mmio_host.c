@@ -0,0 +1,899 @@
+// sw/tests/bench_mmio_host.c
+// Host-side MMIO protocol benchmarks. Needs the sw/sw_hw bridge running, like
+// test_task_queue_host. Select benchmarks with --bench <name> (or --bench all);
+// results are written to logs/bench.json as {"bench": {"key": value, ...}}.
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/task_queue_mmio.h"
+#include "../src/task_dispatch.h"
+#include "../src/task_hybrid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define MAX_BENCH_RESULTS 256
+
+struct bench_entry {
+    char bench[32];
+    char key[48];
+    double value;
+};
+static struct bench_entry bench_results[MAX_BENCH_RESULTS];
+static int n_bench_results = 0;
+
+static void bench_record(const char *bench, const char *key, double value) {
+    if (n_bench_results >= MAX_BENCH_RESULTS) return;
+    struct bench_entry *e = &bench_results[n_bench_results++];
+    snprintf(e->bench, sizeof(e->bench), "%s", bench);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    e->value = value;
+}
+
+static void write_bench_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("open bench.json");
+        return;
+    }
+    fprintf(f, "{\n");
+    for (int i = 0; i < n_bench_results; i++) {
+        const struct bench_entry *e = &bench_results[i];
+        int first = (i == 0) || strcmp(bench_results[i-1].bench, e->bench) != 0;
+        int last = (i + 1 == n_bench_results) || strcmp(bench_results[i+1].bench, e->bench) != 0;
+        if (first) fprintf(f, "  \"%s\": {\n", e->bench);
+        fprintf(f, "    \"%s\": %.6g%s\n", e->key, e->value, last ? "" : ",");
+        if (last) fprintf(f, "  }%s\n", (i + 1 == n_bench_results) ? "" : ",");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+static int bench_enabled(int argc, char **argv, const char *name) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], "--bench") == 0 &&
+            (strcmp(argv[i+1], name) == 0 || strcmp(argv[i+1], "all") == 0)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const char *arg_value(int argc, char **argv, const char *flag) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], flag) == 0) return argv[i+1];
+    }
+    return NULL;
+}
+
+static int has_flag(int argc, char **argv, const char *flag) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], flag) == 0) return 1;
+    }
+    return 0;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// CPU time consumed by the calling thread
+static double cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Pop up to n words and check them against the expected sequence numbers.
+static unsigned drain_some(unsigned n, uint32_t *next_expected, unsigned long *mismatches) {
+    unsigned popped = 0;
+    for (unsigned i = 0; i < n; i++) {
+        uint32_t out;
+        if (mmio_pop(&out, 100) != 0) break;
+        if (out != *next_expected) (*mismatches)++;
+        (*next_expected)++;
+        popped++;
+    }
+    return popped;
+}
+
+// Credit benchmark: a leader pushes bursts of `burst` tasks (more than the
+// queue depth) and a consumer pops `drain` tasks between bursts. The baseline
+// pushes one word per handshake until a push is refused; the credit mode reads
+// CREDITS and pushes exactly that many words as one batch. Reports refusal rate
+// and host round trips per task on the push side.
+static void run_credit_bench(const char *name, int use_credits, unsigned ntasks, unsigned burst, unsigned drain) {
+    uint32_t next_push = 1, next_expected = 1;
+    unsigned long mismatches = 0, push_attempts = 0, push_round_trips = 0, refused = 0;
+    struct mmio_stats before, after;
+    double push_ns = 0.0;
+    int stalls = 0;
+
+    // empty whatever a previous run left behind
+    while (mmio_pop(NULL, 10) == 0) {}
+
+    while (next_expected <= ntasks && stalls < 1000) {
+        uint32_t progress = next_push + next_expected;
+        unsigned want = burst;
+        if (next_push + want > ntasks + 1) want = ntasks + 1 - next_push;
+
+        mmio_get_stats(&before);
+        double t0 = now_ns();
+        if (use_credits) {
+            uint32_t credits = mmio_credits();
+            if (want > credits) want = credits;
+            if (want > mmio_batch_capacity()) want = mmio_batch_capacity();
+            if (want > 0) {
+                uint32_t vals[MMIO_BATCH_MAX];
+                unsigned acc = 0;
+                for (unsigned i = 0; i < want; i++) vals[i] = next_push + i;
+                mmio_push_batch(vals, want, &acc, 1000);
+                push_attempts += want;
+                next_push += acc;
+            }
+        } else {
+            for (unsigned i = 0; i < want; i++) {
+                push_attempts++;
+                if (mmio_push(next_push, 1000) != 0) break;
+                next_push++;
+            }
+        }
+        push_ns += now_ns() - t0;
+        mmio_get_stats(&after);
+        push_round_trips += (after.round_trips - before.round_trips) +
+                            (after.status_reads - before.status_reads);
+        refused += after.refused_pushes - before.refused_pushes;
+
+        drain_some(drain, &next_expected, &mismatches);
+        if (next_push > ntasks) {
+            // all pushed: drain the rest
+            drain_some(next_push - next_expected, &next_expected, &mismatches);
+        }
+        stalls = (next_push + next_expected == progress) ? stalls + 1 : 0;
+    }
+
+    double pushed = (double)(next_push - 1);
+    printf("[SW] %s: tasks=%u refusal_rate=%.3f round_trips/task=%.3f ns/task=%.0f mismatches=%lu\n",
+           name, ntasks, push_attempts ? (double)refused / push_attempts : 0.0,
+           pushed ? push_round_trips / pushed : 0.0, pushed ? push_ns / pushed : 0.0, mismatches);
+    bench_record(name, "tasks", ntasks);
+    bench_record(name, "burst", burst);
+    bench_record(name, "drain", drain);
+    bench_record(name, "push_attempts", (double)push_attempts);
+    bench_record(name, "refused_pushes", (double)refused);
+    bench_record(name, "refusal_rate", push_attempts ? (double)refused / push_attempts : 0.0);
+    bench_record(name, "round_trips_per_task", pushed ? push_round_trips / pushed : 0.0);
+    bench_record(name, "push_ns_per_task", pushed ? push_ns / pushed : 0.0);
+    bench_record(name, "mismatches", (double)mismatches);
+}
+
+static inline uint32_t desc_pattern(uint32_t seq, unsigned i) {
+    return i == 0 ? seq : seq * 0x9E3779B1u + i;
+}
+
+// Descriptor benchmark: move ndesc descriptors of `words` 32-bit words through
+// the queue in bursts (at most 4, and small enough that even the split form fits
+// in the empty queue), either as one wide push/pop per descriptor or split
+// into `words` single-word pushes/pops (what a 32-bit-only stack has to do).
+// Every word is checked on the way out. Reports descriptors per second and
+// MMIO round trips per descriptor.
+static void run_desc_bench(unsigned words, int split, unsigned ndesc) {
+    char name[32];
+    snprintf(name, sizeof(name), "desc%u_%s", words * 32, split ? "split" : "wide");
+    unsigned long mismatches = 0, failed = 0;
+    struct mmio_stats before, after;
+
+    while (mmio_pop(NULL, 10) == 0) {}
+    unsigned burst = mmio_credits() / words;
+    if (burst > 4) burst = 4;
+    if (burst == 0) burst = 1;
+    mmio_get_stats(&before);
+    double t0 = now_ns();
+
+    for (unsigned base = 1; base <= ndesc; base += burst) {
+        unsigned n = (ndesc + 1 - base < burst) ? ndesc + 1 - base : burst;
+        for (unsigned d = 0; d < n; d++) {
+            uint32_t w[MMIO_DESC_MAX_WORDS];
+            for (unsigned i = 0; i < words; i++) w[i] = desc_pattern(base + d, i);
+            if (split) {
+                for (unsigned i = 0; i < words; i++) {
+                    if (mmio_push(w[i], 1000) != 0) failed++;
+                }
+            } else if (mmio_push_desc(w, words, 1000) != 0) {
+                failed++;
+            }
+        }
+        for (unsigned d = 0; d < n; d++) {
+            uint32_t w[MMIO_DESC_MAX_WORDS];
+            if (split) {
+                for (unsigned i = 0; i < words; i++) {
+                    if (mmio_pop(&w[i], 1000) != 0) failed++;
+                }
+            } else if (mmio_pop_desc(w, MMIO_DESC_MAX_WORDS, 1000) != 0) {
+                failed++;
+                continue;
+            }
+            for (unsigned i = 0; i < words; i++) {
+                if (w[i] != desc_pattern(base + d, i)) mismatches++;
+            }
+        }
+    }
+
+    double elapsed = now_ns() - t0;
+    mmio_get_stats(&after);
+    double trips = (double)(after.round_trips - before.round_trips) / ndesc;
+    double rate = elapsed > 0 ? ndesc / (elapsed * 1e-9) : 0.0;
+    printf("[SW] %s: descriptors=%u desc/s=%.0f round_trips/desc=%.2f failed=%lu mismatches=%lu\n",
+           name, ndesc, rate, trips, failed, mismatches);
+    bench_record(name, "descriptor_bits", words * 32);
+    bench_record(name, "descriptors", ndesc);
+    bench_record(name, "descriptors_per_sec", rate);
+    bench_record(name, "bytes_per_sec", rate * words * 4);
+    bench_record(name, "round_trips_per_desc", trips);
+    bench_record(name, "failed_ops", (double)failed);
+    bench_record(name, "mismatches", (double)mismatches);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Spill benchmark: every `period` rounds the leader generates a burst of `burst`
+// tasks (more than the queue depth) and tries to push everything generated so
+// far; each round a consumer pops up to `drain` tasks. The baseline stops at the
+// first refused push and retries it next round, so the backlog waits on the
+// host; the spill mode lets the bridge park the overflow in its host-memory ring
+// and refill the FIFO from it. Latency runs from generation to pop. Reports
+// retries, push cost, latency percentiles and how much traffic went through the ring.
+static void run_spill_bench(const char *name, int spill, unsigned ntasks, unsigned burst,
+                            unsigned period, unsigned drain) {
+    double *gen_ns = calloc(ntasks + 1, sizeof(double));
+    double *lat_ns = calloc(ntasks, sizeof(double));
+    if (!gen_ns || !lat_ns) {
+        perror("calloc");
+        exit(1);
+    }
+    uint32_t next_gen = 1, next_push = 1, next_expected = 1;
+    unsigned long mismatches = 0, push_attempts = 0;
+    unsigned n_lat = 0, round = 0, peak_spill = 0;
+    int stalls = 0;
+    double push_ns = 0.0;
+    struct mmio_stats before, after;
+    struct mmio_spill_stats s0, s1;
+
+    if (mmio_set_spill(spill) != 0) return;
+    while (mmio_pop(NULL, 10) == 0) {}
+    mmio_get_spill_stats(&s0);
+    mmio_get_stats(&before);
+    double t_start = now_ns();
+
+    while (next_expected <= ntasks && stalls < 1000) {
+        uint32_t progress = next_push + next_expected;
+        if (round++ % period == 0) {
+            for (unsigned k = 0; k < burst && next_gen <= ntasks; k++) gen_ns[next_gen++] = now_ns();
+        }
+
+        // push the backlog in order; a refused task is retried next round
+        double t0 = now_ns();
+        while (next_push < next_gen) {
+            push_attempts++;
+            if (mmio_push(next_push, 1000) != 0) break;
+            next_push++;
+        }
+        push_ns += now_ns() - t0;
+        if (spill) {
+            mmio_get_spill_stats(&s1);
+            if (s1.occupancy > peak_spill) peak_spill = s1.occupancy;
+        }
+
+        for (unsigned i = 0; i < drain && next_expected < next_push; i++) {
+            uint32_t out;
+            if (mmio_pop(&out, 100) != 0) break;
+            if (out != next_expected) mismatches++;
+            lat_ns[n_lat++] = now_ns() - gen_ns[next_expected];
+            next_expected++;
+        }
+        stalls = (next_push + next_expected == progress && next_gen > ntasks) ? stalls + 1 : 0;
+    }
+
+    double elapsed = now_ns() - t_start;
+    mmio_get_stats(&after);
+    mmio_get_spill_stats(&s1);
+    mmio_set_spill(false);
+
+    double pushed = (double)(next_push - 1);
+    unsigned long refused = after.refused_pushes - before.refused_pushes;
+    uint32_t spilled = s1.spilled - s0.spilled, refilled = s1.refilled - s0.refilled;
+    double mean = 0.0;
+    for (unsigned i = 0; i < n_lat; i++) mean += lat_ns[i];
+    if (n_lat) mean /= n_lat;
+    qsort(lat_ns, n_lat, sizeof(double), cmp_double);
+    double p50 = n_lat ? lat_ns[n_lat / 2] : 0.0;
+    double p99 = n_lat ? lat_ns[(size_t)(n_lat * 0.99)] : 0.0;
+
+    printf("[SW] %s: tasks=%u refused=%lu retries/task=%.3f push_ns/task=%.0f latency_us mean=%.1f p50=%.1f p99=%.1f "
+           "spilled=%u refilled=%u peak_spill=%u mismatches=%lu\n",
+           name, ntasks, refused, pushed ? refused / pushed : 0.0, pushed ? push_ns / pushed : 0.0,
+           mean / 1e3, p50 / 1e3, p99 / 1e3, spilled, refilled, peak_spill, mismatches);
+    bench_record(name, "tasks", ntasks);
+    bench_record(name, "burst", burst);
+    bench_record(name, "period", period);
+    bench_record(name, "drain", drain);
+    bench_record(name, "push_attempts", (double)push_attempts);
+    bench_record(name, "refused_pushes", (double)refused);
+    bench_record(name, "retries_per_task", pushed ? refused / pushed : 0.0);
+    bench_record(name, "push_ns_per_task", pushed ? push_ns / pushed : 0.0);
+    bench_record(name, "latency_mean_us", mean / 1e3);
+    bench_record(name, "latency_p50_us", p50 / 1e3);
+    bench_record(name, "latency_p99_us", p99 / 1e3);
+    bench_record(name, "spilled", spilled);
+    bench_record(name, "refilled", refilled);
+    bench_record(name, "spill_fraction", pushed ? spilled / pushed : 0.0);
+    bench_record(name, "refills_per_sec", elapsed > 0 ? refilled / (elapsed * 1e-9) : 0.0);
+    bench_record(name, "peak_spill_occupancy", peak_spill);
+    bench_record(name, "mismatches", (double)mismatches);
+    free(gen_ns);
+    free(lat_ns);
+}
+
+// sum of the per-follower finished-task counters: the polling path
+static uint32_t poll_followers(unsigned nf) {
+    uint32_t sum = 0;
+    for (unsigned f = 0; f < nf; f++) {
+        uint32_t done;
+        if (mmio_follower_status(f, &done, NULL) == 0) sum += done;
+    }
+    return sum;
+}
+
+// Completion benchmark: the bridge's follower models execute every task
+// (svc cycles each) and the leader keeps up to `window` tasks outstanding.
+// Round-trip time runs from the push to the leader learning the task finished.
+// With the ring, the leader drains completions in bulk and matches each one to
+// its task. Without it, the leader polls every follower's counter and retires
+// that many of its oldest outstanding tasks (exact when tasks finish in order).
+static void run_completion_bench(const char *name, int use_ring, unsigned ntasks, unsigned window, uint32_t svc) {
+    double *push_ns = calloc(ntasks + 1, sizeof(double));
+    double *rtt_ns = calloc(ntasks, sizeof(double));
+    unsigned char *seen = calloc(ntasks + 1, 1);
+    if (!push_ns || !rtt_ns || !seen) {
+        perror("calloc");
+        exit(1);
+    }
+    unsigned nf = mmio_num_followers();
+    if (nf > MMIO_FOLLOWER_REGS) nf = MMIO_FOLLOWER_REGS;
+    struct mmio_completion cpl[64];
+    uint32_t next_push = 1, oldest = 1;
+    unsigned n_rtt = 0;
+    unsigned long mismatches = 0, polls = 0, drains = 0;
+
+    while (mmio_pop(NULL, 10) == 0) {}
+    while (mmio_drain_completions(cpl, 64) > 0) {}
+    uint32_t done_base = poll_followers(nf);
+    mmio_set_dispatch(true, use_ring, svc);
+    double t_start = now_ns(), t_last = t_start;
+
+    while (n_rtt < ntasks && now_ns() - t_last < 5e9) {
+        while (next_push <= ntasks && next_push - oldest < window) {
+            double t = now_ns();
+            if (mmio_push(next_push, 1000) != 0) break;
+            push_ns[next_push++] = t;
+        }
+        if (use_ring) {
+            unsigned n = mmio_drain_completions(cpl, 64);
+            double t = now_ns();
+            drains++;
+            for (unsigned i = 0; i < n; i++) {
+                uint32_t tid = cpl[i].task;
+                if (tid == 0 || tid >= next_push || seen[tid] || cpl[i].follower >= nf) {
+                    mismatches++;
+                    continue;
+                }
+                seen[tid] = 1;
+                rtt_ns[n_rtt++] = t - push_ns[tid];
+                t_last = t;
+            }
+            while (oldest < next_push && seen[oldest]) oldest++;
+        } else {
+            uint32_t done = poll_followers(nf) - done_base;
+            double t = now_ns();
+            polls++;
+            while (n_rtt < done && oldest < next_push) {
+                rtt_ns[n_rtt++] = t - push_ns[oldest++];
+                t_last = t;
+            }
+        }
+    }
+
+    double elapsed = now_ns() - t_start;
+    mmio_set_dispatch(false, false, 0);
+    if (n_rtt < ntasks) mismatches += ntasks - n_rtt;
+
+    double mean = 0.0;
+    for (unsigned i = 0; i < n_rtt; i++) mean += rtt_ns[i];
+    if (n_rtt) mean /= n_rtt;
+    qsort(rtt_ns, n_rtt, sizeof(double), cmp_double);
+    double p50 = n_rtt ? rtt_ns[n_rtt / 2] : 0.0;
+    double p99 = n_rtt ? rtt_ns[(size_t)(n_rtt * 0.99)] : 0.0;
+    double reads = use_ring ? (double)drains : (double)polls * nf;
+
+    printf("[SW] %s: tasks=%u window=%u followers=%u rtt_us mean=%.1f p50=%.1f p99=%.1f tasks/s=%.0f "
+           "status_reads/task=%.2f mismatches=%lu\n",
+           name, ntasks, window, nf, mean / 1e3, p50 / 1e3, p99 / 1e3,
+           elapsed > 0 ? n_rtt / (elapsed * 1e-9) : 0.0, n_rtt ? reads / n_rtt : 0.0, mismatches);
+    bench_record(name, "tasks", ntasks);
+    bench_record(name, "window", window);
+    bench_record(name, "followers", nf);
+    bench_record(name, "service_cycles", svc);
+    bench_record(name, "rtt_mean_us", mean / 1e3);
+    bench_record(name, "rtt_p50_us", p50 / 1e3);
+    bench_record(name, "rtt_p99_us", p99 / 1e3);
+    bench_record(name, "tasks_per_sec", elapsed > 0 ? n_rtt / (elapsed * 1e-9) : 0.0);
+    bench_record(name, "status_reads_per_task", n_rtt ? reads / n_rtt : 0.0);
+    bench_record(name, "mismatches", (double)mismatches);
+    free(push_ns);
+    free(rtt_ns);
+    free(seen);
+}
+
+// DAG benchmark: ntrees parallel reductions, one after another, each a binary
+// tree of `leaves` leaf tasks (heap order, root 1; task ID t * 4096 + n) run by
+// the bridge's follower models. In software mode the leader drains every
+// completion, counts children per node and pushes each ready parent. In join
+// mode it registers the internal nodes in hardware join slots, pushes the
+// leaves and waits for the root only. The leader sleeps 20 us whenever the
+// ring is empty, so its CPU time counts the work it does, not the waiting.
+static void run_dag_bench(const char *name, int hw_join, unsigned leaves, unsigned ntrees, uint32_t svc) {
+    if (hw_join && leaves - 1 > mmio_join_slots()) {
+        fprintf(stderr, "%s: %u internal nodes exceed %u join slots, skipped\n", name, leaves - 1, mmio_join_slots());
+        return;
+    }
+    unsigned char *kids = calloc(leaves, 1);
+    uint32_t *ready = calloc(leaves, sizeof(uint32_t));
+    if (!kids || !ready) {
+        perror("calloc");
+        exit(1);
+    }
+    struct mmio_completion cpl[64];
+    const struct timespec idle = {0, 20000};
+    unsigned long mismatches = 0, writes = 0, handled = 0, trees_done = 0;
+
+    while (mmio_pop(NULL, 10) == 0) {}
+    while (mmio_drain_completions(cpl, 64) > 0) {}
+    mmio_set_dispatch(true, true, svc);
+    double t0 = now_ns(), c0 = cpu_ns();
+
+    for (unsigned t = 0; t < ntrees; t++) {
+        uint32_t base = t * 4096;
+        unsigned nready = 0;
+        int root_done = 0;
+        double t_last = now_ns();
+        memset(kids, 0, leaves);
+        if (hw_join) {
+            for (unsigned n = leaves - 1; n >= 1; n--) {
+                uint32_t w = n == 1 ? base + 1 : MMIO_JOIN_CHILD(base + n, n / 2 - 1);
+                while (mmio_join_register(n - 1, 2, w, 1000) == -1) nanosleep(&idle, NULL);
+                writes++;
+            }
+        }
+        for (unsigned n = leaves; n < 2 * leaves; n++) {
+            uint32_t w = hw_join ? MMIO_JOIN_CHILD(base + n, n / 2 - 1) : base + n;
+            while (mmio_push(w, 1000) == -1) nanosleep(&idle, NULL);
+            writes++;
+        }
+        while (!root_done && now_ns() - t_last < 5e9) {
+            unsigned got = mmio_drain_completions(cpl, 64);
+            if (got == 0) {
+                nanosleep(&idle, NULL);
+                continue;
+            }
+            t_last = now_ns();
+            for (unsigned i = 0; i < got; i++) {
+                uint32_t n = cpl[i].task - base;
+                handled++;
+                if (cpl[i].task < base || n == 0 || n >= 2 * leaves || (hw_join && n != 1)) {
+                    mismatches++;
+                } else if (n == 1) {
+                    root_done = 1;
+                } else if (++kids[n / 2] == 2) {
+                    ready[nready++] = n / 2;
+                }
+            }
+            // push parents whose children are both done
+            while (nready > 0) {
+                uint32_t p = ready[--nready];
+                while (mmio_push(base + p, 1000) == -1) nanosleep(&idle, NULL);
+                writes++;
+            }
+        }
+        if (!root_done) {
+            mismatches++;
+            break;
+        }
+        trees_done++;
+    }
+
+    double wall = now_ns() - t0, cpu = cpu_ns() - c0;
+    mmio_set_dispatch(false, false, 0);
+    double per = trees_done ? 1.0 / trees_done : 0.0;
+
+    printf("[SW] %s: leaves=%u trees=%lu wall_us/tree=%.1f leader_cpu_us/tree=%.1f writes/tree=%.1f completions/tree=%.1f mismatches=%lu\n",
+           name, leaves, trees_done, wall * per / 1e3, cpu * per / 1e3, writes * per, handled * per, mismatches);
+    bench_record(name, "leaves", leaves);
+    bench_record(name, "trees", trees_done);
+    bench_record(name, "service_cycles", svc);
+    bench_record(name, "wall_us_per_tree", wall * per / 1e3);
+    bench_record(name, "leader_cpu_us_per_tree", cpu * per / 1e3);
+    bench_record(name, "writes_per_tree", writes * per);
+    bench_record(name, "completions_per_tree", handled * per);
+    bench_record(name, "mismatches", (double)mismatches);
+    free(kids);
+    free(ready);
+}
+
+// Batching policies: the leader stages tasks in a td_dispatcher while the
+// bridge's followers consume them (dispatch mode, svc cycles each). Bursty
+// sends `burst` tasks at once and then idles `gap_us`, polling the dispatcher;
+// saturation submits back to back. Latency is submit to queue acceptance.
+struct lat_log {
+    double *ns;
+    unsigned n, cap;
+};
+
+static void log_dispatch(uint32_t word, uint64_t wait_ns, void *ctx) {
+    struct lat_log *l = ctx;
+    (void)word;
+    if (l->n < l->cap) l->ns[l->n++] = (double)wait_ns;
+}
+
+static void run_adaptive_bench(const char *name, enum td_policy policy, unsigned batch,
+                               unsigned ntasks, unsigned burst, unsigned gap_us, uint32_t svc) {
+    static struct td_dispatcher d;
+    struct lat_log lat = { calloc(ntasks, sizeof(double)), 0, ntasks };
+    if (!lat.ns) {
+        perror("calloc");
+        exit(1);
+    }
+    while (mmio_pop(NULL, 10) == 0) {}
+    mmio_set_dispatch(true, false, svc);
+    td_init(&d, policy, batch, 2000000);
+    d.on_dispatch = log_dispatch;
+    d.ctx = &lat;
+    mmio_reset_stats();
+    const struct timespec idle = {0, 20000};
+
+    double t0 = now_ns();
+    for (unsigned i = 0; i < ntasks; i++) {
+        while (td_submit(&d, i) != 0) {
+            if (td_poll(&d) == 0) nanosleep(&idle, NULL);
+        }
+        td_poll(&d);
+        if (burst && (i + 1) % burst == 0) {
+            double until = now_ns() + gap_us * 1e3;
+            while (now_ns() < until) {
+                td_poll(&d);
+                nanosleep(&idle, NULL);
+            }
+        }
+    }
+    td_flush(&d, 5000);
+    double wall = now_ns() - t0;
+    mmio_set_dispatch(false, false, 0);
+
+    struct mmio_stats st;
+    mmio_get_stats(&st);
+    qsort(lat.ns, lat.n, sizeof(double), cmp_double);
+    double sum = 0;
+    for (unsigned i = 0; i < lat.n; i++) sum += lat.ns[i];
+    double mean = lat.n ? sum / lat.n : 0, p50 = lat.n ? lat.ns[lat.n / 2] : 0;
+    double p99 = lat.n ? lat.ns[(unsigned)(lat.n * 0.99)] : 0;
+    double rate = wall > 0 ? d.stats.dispatched / (wall / 1e9) : 0;
+    double per = d.stats.dispatched ? 1.0 / d.stats.dispatched : 0;
+
+    printf("[SW] %s: tasks=%lu tasks_per_sec=%.0f lat_us mean=%.1f p50=%.1f p99=%.1f batches/task=%.3f refused=%lu status_reads/task=%.2f final_batch=%u\n",
+           name, d.stats.dispatched, rate, mean / 1e3, p50 / 1e3, p99 / 1e3, d.stats.batches * per,
+           d.stats.refused, st.status_reads * per, d.batch);
+    bench_record(name, "policy", policy);
+    bench_record(name, "batch", batch);
+    bench_record(name, "tasks", (double)d.stats.dispatched);
+    bench_record(name, "lost", (double)(ntasks - d.stats.dispatched));
+    bench_record(name, "tasks_per_sec", rate);
+    bench_record(name, "lat_mean_us", mean / 1e3);
+    bench_record(name, "lat_p50_us", p50 / 1e3);
+    bench_record(name, "lat_p99_us", p99 / 1e3);
+    bench_record(name, "batches_per_task", d.stats.batches * per);
+    bench_record(name, "refused", (double)d.stats.refused);
+    bench_record(name, "status_reads_per_task", st.status_reads * per);
+    bench_record(name, "deadline_flushes", (double)d.stats.deadline_flushes);
+    bench_record(name, "final_batch", d.batch);
+    bench_record(name, "grows", (double)d.stats.grows);
+    bench_record(name, "shrinks", (double)d.stats.shrinks);
+    free(lat.ns);
+}
+
+// Hybrid benchmark: every gap_us a burst of `burst` tasks (more than the queue
+// depth) is released to the leader, which otherwise does its own work in 50 us
+// quanta; the bridge's followers consume the queue (dispatch mode). The spin
+// leader retries each refused mmio_push() until the FIFO takes it; the hybrid
+// leader hands tasks to hq_push() and calls hq_drain() between quanta. Latency
+// runs from release until the FIFO accepted the task; stall time is what the
+// leader spent inside push/drain calls instead of its own work.
+static void run_hybrid_bench(const char *name, int hybrid, unsigned ntasks, unsigned burst,
+                             unsigned gap_us, uint32_t svc) {
+    static struct hq q;
+    double *rel_ns = calloc(ntasks, sizeof(double));
+    double *lat_ns = calloc(ntasks, sizeof(double));
+    double *stall_burst = calloc(ntasks / burst + 1, sizeof(double));
+    if (!rel_ns || !lat_ns || !stall_burst || hq_init(&q, 4096, 1000) != 0) {
+        perror("hybrid bench setup");
+        exit(1);
+    }
+    while (mmio_pop(NULL, 10) == 0) {}
+    mmio_set_dispatch(true, false, svc);
+    mmio_reset_stats();
+
+    unsigned released = 0, accepted = 0, nbursts = 0;
+    unsigned long quanta = 0, errors = 0;
+    double stall = 0.0;
+    double t_start = now_ns(), next_burst = t_start;
+
+    while (accepted < ntasks && errors == 0) {
+        double t = now_ns();
+        if (released < ntasks && t >= next_burst) {
+            double s0 = now_ns();
+            for (unsigned k = 0; k < burst && released < ntasks; k++, released++) {
+                rel_ns[released] = next_burst;
+                int r;
+                if (hybrid) {
+                    r = hq_push(&q, released);
+                    if (r == 1) r = 0;
+                } else {
+                    while ((r = mmio_push(released, 1000)) == -1) {}
+                }
+                if (r != 0) {
+                    errors++;
+                    break;
+                }
+                // the FIFO takes tasks in release order; stamp everything it has taken so far
+                unsigned now_acc = hybrid ? (unsigned)(q.stats.direct + q.stats.drained) : released + 1;
+                for (double a = now_ns(); accepted < now_acc; accepted++) lat_ns[accepted] = a - rel_ns[accepted];
+            }
+            double ds = now_ns() - s0;
+            stall += ds;
+            stall_burst[nbursts++] = ds;
+            next_burst += gap_us * 1e3;
+            continue;
+        }
+        if (hybrid && hq_parked(&q) > 0) {
+            double s0 = now_ns();
+            hq_drain(&q);
+            unsigned now_acc = (unsigned)(q.stats.direct + q.stats.drained);
+            for (double a = now_ns(); accepted < now_acc; accepted++) lat_ns[accepted] = a - rel_ns[accepted];
+            stall += now_ns() - s0;
+        }
+        // the leader's own work
+        for (double until = now_ns() + 50e3; now_ns() < until;) {}
+        quanta++;
+    }
+    double wall = now_ns() - t_start;
+    mmio_set_dispatch(false, false, 0);
+
+    struct mmio_stats st;
+    mmio_get_stats(&st);
+    qsort(lat_ns, accepted, sizeof(double), cmp_double);
+    qsort(stall_burst, nbursts, sizeof(double), cmp_double);
+    double p50 = accepted ? lat_ns[accepted / 2] : 0.0;
+    double p99 = accepted ? lat_ns[(size_t)(accepted * 0.99)] : 0.0;
+    double lmax = accepted ? lat_ns[accepted - 1] : 0.0;
+    double stall_p99 = nbursts ? stall_burst[(size_t)(nbursts * 0.99)] : 0.0;
+    double per = accepted ? 1.0 / accepted : 0.0;
+
+    printf("[SW] %s: tasks=%u latency_us p50=%.1f p99=%.1f max=%.1f leader_stall_ms=%.1f stall_per_burst_ms p99=%.2f "
+           "work_fraction=%.2f refused=%lu handshakes/task=%.2f parked=%lu peak_parked=%u errors=%lu\n",
+           name, accepted, p50 / 1e3, p99 / 1e3, lmax / 1e3, stall / 1e6, stall_p99 / 1e6,
+           wall > 0 ? quanta * 50e3 / wall : 0.0, st.refused_pushes, st.round_trips * per,
+           q.stats.parked, q.stats.peak_parked, errors);
+    bench_record(name, "tasks", accepted);
+    bench_record(name, "burst", burst);
+    bench_record(name, "gap_us", gap_us);
+    bench_record(name, "latency_p50_us", p50 / 1e3);
+    bench_record(name, "latency_p99_us", p99 / 1e3);
+    bench_record(name, "latency_max_us", lmax / 1e3);
+    bench_record(name, "leader_stall_ms", stall / 1e6);
+    bench_record(name, "stall_per_burst_p99_ms", stall_p99 / 1e6);
+    bench_record(name, "leader_work_fraction", wall > 0 ? quanta * 50e3 / wall : 0.0);
+    bench_record(name, "refused_pushes", (double)st.refused_pushes);
+    bench_record(name, "handshakes_per_task", st.round_trips * per);
+    bench_record(name, "parked", (double)q.stats.parked);
+    bench_record(name, "peak_parked", q.stats.peak_parked);
+    bench_record(name, "errors", (double)errors);
+    hq_destroy(&q);
+    free(rel_ns);
+    free(lat_ns);
+    free(stall_burst);
+}
+
+// Peek benchmark: pop latency of the CTRL/ACK handshake (sleeping, then
+// busy-poll) against a take from the head mirror (mmio_pop_spec). Each round
+// pushes `fill` tasks in one batch and pops them one at a time, timing every
+// pop; the consumer spends work_us on each task before the next pop, which is
+// when the bridge retires a speculative take in the background.
+static void run_peek_bench(const char *name, int spec, int busy, unsigned npops, unsigned fill, unsigned work_us) {
+    double *lat_ns = calloc(npops, sizeof(double));
+    uint32_t words[MMIO_BATCH_MAX];
+    if (!lat_ns) {
+        perror("calloc");
+        exit(1);
+    }
+    if (fill > MMIO_BATCH_MAX) fill = MMIO_BATCH_MAX;
+    while (mmio_pop(NULL, 10) == 0) {}
+    mmio_set_busy_poll(busy);
+    mmio_reset_stats();
+
+    uint32_t next_push = 1, next_expected = 1;
+    unsigned n = 0;
+    unsigned long mismatches = 0, errors = 0;
+    double t_start = now_ns();
+    while (n < npops && errors == 0) {
+        unsigned k, acc = 0;
+        for (k = 0; k < fill && k < npops - n; k++) words[k] = next_push + k;
+        if (mmio_push_batch(words, k, &acc, 1000) != 0 && acc == 0) {
+            errors++;
+            break;
+        }
+        next_push += acc;
+        while (next_expected < next_push && n < npops) {
+            uint32_t out;
+            double t0 = now_ns();
+            int r = spec ? mmio_pop_spec(&out, 1000) : mmio_pop(&out, 1000);
+            lat_ns[n] = now_ns() - t0;
+            if (r != 0) {
+                errors++;
+                break;
+            }
+            if (out != next_expected) mismatches++;
+            next_expected++;
+            n++;
+            for (double until = now_ns() + work_us * 1e3; now_ns() < until;) {}
+        }
+    }
+    double wall = now_ns() - t_start;
+    // let the bridge retire the last take before anyone else pops
+    uint32_t v;
+    for (double until = now_ns() + 100e6; mmio_head_peek(&v) == 1 && now_ns() < until;) {}
+    mmio_set_busy_poll(false);
+
+    struct mmio_stats st;
+    mmio_get_stats(&st);
+    double mean = 0.0;
+    for (unsigned i = 0; i < n; i++) mean += lat_ns[i];
+    if (n) mean /= n;
+    qsort(lat_ns, n, sizeof(double), cmp_double);
+    double p50 = n ? lat_ns[n / 2] : 0.0;
+    double p99 = n ? lat_ns[(size_t)(n * 0.99)] : 0.0;
+    double per = n ? 1.0 / n : 0.0;
+
+    printf("[SW] %s: pops=%u pop_ns mean=%.0f p50=%.0f p99=%.0f pops_per_sec=%.0f handshakes/pop=%.2f "
+           "retire_waits/pop=%.2f mismatches=%lu errors=%lu\n",
+           name, n, mean, p50, p99, wall > 0 ? n / (wall * 1e-9) : 0.0, st.round_trips * per,
+           st.head_waits * per, mismatches, errors);
+    bench_record(name, "pops", n);
+    bench_record(name, "fill", fill);
+    bench_record(name, "work_us", work_us);
+    bench_record(name, "busy_poll", busy);
+    bench_record(name, "pop_ns_mean", mean);
+    bench_record(name, "pop_ns_p50", p50);
+    bench_record(name, "pop_ns_p99", p99);
+    bench_record(name, "pops_per_sec", wall > 0 ? n / (wall * 1e-9) : 0.0);
+    bench_record(name, "handshakes_per_pop", st.round_trips * per);
+    bench_record(name, "retire_waits_per_pop", st.head_waits * per);
+    bench_record(name, "mismatches", (double)mismatches);
+    bench_record(name, "errors", (double)errors);
+    free(lat_ns);
+}
+
+static void ensure_logs_dir(void) {
+    struct stat st;
+    if (stat("logs", &st) != 0) {
+        if (mkdir("logs", 0755) != 0) {
+            perror("mkdir logs");
+            exit(1);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = arg_value(argc, argv, "--mmio");
+    if (!path) path = getenv("MMIO_PATH");
+    if (mmio_init(path) != 0) {
+        fprintf(stderr, "Could not open MMIO file; start the sw/sw_hw bridge first or pass --mmio <path>.\n");
+        return 1;
+    }
+    ensure_logs_dir();
+
+    if (bench_enabled(argc, argv, "credit")) {
+        run_credit_bench("credit_baseline", 0, 2048, 24, 12);
+        run_credit_bench("credit_batched", 1, 2048, 24, 12);
+    }
+
+    if (bench_enabled(argc, argv, "desc")) {
+        // widths up to what the bridge was built with (make TASK_WIDTH=256 in sw/sw_hw)
+        for (unsigned words = 1; words <= mmio_desc_words(); words *= 2) {
+            run_desc_bench(words, 0, 512);
+            if (words > 1) run_desc_bench(words, 1, 512);
+        }
+    }
+
+    if (bench_enabled(argc, argv, "spill")) {
+        // bursts of 48 every 4 rounds against 16 pops per round: 75% load, 3x depth-16 bursts
+        run_spill_bench("spill_baseline", 0, 4096, 48, 4, 16);
+        run_spill_bench("spill_ring", 1, 4096, 48, 4, 16);
+    }
+
+    if (bench_enabled(argc, argv, "completion")) {
+        // one task in flight (pure round trip), then a window of 8
+        run_completion_bench("completion_poll_w1", 0, 1000, 1, 16);
+        run_completion_bench("completion_ring_w1", 1, 1000, 1, 16);
+        run_completion_bench("completion_poll_w8", 0, 4000, 8, 16);
+        run_completion_bench("completion_ring_w8", 1, 4000, 8, 16);
+    }
+
+    if (bench_enabled(argc, argv, "dag")) {
+        run_dag_bench("dag_sw", 0, 16, 50, 16);
+        run_dag_bench("dag_join", 1, 16, 50, 16);
+    }
+
+    if (bench_enabled(argc, argv, "adaptive")) {
+        // fixed batch sizes against the adaptive target, 48-task bursts every 2 ms, then back to back
+        const unsigned sizes[] = {1, 8, 32, 64};
+        char name[32];
+        for (int w = 0; w < 2; w++) {
+            const char *wl = w == 0 ? "burst" : "sat";
+            unsigned burst = w == 0 ? 48 : 0;
+            for (unsigned k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+                snprintf(name, sizeof(name), "batch_%s_fixed%u", wl, sizes[k]);
+                run_adaptive_bench(name, TD_FIXED, sizes[k], 1536, burst, 2000, 4);
+            }
+            snprintf(name, sizeof(name), "batch_%s_adaptive", wl);
+            run_adaptive_bench(name, TD_ADAPTIVE, 4, 1536, burst, 2000, 4);
+        }
+    }
+
+    if (bench_enabled(argc, argv, "hybrid")) {
+        // 48-task bursts (3x the depth-16 FIFO) every 200 ms; svc 100 keeps the
+        // followers slower than the handshake so each burst overruns the FIFO
+        run_hybrid_bench("hybrid_spin", 0, 480, 48, 200000, 100);
+        run_hybrid_bench("hybrid_overflow", 1, 480, 48, 200000, 100);
+    }
+
+    if (bench_enabled(argc, argv, "peek")) {
+        // back-to-back pops, then 200 us of consumer work per task (longer than a bridge pass)
+        const unsigned work[] = {0, 200};
+        char name[32];
+        for (int w = 0; w < 2; w++) {
+            snprintf(name, sizeof(name), "peek_w%u_handshake", work[w]);
+            run_peek_bench(name, 0, 0, 512, 16, work[w]);
+            snprintf(name, sizeof(name), "peek_w%u_handshake_busy", work[w]);
+            run_peek_bench(name, 0, 1, 512, 16, work[w]);
+            snprintf(name, sizeof(name), "peek_w%u_spec", work[w]);
+            run_peek_bench(name, 1, 0, 512, 16, work[w]);
+        }
+    }
+
+    if (n_bench_results == 0) {
+        fprintf(stderr, "No benchmark selected; use --bench <credit|desc|spill|completion|dag|adaptive|hybrid|peek|all>\n");
+    } else {
+        write_bench_json("logs/bench.json");
+    }
+
+    // stop the bridge unless more runs will follow
+    if (!has_flag(argc, argv, "--keep-sim")) mmio_signal_done();
+    mmio_close();
+    return 0;
+}
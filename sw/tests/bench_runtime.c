@@ -0,0 +1,162 @@
+// sw/tests/bench_runtime.c
+// End-to-end throughput of the leader/follower runtime (src/task_runtime.c):
+// the leader submits --tasks closures that each spin for --task-ns, and the
+// follower count is swept 1, 2, 4, ... up to --max-followers. The software
+// queue always runs; the MMIO backend runs when the sw/sw_hw bridge can be
+// mapped (--mmio <path>, MMIO_PATH or the default path). Results go to
+// logs/bench_runtime.json in the bench_mmio_host layout; model/compare_runtime.py
+// replays each row through behavioral.py for the predicted throughput.
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/task_runtime.h"
+#include "../src/task_queue_mmio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define MAX_BENCH_RESULTS 256
+
+struct bench_entry {
+    char bench[32];
+    char key[48];
+    double value;
+};
+static struct bench_entry bench_results[MAX_BENCH_RESULTS];
+static int n_bench_results = 0;
+
+static void bench_record(const char *bench, const char *key, double value) {
+    if (n_bench_results >= MAX_BENCH_RESULTS) return;
+    struct bench_entry *e = &bench_results[n_bench_results++];
+    snprintf(e->bench, sizeof(e->bench), "%s", bench);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    e->value = value;
+}
+
+static void write_bench_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("open bench_runtime.json");
+        return;
+    }
+    fprintf(f, "{\n");
+    for (int i = 0; i < n_bench_results; i++) {
+        const struct bench_entry *e = &bench_results[i];
+        int first = (i == 0) || strcmp(bench_results[i-1].bench, e->bench) != 0;
+        int last = (i + 1 == n_bench_results) || strcmp(bench_results[i+1].bench, e->bench) != 0;
+        if (first) fprintf(f, "  \"%s\": {\n", e->bench);
+        fprintf(f, "    \"%s\": %.6g%s\n", e->key, e->value, last ? "" : ",");
+        if (last) fprintf(f, "  }%s\n", (i + 1 == n_bench_results) ? "" : ",");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+static const char *arg_value(int argc, char **argv, const char *flag) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], flag) == 0) return argv[i+1];
+    }
+    return NULL;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double task_ns = 2000.0;
+
+// the task body: busy-wait for task_ns, like a follower core doing real work
+static void spin_task(void *arg) {
+    double end = now_ns() + task_ns;
+    while (now_ns() < end) {}
+    __atomic_add_fetch((unsigned long *)arg, 1, __ATOMIC_RELAXED);
+}
+
+static void noop_task(void *arg) {
+    (void)arg;
+}
+
+static void run_runtime_bench(enum rt_backend backend, unsigned followers, unsigned ntasks) {
+    const char *bname = backend == RT_BACKEND_SW ? "sw" : "mmio";
+    char name[32];
+    snprintf(name, sizeof(name), "runtime_%s_f%u", bname, followers);
+
+    struct rt_config cfg = { .backend = backend, .followers = followers, .capacity = 256 };
+    if (rt_init(&cfg) != 0) {
+        fprintf(stderr, "%s: rt_init failed\n", name);
+        return;
+    }
+    // leader cost per dispatch: one arena's worth of empty tasks, so rt_submit
+    // never waits for a descriptor; this is the dispatch time behavioral.py models
+    double c0 = now_ns();
+    for (unsigned i = 0; i < cfg.capacity; i++) rt_submit(noop_task, NULL);
+    double dispatch_ns = (now_ns() - c0) / cfg.capacity;
+    rt_wait_idle();
+
+    unsigned long ran = 0, failed = 0;
+    double submit_ns = 0;
+    double t0 = now_ns();
+    for (unsigned i = 0; i < ntasks; i++) {
+        double s0 = now_ns();
+        if (rt_submit(spin_task, &ran) != 0) failed++;
+        submit_ns += now_ns() - s0;
+    }
+    rt_wait_idle();
+    double wall = now_ns() - t0;
+    struct rt_stats st;
+    rt_get_stats(&st);
+    rt_shutdown();
+
+    double tput = wall > 0 ? ran / (wall / 1e9) : 0.0;
+    double ideal = followers * 1e9 / task_ns;
+    printf("[SW] %s: tasks=%lu wall_ms=%.2f tasks_per_sec=%.0f (%.0f%% of %u x 1/task_ns) dispatch_ns=%.0f submit_ns/task=%.0f refused=%llu failed=%lu\n",
+           name, ran, wall / 1e6, tput, 100.0 * tput / ideal, followers, dispatch_ns, ntasks ? submit_ns / ntasks : 0.0,
+           (unsigned long long)st.push_refused, failed);
+    bench_record(name, "backend", backend);
+    bench_record(name, "followers", followers);
+    bench_record(name, "tasks", (double)ran);
+    bench_record(name, "task_ns", task_ns);
+    bench_record(name, "wall_ns", wall);
+    bench_record(name, "tasks_per_sec", tput);
+    bench_record(name, "dispatch_ns", dispatch_ns);
+    bench_record(name, "submit_ns_per_task", ntasks ? submit_ns / ntasks : 0.0);
+    bench_record(name, "push_refused", (double)st.push_refused);
+    bench_record(name, "pop_empty", (double)st.pop_empty);
+    bench_record(name, "arena_waits", (double)st.arena_waits);
+    bench_record(name, "arena_high_water", st.arena_high_water);
+    bench_record(name, "failed", (double)failed);
+}
+
+int main(int argc, char **argv) {
+    const char *v;
+    unsigned ntasks = 20000, max_followers = 8;
+    if ((v = arg_value(argc, argv, "--tasks"))) ntasks = (unsigned)strtoul(v, NULL, 0);
+    if ((v = arg_value(argc, argv, "--task-ns"))) task_ns = strtod(v, NULL);
+    if ((v = arg_value(argc, argv, "--max-followers"))) max_followers = (unsigned)strtoul(v, NULL, 0);
+
+    // followers beyond the free cores time-share with the leader
+    bench_record("host", "cpus", (double)sysconf(_SC_NPROCESSORS_ONLN));
+    for (unsigned f = 1; f <= max_followers; f *= 2) run_runtime_bench(RT_BACKEND_SW, f, ntasks);
+
+    const char *path = arg_value(argc, argv, "--mmio");
+    if (!path) path = getenv("MMIO_PATH");
+    if (mmio_init(path) == 0) {
+        // every task is a bridge round trip each way, so run fewer of them
+        unsigned n = ntasks / 10 ? ntasks / 10 : 1;
+        for (unsigned f = 1; f <= max_followers; f *= 2) run_runtime_bench(RT_BACKEND_MMIO, f, n);
+        mmio_close();
+    } else {
+        fprintf(stderr, "MMIO backend skipped: start the sw/sw_hw bridge or pass --mmio <path>.\n");
+    }
+
+    mkdir("logs", 0755);
+    write_bench_json("logs/bench_runtime.json");
+    printf("Results in logs/bench_runtime.json\n");
+    return 0;
+}
@@ -0,0 +1,244 @@
+// sw/tests/bench_swq.c
+// Microbenchmarks for the lock-free software queues (src/sw_queue.c), the
+// measured software baseline for the hardware queue. Runs without the bridge:
+//   latency   one thread, push then pop a ring's worth of words: ns per op
+//   handoff   P producers and C consumers move --ops words through one ring;
+//             throughput, refused attempts, and per-producer order checks
+// Thread counts go up to --max-threads per side. Results are written to
+// logs/bench_swq.json in the bench_mmio_host layout.
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/sw_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define MAX_BENCH_RESULTS 512
+#define MAX_THREADS 64
+
+struct bench_entry {
+    char bench[32];
+    char key[48];
+    double value;
+};
+static struct bench_entry bench_results[MAX_BENCH_RESULTS];
+static int n_bench_results = 0;
+
+static void bench_record(const char *bench, const char *key, double value) {
+    if (n_bench_results >= MAX_BENCH_RESULTS) return;
+    struct bench_entry *e = &bench_results[n_bench_results++];
+    snprintf(e->bench, sizeof(e->bench), "%s", bench);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    e->value = value;
+}
+
+static void write_bench_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("open bench_swq.json");
+        return;
+    }
+    fprintf(f, "{\n");
+    for (int i = 0; i < n_bench_results; i++) {
+        const struct bench_entry *e = &bench_results[i];
+        int first = (i == 0) || strcmp(bench_results[i-1].bench, e->bench) != 0;
+        int last = (i + 1 == n_bench_results) || strcmp(bench_results[i+1].bench, e->bench) != 0;
+        if (first) fprintf(f, "  \"%s\": {\n", e->bench);
+        fprintf(f, "    \"%s\": %.6g%s\n", e->key, e->value, last ? "" : ",");
+        if (last) fprintf(f, "  }%s\n", (i + 1 == n_bench_results) ? "" : ",");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+static const char *arg_value(int argc, char **argv, const char *flag) {
+    for (int i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], flag) == 0) return argv[i+1];
+    }
+    return NULL;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run_latency_bench(enum swq_kind kind, unsigned capacity, unsigned rounds) {
+    char name[32];
+    snprintf(name, sizeof(name), "latency_%s", swq_kind_name(kind));
+    struct swq q;
+    if (swq_init(&q, kind, capacity) != 0) {
+        fprintf(stderr, "%s: swq_init failed\n", name);
+        return;
+    }
+    unsigned cap = swq_capacity(&q);
+    double push_ns = 0, pop_ns = 0;
+    unsigned long errors = 0;
+    uint32_t v;
+    for (unsigned r = 0; r < rounds; r++) {
+        double t0 = now_ns();
+        for (unsigned i = 0; i < cap; i++) errors += swq_push(&q, i) != 0;
+        double t1 = now_ns();
+        for (unsigned i = 0; i < cap; i++) errors += swq_pop(&q, &v) != 0 || v != i;
+        pop_ns += now_ns() - t1;
+        push_ns += t1 - t0;
+    }
+    double ops = (double)rounds * cap;
+    errors += swq_push(&q, 0) == 0 && swq_pop(&q, &v) == 0 && swq_pop(&q, &v) == 0;   // empty pop must refuse
+    swq_destroy(&q);
+
+    printf("[SW] %s: push_ns=%.2f pop_ns=%.2f errors=%lu\n", name, push_ns / ops, pop_ns / ops, errors);
+    bench_record(name, "capacity", cap);
+    bench_record(name, "ops", ops);
+    bench_record(name, "push_ns", push_ns / ops);
+    bench_record(name, "pop_ns", pop_ns / ops);
+    bench_record(name, "errors", (double)errors);
+}
+
+struct handoff {
+    struct swq q;
+    unsigned producers, consumers;
+    unsigned long per_producer;
+    unsigned long total;
+    unsigned long popped;           // shared count, ends the consumers
+    unsigned long push_refused, pop_refused;
+    unsigned long order_errors;
+    uint64_t checksum;
+    int go;
+};
+
+struct worker {
+    struct handoff *h;
+    unsigned id;
+    pthread_t tid;
+};
+
+// A refused side yields every 64 attempts so oversubscribed runs still progress.
+// word = producer << 24 | sequence within that producer
+static void *producer_main(void *arg) {
+    struct worker *w = arg;
+    struct handoff *h = w->h;
+    unsigned long refused = 0;
+    while (!__atomic_load_n(&h->go, __ATOMIC_ACQUIRE)) {}
+    for (unsigned long i = 0; i < h->per_producer; i++) {
+        uint32_t word = (w->id << 24) | (uint32_t)i;
+        while (swq_push(&h->q, word) != 0) {
+            if ((++refused & 63) == 0) sched_yield();
+        }
+    }
+    __atomic_add_fetch(&h->push_refused, refused, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void *consumer_main(void *arg) {
+    struct worker *w = arg;
+    struct handoff *h = w->h;
+    unsigned long refused = 0, order_errors = 0;
+    uint64_t sum = 0;
+    uint32_t next[MAX_THREADS] = {0};
+    while (!__atomic_load_n(&h->go, __ATOMIC_ACQUIRE)) {}
+    while (__atomic_load_n(&h->popped, __ATOMIC_RELAXED) < h->total) {
+        uint32_t word;
+        if (swq_pop(&h->q, &word) != 0) {
+            if ((++refused & 63) == 0) sched_yield();
+            continue;
+        }
+        __atomic_add_fetch(&h->popped, 1, __ATOMIC_RELAXED);
+        sum += word;
+        unsigned p = word >> 24;
+        uint32_t seq = word & 0xFFFFFF;
+        // each consumer must see any one producer's words in push order
+        if (p >= h->producers || seq < next[p]) order_errors++;
+        else next[p] = seq + 1;
+    }
+    __atomic_add_fetch(&h->pop_refused, refused, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->order_errors, order_errors, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->checksum, sum, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void run_handoff_bench(enum swq_kind kind, unsigned producers, unsigned consumers, unsigned capacity, unsigned long ops) {
+    char name[32];
+    snprintf(name, sizeof(name), "handoff_%s_p%uc%u", swq_kind_name(kind), producers, consumers);
+    struct handoff *h = calloc(1, sizeof(*h));
+    struct worker *w = calloc(producers + consumers, sizeof(*w));
+    if (!h || !w || swq_init(&h->q, kind, capacity) != 0) {
+        fprintf(stderr, "%s: setup failed\n", name);
+        free(h);
+        free(w);
+        return;
+    }
+    h->producers = producers;
+    h->consumers = consumers;
+    h->per_producer = ops / producers;
+    if (h->per_producer > 0xFFFFFF) h->per_producer = 0xFFFFFF;
+    h->total = h->per_producer * producers;
+
+    for (unsigned i = 0; i < producers + consumers; i++) {
+        w[i].h = h;
+        w[i].id = i < producers ? i : i - producers;
+        pthread_create(&w[i].tid, NULL, i < producers ? producer_main : consumer_main, &w[i]);
+    }
+    double t0 = now_ns();
+    __atomic_store_n(&h->go, 1, __ATOMIC_RELEASE);
+    for (unsigned i = 0; i < producers + consumers; i++) pthread_join(w[i].tid, NULL);
+    double wall = now_ns() - t0;
+
+    uint64_t expect = 0;
+    for (unsigned p = 0; p < producers; p++) {
+        expect += (uint64_t)h->per_producer * ((uint64_t)p << 24) + (uint64_t)h->per_producer * (h->per_producer - 1) / 2;
+    }
+    unsigned long lost = h->checksum != expect || swq_is_valid(&h->q);
+    double mops = wall > 0 ? h->total / (wall / 1e3) : 0.0;
+
+    printf("[SW] %s: words=%lu wall_ms=%.2f mops=%.2f ns_per_word=%.1f push_refused=%lu pop_refused=%lu order_errors=%lu checksum_%s\n",
+           name, h->total, wall / 1e6, mops, h->total ? wall / h->total : 0.0,
+           h->push_refused, h->pop_refused, h->order_errors, lost ? "BAD" : "ok");
+    bench_record(name, "producers", producers);
+    bench_record(name, "consumers", consumers);
+    bench_record(name, "capacity", swq_capacity(&h->q));
+    bench_record(name, "words", (double)h->total);
+    bench_record(name, "wall_ns", wall);
+    bench_record(name, "mops", mops);
+    bench_record(name, "ns_per_word", h->total ? wall / h->total : 0.0);
+    bench_record(name, "push_refused", (double)h->push_refused);
+    bench_record(name, "pop_refused", (double)h->pop_refused);
+    bench_record(name, "order_errors", (double)h->order_errors);
+    bench_record(name, "checksum_errors", (double)lost);
+    swq_destroy(&h->q);
+    free(h);
+    free(w);
+}
+
+int main(int argc, char **argv) {
+    const char *v;
+    unsigned long ops = 2000000;
+    unsigned capacity = 1024, max_threads = 4;
+    if ((v = arg_value(argc, argv, "--ops"))) ops = strtoul(v, NULL, 0);
+    if ((v = arg_value(argc, argv, "--capacity"))) capacity = (unsigned)strtoul(v, NULL, 0);
+    if ((v = arg_value(argc, argv, "--max-threads"))) max_threads = (unsigned)strtoul(v, NULL, 0);
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS / 2) max_threads = MAX_THREADS / 2;
+
+    // busy-waiting threads beyond the free cores measure the scheduler, not the ring
+    bench_record("host", "cpus", (double)sysconf(_SC_NPROCESSORS_ONLN));
+
+    for (int k = SWQ_SPSC; k <= SWQ_MPMC; k++) run_latency_bench((enum swq_kind)k, capacity, 200);
+
+    run_handoff_bench(SWQ_SPSC, 1, 1, capacity, ops);
+    for (unsigned p = 1; p <= max_threads; p *= 2) run_handoff_bench(SWQ_MPSC, p, 1, capacity, ops);
+    for (unsigned t = 1; t <= max_threads; t *= 2) run_handoff_bench(SWQ_MPMC, t, t, capacity, ops);
+
+    mkdir("logs", 0755);
+    write_bench_json("logs/bench_swq.json");
+    printf("Results in logs/bench_swq.json\n");
+    return 0;
+}
@@ -1,7 +1,9 @@
 // sw/tests/test_task_queue_host.c
 #define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE   // sched_setaffinity / sched_getcpu for --cpu
 
 #include "../src/task_queue_mmio.h"
+#include "../src/task_arena.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -12,6 +14,7 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <sched.h>
 
 #ifndef MMIO_ENV_VAR
 #define MMIO_ENV_VAR "MMIO_PATH"
@@ -35,6 +38,196 @@ static void ensure_logs_dir() {
     }
 }
 
+// Queue residency histogram from the hardware timestamp sideband (cycles between
+// push and pop). Bucket 0 holds residency 0, bucket k holds [2^(k-1), 2^k).
+#define RES_BUCKETS 33
+static unsigned long res_hist[RES_BUCKETS];
+static unsigned long res_count = 0;
+static unsigned long long res_sum = 0;
+static uint32_t res_max = 0;
+
+static void residency_add(uint32_t v) {
+    int b = 0;
+    for (uint32_t x = v; x; x >>= 1) b++;
+    res_hist[b]++;
+    res_count++;
+    res_sum += v;
+    if (v > res_max) res_max = v;
+}
+
+// upper bound of the bucket holding quantile q
+static unsigned long long residency_percentile(double q) {
+    unsigned long target = (unsigned long)(q * res_count), seen = 0;
+    for (int b = 0; b < RES_BUCKETS; b++) {
+        seen += res_hist[b];
+        if (seen > target) {
+            unsigned long long hi = b == 0 ? 0 : ((1ull << b) - 1);
+            return hi < res_max ? hi : res_max;
+        }
+    }
+    return res_max;
+}
+
+static void write_residency_csv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("open residency_hist.csv");
+        return;
+    }
+    fprintf(f, "bucket_lo,bucket_hi,count\n");
+    for (int b = 0; b < RES_BUCKETS; b++) {
+        if (!res_hist[b]) continue;
+        fprintf(f, "%llu,%llu,%lu\n", b == 0 ? 0ull : (1ull << (b - 1)),
+                b == 0 ? 0ull : ((1ull << b) - 1), res_hist[b]);
+    }
+    fclose(f);
+}
+
+// Wall-clock latency of every mmio_push / mmio_pop, per op and outcome, on
+// CLOCK_MONOTONIC_RAW (no NTP slewing). Log-linear histogram: values below 16 ns
+// get their own bucket, above that each power of two is split into 16, so a
+// percentile is off by at most 1/16. The median cost of one clock read pair is
+// calibrated at startup and subtracted from every sample.
+enum { LAT_PUSH, LAT_POP, LAT_OPS };
+enum { LAT_OK, LAT_REFUSED, LAT_TIMEOUT, LAT_OUTCOMES };
+#define LAT_SUB_BITS 4
+#define LAT_BUCKETS ((64 - LAT_SUB_BITS + 1) << LAT_SUB_BITS)
+struct lat_hist {
+    unsigned long count[LAT_BUCKETS];
+    unsigned long n;
+    uint64_t sum, max;
+};
+static struct lat_hist lat[LAT_OPS][LAT_OUTCOMES];
+static const char *const lat_op_name[LAT_OPS] = {"push", "pop"};
+static const char *const lat_outcome_name[LAT_OUTCOMES] = {"ok", "refused", "timeout"};
+static uint64_t timer_overhead_ns = 0, timer_min_ns = 0;
+
+static inline uint64_t raw_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int lat_bucket(uint64_t v) {
+    if (v < (1u << LAT_SUB_BITS)) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int sub = (int)((v >> (msb - LAT_SUB_BITS)) & ((1u << LAT_SUB_BITS) - 1));
+    return ((msb - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + sub;
+}
+
+// largest value that lands in bucket b
+static uint64_t lat_bucket_hi(int b) {
+    if (b < (1 << LAT_SUB_BITS)) return (uint64_t)b;
+    int msb = (b >> LAT_SUB_BITS) + LAT_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(b & ((1 << LAT_SUB_BITS) - 1));
+    uint64_t lo = (1ull << msb) + (sub << (msb - LAT_SUB_BITS));
+    return lo + (1ull << (msb - LAT_SUB_BITS)) - 1;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void calibrate_timer(void) {
+    enum { N = 10001 };
+    static uint64_t d[N];
+    for (int i = 0; i < N; i++) {
+        uint64_t t0 = raw_ns();
+        d[i] = raw_ns() - t0;
+    }
+    qsort(d, N, sizeof(d[0]), cmp_u64);
+    timer_min_ns = d[0];
+    timer_overhead_ns = d[N / 2];
+}
+
+static void lat_record(int op, int rc, uint64_t t0, uint64_t t1) {
+    uint64_t v = t1 - t0;
+    v = v > timer_overhead_ns ? v - timer_overhead_ns : 0;
+    struct lat_hist *h = &lat[op][rc == 0 ? LAT_OK : rc == -1 ? LAT_REFUSED : LAT_TIMEOUT];
+    h->count[lat_bucket(v)]++;
+    h->n++;
+    h->sum += v;
+    if (v > h->max) h->max = v;
+}
+
+static uint64_t lat_percentile(const struct lat_hist *h, double q) {
+    if (h->n == 0) return 0;
+    unsigned long target = (unsigned long)(q * h->n), seen = 0;
+    for (int b = 0; b < LAT_BUCKETS; b++) {
+        seen += h->count[b];
+        if (seen > target) {
+            uint64_t hi = lat_bucket_hi(b);
+            return hi < h->max ? hi : h->max;
+        }
+    }
+    return h->max;
+}
+
+static int timed_push(uint32_t value, int timeout_ms) {
+    uint64_t t0 = raw_ns();
+    int r = mmio_push(value, timeout_ms);
+    lat_record(LAT_PUSH, r, t0, raw_ns());
+    return r;
+}
+
+static int timed_pop_ts(uint32_t *out, uint32_t *residency, int timeout_ms) {
+    uint64_t t0 = raw_ns();
+    int r = mmio_pop_ts(out, residency, timeout_ms);
+    lat_record(LAT_POP, r, t0, raw_ns());
+    return r;
+}
+
+// Where the run executed, for results.json: --cpu N pins this process, and the
+// bridge publishes its own CPU and mode. The CPU is sampled every randomized op
+// to count migrations; package / core ids come from sysfs (-1 if unavailable).
+struct run_topology {
+    int pinned_cpu;             // -1: not pinned
+    int first_cpu, last_cpu;
+    unsigned long migrations;
+    int bridge_cpu;
+    uint32_t bridge_mode;
+};
+
+static int cpu_topology_id(int cpu, const char *what) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, what);
+    FILE *f = cpu >= 0 ? fopen(path, "r") : NULL;
+    int id = -1;
+    if (f) {
+        if (fscanf(f, "%d", &id) != 1) id = -1;
+        fclose(f);
+    }
+    return id;
+}
+
+static void note_cpu(struct run_topology *t) {
+    int c = sched_getcpu();
+    if (t->first_cpu < 0) t->first_cpu = c;
+    else if (c != t->last_cpu) t->migrations++;
+    t->last_cpu = c;
+}
+
+static int pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+// idle pause of the randomized test; busy-poll runs never yield the core
+static void idle_pause(int microseconds) {
+    if (!mmio_busy_poll()) {
+        sleep_us(microseconds);
+        return;
+    }
+    struct timespec t0, t;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &t);
+    } while ((t.tv_sec - t0.tv_sec) * 1000000L + (t.tv_nsec - t0.tv_nsec) / 1000 < microseconds);
+}
+
 // Try mmio_init on a candidate path and print diagnostic
 static int try_mmio_path(const char *path) {
     if (!path) return -1;
@@ -117,6 +310,22 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    // --cpu N: pin to core N; --busy-poll: spin on ACKs instead of sleeping
+    struct run_topology topo = { -1, -1, -1, 0, -1, 0 };
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            topo.pinned_cpu = atoi(argv[++i]);
+            if (pin_to_cpu(topo.pinned_cpu) != 0) {
+                perror("sched_setaffinity");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--busy-poll") == 0) {
+            mmio_set_busy_poll(true);
+        }
+    }
+    note_cpu(&topo);
+    calibrate_timer();
+
     ensure_logs_dir();
     FILE *logf = fopen("logs/run.log", "w");
     if (!logf) { perror("open logs/run.log"); return 1; }
@@ -141,7 +350,7 @@ int main(int argc, char **argv) {
     uint32_t vals[] = {0xA5A5A5A5, 0xDEADBEEF, 0x01234567, 0x89ABCDEF};
     for (int i = 0; i < 4; i++) {
         attempted_push++;
-        int r = mmio_push(vals[i], 1000);
+        int r = timed_push(vals[i], 1000);
         if (r == 0) {
             success_push++;
             fprintf(logf, "push OK 0x%08x\n", vals[i]);
@@ -158,10 +367,11 @@ int main(int argc, char **argv) {
     // pop two
     for (int i = 0; i < 2; i++) {
         attempted_pop++;
-        uint32_t out;
-        int r = mmio_pop(&out, 1000);
+        uint32_t out, res;
+        int r = timed_pop_ts(&out, &res, 1000);
         if (r == 0) {
             success_pop++;
+            residency_add(res);
             fprintf(logf, "pop OK 0x%08x\n", out);
             // log successful pop
             fprintf(tracef, "pop,0x%08x\n", out);
@@ -183,11 +393,12 @@ int main(int argc, char **argv) {
     int swhead = 0, swtail = 0, swcount = 0, swdepth = 16;
 
     for (int i = 0; i < OPS; i++) {
+        note_cpu(&topo);
         int op = rand() % 3;
         if (op == 0) {
             uint32_t v = (uint32_t)rand();
             attempted_push++;
-            int r = mmio_push(v, 100);
+            int r = timed_push(v, 100);
             if (r == 0) {
                 success_push++;
                 if (swcount < swdepth) {
@@ -204,10 +415,11 @@ int main(int argc, char **argv) {
             }
         } else if (op == 1) {
             attempted_pop++;
-            uint32_t out;
-            int r = mmio_pop(&out, 100);
+            uint32_t out, res;
+            int r = timed_pop_ts(&out, &res, 100);
             if (r == 0) {
                 success_pop++;
+                residency_add(res);
                 if (swcount == 0) {
                     fprintf(logf, "MISMATCH: popped but SW empty\n");
                     mismatches++;
@@ -229,17 +441,18 @@ int main(int argc, char **argv) {
             }
         } else {
             // idle - tiny pause to let HW advance
-            sleep_us(10);
+            idle_pause(10);
         }
     }
 
     // drain SW model
     while (swcount > 0) {
         attempted_pop++;
-        uint32_t out;
-        int r = mmio_pop(&out, 1000);
+        uint32_t out, res;
+        int r = timed_pop_ts(&out, &res, 1000);
         if (r == 0) {
             success_pop++;
+            residency_add(res);
             uint32_t expected = swbuf[swhead];
             swhead = (swhead + 1) % swdepth;
             swcount--;
@@ -255,10 +468,82 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Descriptor test: the queue carries arena handles; the popped handle must
+    // translate back to the descriptor that was filled before the push. After
+    // ta_init() the loop only recycles descriptors, so nothing reaches malloc.
+    fprintf(logf, "[SW] Descriptor test\n");
+    struct desc_payload {
+        uint32_t seq;
+        uint32_t words[7];
+    };
+    struct ta_arena arena;
+    if (ta_init(&arena, 32, sizeof(struct desc_payload)) != 0) {
+        fprintf(logf, "MISMATCH: arena init failed\n");
+        mismatches++;
+    } else {
+        uint32_t seq = 0;
+        for (int round = 0; round < 64; round++) {
+            uint32_t pushed[8];
+            int n = 0;
+            for (int i = 0; i < 8; i++) {
+                uint32_t h = ta_alloc(&arena);
+                if (h == TA_NULL) break;
+                struct desc_payload *d = ta_ptr(&arena, h);
+                d->seq = seq;
+                for (int w = 0; w < 7; w++) d->words[w] = seq * 7 + w;
+                attempted_push++;
+                if (timed_push(h, 1000) != 0) {
+                    refused_push++;
+                    ta_free(&arena, h);
+                    break;
+                }
+                success_push++;
+                fprintf(tracef, "push,0x%08x\n", h);
+                pushed[n++] = h;
+                seq++;
+            }
+            for (int i = 0; i < n; i++) {
+                uint32_t h;
+                attempted_pop++;
+                if (timed_pop_ts(&h, NULL, 1000) != 0) {
+                    refused_pop++;
+                    fprintf(logf, "MISMATCH: descriptor pop failed\n");
+                    mismatches++;
+                    break;
+                }
+                success_pop++;
+                fprintf(tracef, "pop,0x%08x\n", h);
+                const struct desc_payload *d = ta_valid(&arena, h) ? ta_ptr(&arena, h) : NULL;
+                uint32_t want = d ? d->seq : 0;
+                int ok = d && h == pushed[i];
+                for (int w = 0; ok && w < 7; w++) ok = d->words[w] == want * 7 + w;
+                if (!ok) {
+                    fprintf(logf, "MISMATCH: descriptor handle 0x%08x (expected 0x%08x)\n", h, pushed[i]);
+                    mismatches++;
+                }
+                if (d) ta_free(&arena, h);
+            }
+        }
+        if (ta_in_use(&arena) != 0) {
+            fprintf(logf, "MISMATCH: %u descriptors not recycled\n", ta_in_use(&arena));
+            mismatches++;
+        }
+        fprintf(logf, "descriptors: %u moved, %u in arena, high water %u\n", seq, arena.count, ta_high_water(&arena));
+        ta_destroy(&arena);
+    }
+
     // flush and close trace file
     fflush(tracef);
     fclose(tracef);
 
+    // snapshot the hardware perf counters while the bridge is still running;
+    // they should agree with the software tallies above
+    struct mmio_perf perf;
+    memset(&perf, 0, sizeof(perf));
+    if (mmio_read_perf(&perf) != 0) fprintf(logf, "perf counter read failed\n");
+    note_cpu(&topo);
+    topo.bridge_cpu = mmio_bridge_cpu(&topo.bridge_mode);
+
     // signal TB_DONE so the sw_hw simulator can exit (try multiple candidate paths)
     {
         const char *candidates[] = {
@@ -296,17 +581,71 @@ int main(int argc, char **argv) {
         fprintf(resf, "  \"attempted_pops\": %lu,\n", attempted_pop);
         fprintf(resf, "  \"successful_pops\": %lu,\n", success_pop);
         fprintf(resf, "  \"refused_pops\": %lu,\n", refused_pop);
-        fprintf(resf, "  \"mismatches\": %lu\n", mismatches);
+        fprintf(resf, "  \"mismatches\": %lu,\n", mismatches);
+        fprintf(resf, "  \"hw_cycles\": %llu,\n", (unsigned long long)perf.cycles);
+        fprintf(resf, "  \"hw_pushes\": %u,\n", perf.pushes);
+        fprintf(resf, "  \"hw_pops\": %u,\n", perf.pops);
+        fprintf(resf, "  \"hw_refused_pushes\": %u,\n", perf.push_refused);
+        fprintf(resf, "  \"hw_refused_pops\": %u,\n", perf.pop_refused);
+        fprintf(resf, "  \"hw_full_cycles\": %u,\n", perf.full_cycles);
+        fprintf(resf, "  \"hw_empty_cycles\": %u,\n", perf.empty_cycles);
+        fprintf(resf, "  \"hw_mean_depth\": %.4f,\n", perf.cycles ? (double)perf.occ_sum / perf.cycles : 0.0);
+        fprintf(resf, "  \"hw_max_depth\": %u,\n", perf.max_occ);
+        fprintf(resf, "  \"residency_mean\": %.3f,\n", res_count ? (double)res_sum / res_count : 0.0);
+        fprintf(resf, "  \"residency_p50\": %llu,\n", residency_percentile(0.50));
+        fprintf(resf, "  \"residency_p99\": %llu,\n", residency_percentile(0.99));
+        fprintf(resf, "  \"residency_max\": %u,\n", res_max);
+        fprintf(resf, "  \"busy_poll\": %d,\n", mmio_busy_poll());
+        fprintf(resf, "  \"cpus_online\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+        fprintf(resf, "  \"host_cpu_pinned\": %d,\n", topo.pinned_cpu);
+        fprintf(resf, "  \"host_cpu\": %d,\n", topo.last_cpu);
+        fprintf(resf, "  \"host_cpu_migrations\": %lu,\n", topo.migrations);
+        fprintf(resf, "  \"host_package\": %d,\n", cpu_topology_id(topo.last_cpu, "physical_package_id"));
+        fprintf(resf, "  \"host_core\": %d,\n", cpu_topology_id(topo.last_cpu, "core_id"));
+        fprintf(resf, "  \"bridge_cpu\": %d,\n", topo.bridge_cpu);
+        fprintf(resf, "  \"bridge_pinned\": %d,\n", (topo.bridge_mode & MMIO_BRIDGE_PINNED) != 0);
+        fprintf(resf, "  \"bridge_busy_poll\": %d,\n", (topo.bridge_mode & MMIO_BRIDGE_BUSY_POLL) != 0);
+        fprintf(resf, "  \"bridge_package\": %d,\n", cpu_topology_id(topo.bridge_cpu, "physical_package_id"));
+        fprintf(resf, "  \"bridge_core\": %d,\n", cpu_topology_id(topo.bridge_cpu, "core_id"));
+        fprintf(resf, "  \"timer_overhead_ns\": %llu,\n", (unsigned long long)timer_overhead_ns);
+        fprintf(resf, "  \"timer_min_ns\": %llu,\n", (unsigned long long)timer_min_ns);
+        for (int op = 0; op < LAT_OPS; op++) {
+            for (int oc = 0; oc < LAT_OUTCOMES; oc++) {
+                const struct lat_hist *h = &lat[op][oc];
+                const char *o = lat_op_name[op], *c = lat_outcome_name[oc];
+                int last = op == LAT_OPS - 1 && oc == LAT_OUTCOMES - 1;
+                fprintf(resf, "  \"lat_%s_%s_count\": %lu,\n", o, c, h->n);
+                fprintf(resf, "  \"lat_%s_%s_mean_ns\": %.1f,\n", o, c, h->n ? (double)h->sum / h->n : 0.0);
+                fprintf(resf, "  \"lat_%s_%s_p50_ns\": %llu,\n", o, c, (unsigned long long)lat_percentile(h, 0.50));
+                fprintf(resf, "  \"lat_%s_%s_p99_ns\": %llu,\n", o, c, (unsigned long long)lat_percentile(h, 0.99));
+                fprintf(resf, "  \"lat_%s_%s_p999_ns\": %llu,\n", o, c, (unsigned long long)lat_percentile(h, 0.999));
+                fprintf(resf, "  \"lat_%s_%s_max_ns\": %llu%s\n", o, c, (unsigned long long)h->max, last ? "" : ",");
+            }
+        }
         fprintf(resf, "}\n");
         fclose(resf);
     }
 
+    write_residency_csv("logs/residency_hist.csv");
+
     FILE *csvf = fopen("logs/metrics.csv", "w");
     if (csvf) {
-        fprintf(csvf, "attempted_pushes,successful_pushes,refused_pushes,attempted_pops,successful_pops,refused_pops,mismatches\n");
-        fprintf(csvf, "%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+        // latency columns follow the counters: <op>_<outcome>_{p50,p99,p999}_ns, then the timer overhead
+        fprintf(csvf, "attempted_pushes,successful_pushes,refused_pushes,attempted_pops,successful_pops,refused_pops,mismatches");
+        for (int op = 0; op < LAT_OPS; op++)
+            for (int oc = 0; oc < LAT_OUTCOMES; oc++)
+                fprintf(csvf, ",%s_%s_p50_ns,%s_%s_p99_ns,%s_%s_p999_ns", lat_op_name[op], lat_outcome_name[oc],
+                        lat_op_name[op], lat_outcome_name[oc], lat_op_name[op], lat_outcome_name[oc]);
+        fprintf(csvf, ",timer_overhead_ns\n");
+        fprintf(csvf, "%lu,%lu,%lu,%lu,%lu,%lu,%lu",
                 attempted_push, success_push, refused_push,
                 attempted_pop, success_pop, refused_pop, mismatches);
+        for (int op = 0; op < LAT_OPS; op++)
+            for (int oc = 0; oc < LAT_OUTCOMES; oc++)
+                fprintf(csvf, ",%llu,%llu,%llu", (unsigned long long)lat_percentile(&lat[op][oc], 0.50),
+                        (unsigned long long)lat_percentile(&lat[op][oc], 0.99),
+                        (unsigned long long)lat_percentile(&lat[op][oc], 0.999));
+        fprintf(csvf, ",%llu\n", (unsigned long long)timer_overhead_ns);
         fclose(csvf);
     }
 
@@ -316,6 +655,22 @@ int main(int argc, char **argv) {
     fprintf(logf, "attempted pops: %lu\nsuccessful pops: %lu\nrefused pops: %lu\n",
             attempted_pop, success_pop, refused_pop);
     fprintf(logf, "mismatches: %lu\n", mismatches);
+    fprintf(logf, "latency (CLOCK_MONOTONIC_RAW, timer overhead %llu ns subtracted):\n", (unsigned long long)timer_overhead_ns);
+    for (int op = 0; op < LAT_OPS; op++) {
+        for (int oc = 0; oc < LAT_OUTCOMES; oc++) {
+            const struct lat_hist *h = &lat[op][oc];
+            if (!h->n) continue;
+            fprintf(logf, "  %s %s: n=%lu p50=%llu p99=%llu p999=%llu max=%llu ns\n", lat_op_name[op], lat_outcome_name[oc], h->n,
+                    (unsigned long long)lat_percentile(h, 0.50), (unsigned long long)lat_percentile(h, 0.99),
+                    (unsigned long long)lat_percentile(h, 0.999), (unsigned long long)h->max);
+        }
+    }
+    fprintf(logf, "topology: host cpu %d (pinned %d, %lu migrations, busy-poll %d), bridge cpu %d (mode 0x%x), %ld cpus online\n",
+            topo.last_cpu, topo.pinned_cpu, topo.migrations, mmio_busy_poll(), topo.bridge_cpu,
+            topo.bridge_mode, sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(logf, "hw counters: pushes=%u pops=%u refused pushes=%u refused pops=%u full cycles=%u empty cycles=%u mean depth=%.2f max depth=%u\n",
+            perf.pushes, perf.pops, perf.push_refused, perf.pop_refused, perf.full_cycles,
+            perf.empty_cycles, perf.cycles ? (double)perf.occ_sum / perf.cycles : 0.0, perf.max_occ);
     fclose(logf);
 
     mmio_close();